@@ -10,7 +10,7 @@ from homeassistant.components.bluetooth import async_ble_device_from_address
 from homeassistant.core import HomeAssistant
 from homeassistant.exceptions import ConfigEntryNotReady
 
-from .const import BLE_COMMAND_CHAR, BLE_STATUS_CHAR, LOGGER
+from .const import BLE_COMMAND_CHAR, BLE_STATUS_CHAR, FEEDBACK_TOPICS, LOGGER
 from .status_store import LampStatusStore
 
 
@@ -56,6 +56,8 @@ class QuarzlampeClient:
             await self._client.start_notify(BLE_STATUS_CHAR, self._handle_notification)
             self._connected = True
             # Kick off a status request to arm feedback and fill the store.
+            await self.async_send_command(f"sub {FEEDBACK_TOPICS}")
+            await self.async_send_command("tok on")
             await self.async_send_command("status")
 
     async def async_disconnect(self) -> None:
@@ -9,7 +9,7 @@ from typing import Any
 import serial_asyncio
 from homeassistant.core import HomeAssistant
 
-from .const import DEFAULT_BT_BAUD, LOGGER
+from .const import DEFAULT_BT_BAUD, FEEDBACK_TOPICS, LOGGER
 from .status_store import LampStatusStore
 
 
@@ -47,6 +47,8 @@ class QuarzlampeBtSerialClient:
                 raise ConnectionError(f"Failed to open serial port {self.port}: {err}") from err
             self._connected = True
             self._task = asyncio.create_task(self._read_loop())
+            await self.async_send_command(f"sub {FEEDBACK_TOPICS}")
+            await self.async_send_command("tok on")
             await self.async_send_command("status")
 
     async def async_disconnect(self) -> None:
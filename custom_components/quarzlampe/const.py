@@ -16,6 +16,10 @@ BLE_SERVICE_UUID = "d94d86d7-1eaf-47a4-9d1e-7a90bf34e66b"
 BLE_COMMAND_CHAR = "4bb5047d-0d8b-4c5e-81cd-6fb5c0d1d1f7"
 BLE_STATUS_CHAR = "c5ad78b6-9b77-4a96-9a42-8e6e9a40c123"
 
+# Feedback topics HA subscribes to on connect (firmware `sub` command);
+# debug/midi traces are never formatted or sent to HA.
+FEEDBACK_TOPICS = "state,status,sensors,log"
+
 PLATFORMS: list[str] = ["light", "switch", "number", "sensor", "button"]
 
 # Keep update interval short enough to stay in sync but not spam the lamp.
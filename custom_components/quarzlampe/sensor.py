@@ -15,6 +15,8 @@ SENSORS: tuple[SensorEntityDescription, ...] = (
     SensorEntityDescription(key="pattern_name", name="Pattern Name"),
     SensorEntityDescription(key="light_raw", name="Light Raw"),
     SensorEntityDescription(key="music_level", name="Music Level"),
+    SensorEntityDescription(key="music_bpm", name="Music BPM"),
+    SensorEntityDescription(key="music_beat_conf", name="Music Beat Confidence"),
     SensorEntityDescription(key="touch_delta", name="Touch Delta"),
     SensorEntityDescription(key="presence", name="Presence"),
     SensorEntityDescription(key="host_ble_available", name="Host BLE Available"),
@@ -7,6 +7,8 @@ import re
 import time
 from typing import Any
 
+from .tokenlog import expand_token_line
+
 
 def _as_float(val: str | None) -> float | None:
     if val is None:
@@ -50,7 +52,7 @@ class LampStatusStore:
         self._event.set()
 
     def handle_line(self, line: str) -> bool:
-        line = line.strip()
+        line = expand_token_line(line.strip())
         if not line:
             return False
 
@@ -146,6 +148,9 @@ class LampStatusStore:
                     "music_env": float_or_none("music_env"),
                     "music_level": float_or_none("music_level"),
                     "music_smooth": float_or_none("music_smooth"),
+                    "music_bpm": float_or_none("music_bpm"),
+                    "music_beat_conf": float_or_none("music_beat_conf"),
+                    "music_beat_phase": float_or_none("music_beat_phase"),
                     "clap": is_on("clap"),
                     "clap_thr": float_or_none("clap_thr"),
                     "clap_cool": int_or_none("clap_cool"),
@@ -197,6 +202,9 @@ class LampStatusStore:
                     "music_level": _as_float(kv.get("music_level")),
                     "music_smooth": _as_float(kv.get("music_smooth")),
                     "music_kick_ms": _as_float(kv.get("music_kick_ms")),
+                    "music_bpm": _as_float(kv.get("music_bpm")),
+                    "music_beat_conf": _as_float(kv.get("music_beat_conf")),
+                    "music_beat_phase": _as_float(kv.get("music_beat_phase")),
                 }
             )
         elif line.startswith("[Clap]"):
@@ -0,0 +1,83 @@
+"""Expand tokenized feedback lines (`~<base64>`) from the lamp firmware.
+
+tokens.json is generated by tools/tokens.py from the firmware's TLOG() calls.
+"""
+
+from __future__ import annotations
+
+import base64
+import binascii
+import json
+import re
+import struct
+from pathlib import Path
+
+_SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?[hlLzjt]*([diuxXcfegs%])")
+_TOKENS: dict[int, str] = {
+    int(k, 16): v
+    for k, v in json.loads(
+        (Path(__file__).parent / "tokens.json").read_text(encoding="utf-8")
+    )["tokens"].items()
+}
+
+
+def _varint(buf: bytes, pos: int) -> tuple[int, int]:
+    val = shift = 0
+    while pos < len(buf):
+        b = buf[pos]
+        pos += 1
+        val |= (b & 0x7F) << shift
+        if not b & 0x80:
+            break
+        shift += 7
+    return val, pos
+
+
+def _expand(fmt: str, args: bytes) -> str:
+    pos = 0
+    out: list[str] = []
+    last = 0
+    for m in _SPEC.finditer(fmt):
+        out.append(fmt[last : m.start()])
+        last = m.end()
+        flags, width, prec, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        spec = "%" + flags + width + (f".{prec}" if prec is not None else "")
+        if conv in "di":
+            z, pos = _varint(args, pos)
+            out.append((spec + "d") % ((z >> 1) ^ -(z & 1)))
+        elif conv in "uxX":
+            v, pos = _varint(args, pos)
+            out.append((spec + ("d" if conv == "u" else conv)) % v)
+        elif conv == "c":
+            v, pos = _varint(args, pos)
+            out.append(chr(v))
+        elif conv in "feg":
+            v = struct.unpack_from("<f", args, pos)[0] if pos + 4 <= len(args) else 0.0
+            pos += 4
+            out.append((spec + conv) % v)
+        else:
+            n = args[pos] if pos < len(args) else 0
+            out.append(args[pos + 1 : pos + 1 + n].decode("utf-8", errors="replace"))
+            pos += 1 + n
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def expand_token_line(line: str) -> str:
+    """Return the text form of a tokenized line; other lines pass through."""
+    if not line.startswith("~"):
+        return line
+    try:
+        raw = base64.b64decode(line[1:], validate=True)
+    except (binascii.Error, ValueError):
+        return line
+    if len(raw) < 2:
+        return line
+    tok = raw[0] | (raw[1] << 8)
+    fmt = _TOKENS.get(tok)
+    if fmt is None:
+        return f"[tok 0x{tok:04x}]"
+    return _expand(fmt, raw[2:])
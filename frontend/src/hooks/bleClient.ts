@@ -1,13 +1,15 @@
 const SERVICE = 'd94d86d7-1eaf-47a4-9d1e-7a90bf34e66b';
 const CMD_CHAR = '4bb5047d-0d8b-4c5e-81cd-6fb5c0d1d1f7';
 const STATUS_CHAR = 'c5ad78b6-9b77-4a96-9a42-8e6e9a40c123';
+const TELEMETRY_CHAR = '7f3a2c10-5b6e-4d8a-9c41-2e8f0d6b7a31';
 
-export const BLE_UUIDS = { service: SERVICE, cmd: CMD_CHAR, status: STATUS_CHAR };
+export const BLE_UUIDS = { service: SERVICE, cmd: CMD_CHAR, status: STATUS_CHAR, telemetry: TELEMETRY_CHAR };
 
 export type BleHandles = {
   device: BluetoothDevice;
   cmdChar: BluetoothRemoteGATTCharacteristic;
   statusChar: BluetoothRemoteGATTCharacteristic;
+  telemetryChar: BluetoothRemoteGATTCharacteristic | null;
 };
 
 export type LineHandler = (line: string) => void;
@@ -76,7 +78,9 @@ export async function connectDevice(device: BluetoothDevice): Promise<BleHandles
   }
   const cmdChar = await svc.getCharacteristic(CMD_CHAR);
   const statusChar = await svc.getCharacteristic(STATUS_CHAR);
-  return { device, cmdChar, statusChar };
+  // Optional: firmware built without ENABLE_TELEMETRY has no telemetry characteristic.
+  const telemetryChar = await svc.getCharacteristic(TELEMETRY_CHAR).catch(() => null);
+  return { device, cmdChar, statusChar, telemetryChar };
 }
 
 export function decodeLines(ev: Event): string[] {
@@ -308,7 +308,7 @@ export function parseStatusLine(line: string, setStatus: Dispatch<SetStateAction
         briMin: asNum('bri_min') ?? s.briMin,
         briMax: asNum('bri_max') ?? s.briMax,
         filterIir: kv.filter_iir ? kv.filter_iir.toUpperCase() === 'ON' : s.filterIir,
-        filterIirAlpha: asNum('filter_alpha') ?? s.filterIirAlpha,
+        filterIirAlpha: asNum('filter_iir_a') ?? asNum('filter_alpha') ?? s.filterIirAlpha,
         filterClip: kv.filter_clip ? kv.filter_clip.toUpperCase() === 'ON' : s.filterClip,
         filterClipAmt: asNum('filter_clip_amt') ?? s.filterClipAmt,
         filterClipCurve: asInt('filter_clip_curve') ?? s.filterClipCurve,
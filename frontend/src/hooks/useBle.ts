@@ -2,6 +2,7 @@ import { useCallback, useEffect, useMemo, useRef, useState } from 'react';
 import { toast } from 'react-toastify';
 import { BLE_UUIDS, connectDevice, disconnectDevice, readLines, requestDevice, subscribeToLines, writeLine } from './bleClient';
 import { DeviceStatus, parseStatusLine } from './status';
+import { expandTokenLine } from '@/lib/tokenlog';
 
 type LogEntry = { ts: number; line: string };
 
@@ -133,7 +134,8 @@ export function useBle(): BleApi {
 
   const parseStatus = useCallback((line: string) => parseStatusLine(line, setStatus), []);
 
-  const handleLine = useCallback((line: string) => {
+  const handleLine = useCallback((raw: string) => {
+    const line = expandTokenLine(raw);
     const handled = parseStatus(line);
     if (!handled || !filterParsedRef.current) pushLog(line);
     if (handled) setStatus((s) => ({ ...s, lastStatusAt: Date.now() }));
@@ -322,6 +324,7 @@ export function useBle(): BleApi {
           setKnownDevices({ ...knownDevicesRef.current });
         }
         if (!silent) pushLog('Connected to ' + (dev.name || 'BLE'));
+        await sendCmd('tok on');
         await refreshStatus();
         await sendCmd('custom export');
       } catch (e) {
@@ -0,0 +1,81 @@
+// Decoder for the firmware's binary telemetry batches (see include/telemetry.h).
+// BLE delivers one batch per notification on BLE_UUIDS.telemetry; USB wraps the
+// same bytes as a `TLM|<base64>` line.
+
+export const TELEMETRY_MAGIC = 0xa7;
+export const TELEMETRY_VERSION = 1;
+const HEADER_SIZE = 6;
+const RECORD_SIZE = 20;
+
+export type TelemetryRecord = {
+  seq: number;
+  ms: number;
+  pwm: number; // raw PWM value (0..65535)
+  pattern: number; // 0..1
+  master: number; // 0..1
+  ambient: number; // 0..2
+  output: number; // 0..1
+  music: number; // 0..1
+  touchDelta: number;
+  lightRaw: number;
+};
+
+const q16 = (v: number) => v / 65535;
+
+export function decodeTelemetryBatch(view: DataView): TelemetryRecord[] {
+  if (view.byteLength < HEADER_SIZE) return [];
+  if (view.getUint8(0) !== TELEMETRY_MAGIC || view.getUint8(1) !== TELEMETRY_VERSION) return [];
+  const firstSeq = view.getUint16(2, true);
+  const count = view.getUint8(4);
+  const recSize = view.getUint8(5) || RECORD_SIZE;
+  const out: TelemetryRecord[] = [];
+  for (let i = 0; i < count; i++) {
+    const o = HEADER_SIZE + i * recSize;
+    if (o + RECORD_SIZE > view.byteLength) break;
+    out.push({
+      seq: (firstSeq + i) & 0xffff,
+      ms: view.getUint32(o, true),
+      pwm: view.getUint16(o + 4, true),
+      pattern: q16(view.getUint16(o + 6, true)),
+      master: q16(view.getUint16(o + 8, true)),
+      ambient: q16(view.getUint16(o + 10, true)) * 2,
+      output: q16(view.getUint16(o + 12, true)),
+      music: q16(view.getUint16(o + 14, true)),
+      touchDelta: view.getInt16(o + 16, true),
+      lightRaw: view.getUint16(o + 18, true),
+    });
+  }
+  return out;
+}
+
+export function decodeTelemetryLine(line: string): TelemetryRecord[] {
+  if (!line.startsWith('TLM|')) return [];
+  const bin = atob(line.slice(4));
+  const bytes = new Uint8Array(bin.length);
+  for (let i = 0; i < bin.length; i++) bytes[i] = bin.charCodeAt(i);
+  return decodeTelemetryBatch(new DataView(bytes.buffer));
+}
+
+// Counts records missing between two batches (16-bit sequence wraps).
+export function telemetryGap(prevSeq: number | null, nextSeq: number): number {
+  if (prevSeq === null) return 0;
+  return (nextSeq - prevSeq - 1 + 0x10000) & 0xffff;
+}
+
+export async function subscribeToTelemetry(
+  char: BluetoothRemoteGATTCharacteristic,
+  handler: (records: TelemetryRecord[]) => void,
+): Promise<() => void> {
+  const onNotify = (ev: Event) => {
+    const target = ev.target as BluetoothRemoteGATTCharacteristic;
+    if (!target.value) return;
+    const records = decodeTelemetryBatch(target.value);
+    if (records.length) handler(records);
+  };
+  char.addEventListener('characteristicvaluechanged', onNotify as EventListener);
+  await char.startNotifications();
+  return () => {
+    char.removeEventListener('characteristicvaluechanged', onNotify as EventListener);
+    char.stopNotifications().catch(() => undefined);
+  };
+}
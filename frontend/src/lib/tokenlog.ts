@@ -0,0 +1,106 @@
+// Expands the firmware's tokenized feedback lines (`~<base64>`, see include/tokenlog.h).
+// tokens.json is generated by tools/tokens.py from the TLOG() calls in src/.
+import tokenDb from './tokens.json';
+
+const TOKENS: Record<string, string> = tokenDb.tokens;
+const SPEC = /%([-+ #0]*)(\d*)(?:\.(\d+))?[hlLzjt]*([diuxXcfegs%])/g;
+
+class ArgReader {
+  pos = 0;
+  constructor(private readonly bytes: Uint8Array) {}
+
+  varint(): number {
+    let val = 0;
+    let mul = 1;
+    while (this.pos < this.bytes.length) {
+      const b = this.bytes[this.pos++];
+      val += (b & 0x7f) * mul;
+      if (!(b & 0x80)) break;
+      mul *= 128;
+    }
+    return val;
+  }
+
+  f32(): number {
+    if (this.pos + 4 > this.bytes.length) return 0;
+    const v = new DataView(this.bytes.buffer, this.bytes.byteOffset + this.pos, 4).getFloat32(0, true);
+    this.pos += 4;
+    return v;
+  }
+
+  str(): string {
+    const n = this.pos < this.bytes.length ? this.bytes[this.pos++] : 0;
+    const s = new TextDecoder().decode(this.bytes.subarray(this.pos, this.pos + n));
+    this.pos += n;
+    return s;
+  }
+}
+
+function pad(s: string, flags: string, width: string): string {
+  const w = width ? parseInt(width, 10) : 0;
+  if (s.length >= w) return s;
+  if (flags.includes('-')) return s.padEnd(w, ' ');
+  if (flags.includes('0') && /^-?\d/.test(s)) {
+    const neg = s.startsWith('-');
+    return (neg ? '-' : '') + s.slice(neg ? 1 : 0).padStart(w - (neg ? 1 : 0), '0');
+  }
+  return s.padStart(w, ' ');
+}
+
+export function expandToken(fmt: string, args: Uint8Array): string {
+  const rd = new ArgReader(args);
+  return fmt.replace(SPEC, (_m, flags: string, width: string, prec: string | undefined, conv: string) => {
+    let s: string;
+    switch (conv) {
+      case '%':
+        return '%';
+      case 'd':
+      case 'i': {
+        const z = rd.varint();
+        s = String(z % 2 ? -(z + 1) / 2 : z / 2);
+        break;
+      }
+      case 'u':
+        s = String(rd.varint());
+        break;
+      case 'x':
+        s = rd.varint().toString(16);
+        break;
+      case 'X':
+        s = rd.varint().toString(16).toUpperCase();
+        break;
+      case 'c':
+        s = String.fromCharCode(rd.varint());
+        break;
+      case 'f':
+      case 'e':
+      case 'g': {
+        const v = rd.f32();
+        const p = prec !== undefined ? parseInt(prec, 10) : 6;
+        s = conv === 'e' ? v.toExponential(p) : conv === 'g' ? String(Number(v.toPrecision(p || 1))) : v.toFixed(p);
+        break;
+      }
+      default:
+        s = rd.str();
+    }
+    return pad(s, flags, width);
+  });
+}
+
+// Returns the text form of a `~<base64>` line; other lines pass through unchanged.
+export function expandTokenLine(line: string): string {
+  if (!line.startsWith('~')) return line;
+  let bytes: Uint8Array;
+  try {
+    const bin = atob(line.slice(1));
+    bytes = new Uint8Array(bin.length);
+    for (let i = 0; i < bin.length; i++) bytes[i] = bin.charCodeAt(i);
+  } catch {
+    return line;
+  }
+  if (bytes.length < 2) return line;
+  const tok = bytes[0] | (bytes[1] << 8);
+  const fmt = TOKENS[tok.toString(16).padStart(4, '0')];
+  if (fmt === undefined) return `[tok 0x${tok.toString(16).padStart(4, '0')}]`;
+  return expandToken(fmt, bytes.subarray(2));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+/**
+ * @file adc_scanner.h
+ * @brief Background conversions of the slow analog inputs: light sensor, poti, external input (`adc` command).
+ *
+ * A low-priority task on core 0 wakes every Settings::ADC_SCAN_MS (every
+ * Settings::ADC_SCAN_AUDIO_MS while the I2S capture runs), takes ADC1 once
+ * via audioAdcBegin()/audioAdcEnd() and converts every channel that was read
+ * within Settings::ADC_SCAN_IDLE_MS: the light sensor and the external input
+ * average a few conversions, the poti takes the median of a
+ * Settings::POTI_MEDIAN_SAMPLES burst. A per-channel IIR smooths between the
+ * slower consumer samples. Results are published as one 32-bit word per
+ * channel, so adcScannerRead() never waits for the SAR ADC or a lock.
+ * With ENABLE_ADC_SCANNER 0 (or if the task cannot be created) the same
+ * filtering runs in the caller instead.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+
+enum AdcChannel : uint8_t
+{
+  ADC_CH_LIGHT,
+  ADC_CH_POTI,
+  ADC_CH_EXT,
+  ADC_CH_COUNT
+};
+
+/**
+ * @brief Latest filtered value of a channel (0..4095); starts the scanner on first use.
+ * Reading also keeps the channel in the scan; channels idle for ADC_SCAN_IDLE_MS drop out.
+ * @return False until the scanner has a value for the channel (first pass after a start or idle period).
+ */
+bool adcScannerRead(AdcChannel ch, int &raw);
+
+/**
+ * @brief Report pass rate, busy time per pass and the latest value of each channel (`adc` command).
+ */
+void adcScannerFeedback();
@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file audio_bands.h
+ * @brief Bass/mid/treble energies of one capture block (fixed-point FFT) with per-band AGC.
+ *
+ * The capture task runs a Hann-windowed, Q15 radix-2 FFT over each block of
+ * Settings::AUDIO_BLOCK_SAMPLES and sums the bin energies up to
+ * Settings::AUDIO_BASS_MAX_HZ, up to Settings::AUDIO_MID_MAX_HZ and above.
+ * Each band then gets its own slow peak tracker, so a band reads 1.0 at its
+ * recent loudest and quiet bands are not drowned by loud ones. Band levels
+ * reach the loop through AudioLevels::bands and microphone.h `musicBands`.
+ * The spectral flux of the bass and mid bins feeds the beat tracker, the
+ * spectral centroid the clap detector.
+ */
+
+#include <Arduino.h>
+
+enum AudioBand : uint8_t
+{
+  AUDIO_BAND_BASS = 0,
+  AUDIO_BAND_MID,
+  AUDIO_BAND_TREBLE,
+  AUDIO_BAND_COUNT
+};
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+/** @brief Per-band automatic gain state (one per capture stream). */
+struct AudioBandAgc
+{
+  float peak[AUDIO_BAND_COUNT];  // slow peak tracker of the raw band amplitude
+  float level[AUDIO_BAND_COUNT]; // normalized, attack/release smoothed output
+};
+
+/**
+ * @brief Build the twiddle, window and bit-reversal tables (idempotent).
+ */
+void audioBandsInit();
+
+/**
+ * @brief Forget the previous block, so the first block of a new capture run reports no flux.
+ */
+void audioBandsReset();
+
+/**
+ * @brief FFT one block of raw 12-bit ADC words and return band amplitudes.
+ * @param samples Settings::AUDIO_BLOCK_SAMPLES ADC words (channel bits in the top nibble are ignored).
+ * @param bias DC level in ADC counts, removed before windowing.
+ * @param amp Out: per-band amplitude, roughly the peak of a tone in that band relative to full scale.
+ * @param flux Out: spectral flux below Settings::AUDIO_MID_MAX_HZ (summed magnitude rise since the previous block).
+ * @param centroidHz Out: power-weighted mean frequency of the block (0 for silence).
+ */
+void audioBandsAnalyze(const uint16_t *samples, int32_t bias, float amp[AUDIO_BAND_COUNT], float &flux, float &centroidHz);
+
+/**
+ * @brief Normalize band amplitudes against their own recent peaks.
+ * @param blockMs Time covered by this block (peak decay and release).
+ * @param out Out: band levels 0..1.
+ */
+void audioBandsAgc(AudioBandAgc &agc, const float amp[AUDIO_BAND_COUNT], float blockMs, float out[AUDIO_BAND_COUNT]);
+
+#endif
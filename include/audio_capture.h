@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file audio_capture.h
+ * @brief Continuous microphone capture via the I2S-ADC DMA mode (`audio` command).
+ *
+ * A background task blocks in i2s_read() until the DMA has filled one block of
+ * Settings::AUDIO_BLOCK_SAMPLES at Settings::AUDIO_SAMPLE_RATE, then reduces it
+ * to DC bias, RMS, peak and envelope and publishes those under a spinlock. The
+ * loop only picks up the latest values, so audio costs nothing between blocks.
+ * The same task splits each block into bass/mid/treble levels (audio_bands.h)
+ * and tracks onsets, tempo and beat phase (beat_tracker.h).
+ * While the capture owns ADC1, other ADC1 pins must be read through
+ * audioAnalogRead() or between audioAdcBegin()/audioAdcEnd(), which pause the
+ * DMA around the conversions (the ADC scanner batches a whole pass).
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+#include "audio_bands.h"
+#include "clap_detector.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+/** @brief Block-level levels, normalized to the 12-bit ADC range (0..1). */
+struct AudioLevels
+{
+  uint32_t blocks;   // blocks captured since the last read (0 = nothing new)
+  uint32_t sampleUs; // micros() of the oldest sample in the latest block
+  float blockMs;     // duration of one block
+  float dc;          // slow bias estimate
+  float rms;         // AC RMS of the latest block
+  float peak;        // max |x - dc| over all blocks since the last read
+  float env;         // attack/release envelope of the block mean |x - dc|
+  float bands[AUDIO_BAND_COUNT]; // bass/mid/treble after per-band AGC (audio_bands.h)
+  uint8_t onsets;         // onsets since the last read (beat_tracker.h)
+  float bpm;              // 0 = no tempo yet
+  float beatConf;         // tempo confidence 0..1
+  uint32_t beatUs;        // micros() of the latest predicted beat (audio time)
+  uint32_t beatPeriodUs;  // 0 = no tempo yet
+  uint8_t claps;          // claps classified since the last read (clap_detector.h)
+  float clapPeak;         // loudest of those claps, relative to full scale
+  uint16_t clapCandidates; // decided candidates so far; changes when clapLast is new
+  ClapFeatures clapLast;   // features of the latest candidate
+  bool clapLastWasClap;
+};
+
+/**
+ * @brief Install the I2S-ADC driver on Settings::MUSIC_PIN and start the capture task (idempotent).
+ * @return False if the driver could not be started; callers fall back to analogRead().
+ */
+bool audioCaptureStart();
+
+/**
+ * @brief Stop the capture task and release ADC1 (idempotent).
+ */
+void audioCaptureStop();
+
+/** @brief True while the capture task runs. */
+bool audioCaptureRunning();
+
+/**
+ * @brief Fetch the latest levels and record the block-to-consumer latency.
+ * @return True if at least one new block arrived since the previous call.
+ */
+bool audioCaptureRead(AudioLevels &out);
+
+/**
+ * @brief analogRead() that pauses the I2S-ADC around the conversion while the capture runs.
+ */
+int audioAnalogRead(uint8_t pin);
+
+/**
+ * @brief Take ADC1 for one-shot conversions from any task; pauses the I2S-ADC while the capture runs.
+ * Blocks while another task holds ADC1. Pair with audioAdcEnd().
+ */
+void audioAdcBegin();
+
+/** @brief Give ADC1 back to the capture. */
+void audioAdcEnd();
+
+/**
+ * @brief Report rate, blocks, CPU and analysis cycles per block and ADC-to-envelope latency (`audio` command).
+ */
+void audioCaptureFeedback();
+
+#else
+inline int audioAnalogRead(uint8_t pin) { return analogRead(pin); }
+inline void audioAdcBegin() {}
+inline void audioAdcEnd() {}
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file beat_tracker.h
+ * @brief Onset detection, autocorrelation tempo and a phase-locked beat predictor.
+ *
+ * Fed once per capture block with the spectral flux from audio_bands.h. An
+ * adaptive threshold turns the flux into onsets; every
+ * Settings::BEAT_TEMPO_EVERY blocks the autocorrelation of the flux history,
+ * weighted by a tempo prior around Settings::BEAT_PRIOR_BPM, gives the beat
+ * period and a confidence. A phase accumulator advances by one period per
+ * beat and is pulled towards onsets that land near a predicted beat, so beats
+ * can be fired when they are due instead of after they were detected. A
+ * strength-weighted histogram of onset phases re-seeds the phase when several
+ * onsets in a row miss the correction window, or when its peak lies outside
+ * the window; otherwise a phase locked on the off-beat would never recover.
+ * Pure computation, no hardware access.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+#include "settings.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+enum BeatFlags : uint8_t
+{
+  BEAT_ONSET = 0x01,     // this block contains an onset
+  BEAT_PREDICTED = 0x02, // the beat phase wrapped in this block
+};
+
+struct BeatTracker
+{
+  float history[Settings::BEAT_HISTORY_FRAMES]; // onset strength per block, ring buffer
+  uint16_t head;        // next write position
+  uint16_t filled;      // valid entries in history
+  uint16_t sinceTempo;  // blocks since the last tempo estimate
+  uint16_t refractory;  // blocks until the next onset may fire
+  float fluxMean;       // slow mean of the flux (adaptive onset threshold)
+  float periodFrames;   // beat period in blocks, 0 = no tempo yet
+  float phase;          // position in the current beat, 0..1
+  float phaseHist[Settings::BEAT_PHASE_BINS]; // decaying count of onsets per phase bin
+  uint8_t misses;       // consecutive locked onsets outside the correction window
+  float confidence;     // 0..1, smoothed autocorrelation peak / energy
+  float bpm;
+};
+
+/**
+ * @brief Clear history, tempo and phase.
+ */
+void beatTrackerReset(BeatTracker &bt);
+
+/**
+ * @brief Feed the onset strength of one block.
+ * @param frameMs Block duration.
+ * @return BeatFlags of this block.
+ */
+uint8_t beatTrackerFeed(BeatTracker &bt, float flux, float frameMs);
+
+/** @brief True once the tempo is confident enough to fire predicted beats. */
+inline bool beatTrackerLocked(const BeatTracker &bt)
+{
+  return bt.periodFrames > 0.0f && bt.confidence >= Settings::BEAT_LOCK_CONF;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @file boot_profile.h
+ * @brief Boot-phase timestamps (`boot` command).
+ *
+ * Times are micros() since the app started (esp_timer start); the ROM and
+ * second-stage bootloader before that are not included.
+ */
+
+#include <Arduino.h>
+
+extern volatile uint32_t bootFirstLightUs; // first output write that was not "off"
+
+/**
+ * @brief Record the end of boot phase @p phase (string literal, stored by pointer).
+ */
+void bootMark(const char *phase);
+
+/**
+ * @brief Note the first visible output; called from the output writer.
+ */
+inline void bootMarkLight()
+{
+  if (!bootFirstLightUs)
+    bootFirstLightUs = micros() | 1u;
+}
+
+/**
+ * @brief Report all phases with durations and the first-light time.
+ */
+void bootProfileFeedback();
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file clap_detector.h
+ * @brief Block-level clap classifier: onset gate, spectral/temporal features, fixed-point decision tree.
+ *
+ * Fed once per capture block. A block whose RMS jumps well above the previous
+ * block and the slow background opens a candidate; the loudest of the first
+ * two blocks gives spectral centroid, crest factor and bass share, and the
+ * block Settings::CLAP_DECAY_BLOCKS later gives the decay. A small integer
+ * decision tree over these features keeps hand claps (bright, impulsive,
+ * short) and rejects door slams and kicks (bass), speech and sustained
+ * sounds (slow decay) and transients inside loud music (small rise).
+ * Pure computation, no hardware access.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+#include "settings.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+/** @brief Classifier inputs of one candidate, integer units as used by the tree. */
+struct ClapFeatures
+{
+  int16_t riseDb10;     // loudest block RMS over the background, 0.1 dB
+  int16_t decayDb10;    // drop from the loudest block to the decay block, 0.1 dB
+  int16_t centroidHz;   // spectral centroid of the loudest block
+  int16_t crest10;      // peak / RMS of the loudest block, x10
+  int16_t bassPermille; // energy share below Settings::AUDIO_BASS_MAX_HZ, 0..1000
+  float peak;           // loudest sample relative to the swing around the bias, 1 = clipping (`clap thr`)
+};
+
+struct ClapDetector
+{
+  float background; // slow RMS mean outside candidates
+  float prevRms;
+  uint8_t stage;    // 0 = idle, else blocks since the candidate onset
+  float onsetBackground;
+  float maxRms;
+  float centroidHz;
+  float crest;
+  float bassShare;
+  float peak;
+  ClapFeatures last; // features of the latest decided candidate
+  bool lastWasClap;
+  uint16_t candidates; // decided candidates so far (wraps)
+};
+
+/**
+ * @brief Clear background and candidate state.
+ */
+void clapDetectorReset(ClapDetector &cd);
+
+/**
+ * @brief Feed the statistics of one block.
+ * @param rms Block RMS relative to full scale.
+ * @param peak Largest |sample - bias| relative to full scale.
+ * @param centroidHz Spectral centroid (audio_bands.h).
+ * @param bassShare Energy share of the bass band 0..1.
+ * @return True when a candidate was classified as a clap in this block (features in cd.last).
+ */
+bool clapDetectorFeed(ClapDetector &cd, float rms, float peak, float centroidHz, float bassShare, float blockMs);
+
+#endif
@@ -17,11 +17,68 @@ void setupCommunications();
  */
 void pollCommunications();
 
+/**
+ * @brief Feedback topics a client can subscribe to (`sub ...`). Untagged lines are Log.
+ */
+enum class FeedbackTopic : uint8_t
+{
+  State = 0, ///< STATE| live updates
+  Status,    ///< STATUS|/STATUS1|/STATUS2| snapshots and human status
+  Sensors,   ///< SENSORS| snapshots
+  Log,       ///< regular log lines and command replies
+  Debug,     ///< high-rate diagnostics (ClapTrain, touch raw, presence scans)
+  Midi,      ///< MIDI RX traces
+};
+constexpr uint8_t FEEDBACK_TOPIC_COUNT = 6;
+constexpr uint8_t FEEDBACK_TOPICS_ALL = (1u << FEEDBACK_TOPIC_COUNT) - 1;
+
 /**
  * @brief Send a single-line feedback message to Serial/BT and BLE notify (if connected).
  */
 void sendFeedback(const String &line, const bool &force=false);
 
+/**
+ * @brief Send a line tagged with @p topic to every connected client subscribed to it.
+ */
+void sendFeedback(FeedbackTopic topic, const String &line, const bool &force = false);
+
+/**
+ * @brief True if at least one client would accept @p topic right now.
+ * Check this before formatting a line so suppressed topics cost nothing.
+ */
+bool feedbackWanted(FeedbackTopic topic, const bool &force = false);
+
+/**
+ * @brief Resolve and claim the set of clients for a multi-line emission of @p topic.
+ * Applies subscriptions and per-client rate limits once; 0 means nobody listens.
+ */
+uint8_t feedbackRoute(FeedbackTopic topic, const bool &force = false);
+
+/**
+ * @brief Send a line to the clients returned by feedbackRoute().
+ */
+void sendFeedbackRoute(uint8_t route, const String &line);
+
+// Topic subscriptions of the client that issued the current command
+bool feedbackTopicFromName(const String &name, FeedbackTopic &out);
+void feedbackSetTopics(uint8_t mask);
+uint8_t feedbackGetTopics();
+void feedbackSetRate(FeedbackTopic topic, uint32_t minIntervalMs);
+void subscriptionFeedback();
+void feedbackSetTokens(bool enabled);
+bool feedbackGetTokens();
+uint8_t feedbackCommandRoute();
+
+/**
+ * @brief True if the command being handled arrived over BLE.
+ */
+bool feedbackCommandFromBle();
+
+/**
+ * @brief Subset of @p route whose clients asked for tokenized lines (`tok on`).
+ */
+uint8_t feedbackTokenClients(uint8_t route);
+
 /**
  * @brief Returns true if a BLE client is currently connected (if BLE is enabled).
  */
@@ -30,6 +87,11 @@ bool bleActive();
 /** Return true if a BT Serial client is connected (if enabled). */
 bool btHasClient();
 
+/**
+ * @brief True once setupCommunications() has finished (fast boot starts it in a background task).
+ */
+bool communicationsReady();
+
 /** Return last known BLE address (if any). */
 String getLastBleAddr();
 
@@ -61,6 +123,10 @@ uint32_t getBtSleepAfterBleMs();
 #endif
 
 
+// Binary telemetry sink on its own BLE characteristic (ENABLE_BLE && ENABLE_TELEMETRY)
+size_t bleTelemetryPayloadMax();
+bool bleNotifyTelemetry(const uint8_t *data, size_t length);
+
 /**
  * @brief Update the BLE status characteristic (read/notify) with a snapshot string.
  */
@@ -68,8 +134,6 @@ void updateBleStatus(const String &statusPayload);
 
 String getBLEAddress();
 
-bool presenceScanOnce();
-
 // Presence tracking (defined in main.cpp)
 // extern String presenceAddr;
 // extern bool presenceEnabled;
@@ -79,7 +143,6 @@ bool presenceScanOnce();
 // extern String lastBleAddr;
 // extern String lastBtAddr;
 // extern uint32_t lastPresenceSeenMs;
-// extern uint32_t lastPresenceScanMs;
 
 void setBtName(const String &name);
 void setBleName(const String &name);
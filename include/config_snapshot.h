@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * @file config_snapshot.h
+ * @brief Binary config snapshot for backup and cloning (`cfg snap` / `cfg put` / `cfg apply`).
+ *
+ * Layout (little-endian):
+ *   header:   u32 magic "QLC1" | u8 version | u8 setting count | u16 total len | u32 crc32
+ *   settings: per exported registry entry: u32 FNV-1a(key) | f32 value
+ *   extras:   SnapshotExtras (brightness, ramp, idle, touch, quick mask, filters)
+ *   tail:     presence list CSV (rest of the record)
+ * The device sends the record as one `CFG|<base64>` line; the receiver streams
+ * it back in `cfg put <base64>` chunks (several may share one BLE write) and
+ * `cfg apply` validates CRC and ranges before touching any setting, so a
+ * broken transfer changes nothing. Keys unknown to this build are skipped.
+ */
+
+#include <Arduino.h>
+
+/**
+ * @brief Build a snapshot of the exportable settings and send it as `CFG|<base64>`.
+ */
+void configSnapshotExport();
+
+/**
+ * @brief Append one base64 chunk (length multiple of 4) to the pending transfer.
+ */
+bool configSnapshotPut(const String &chunk);
+
+/**
+ * @brief Decode, verify and apply the pending transfer as one unit; clears it either way.
+ */
+bool configSnapshotApply();
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file events.h
+ * @brief Internal change-notification bus.
+ *
+ * Producers only mark what changed (dirty bits plus an optional static reason);
+ * dispatchEvents() is the single consumer and turns everything that changed
+ * since its last run into one outbound update (log lines + one STATE line).
+ */
+
+#include <Arduino.h>
+
+enum LampEvent : uint8_t
+{
+  EVT_BRIGHTNESS = 1u << 0, ///< master brightness changed (continuous: dim, ramp, poti)
+  EVT_LAMP = 1u << 1,       ///< lamp on/off/off-pending changed (discrete)
+  EVT_PATTERN = 1u << 2,    ///< active pattern changed (discrete)
+  EVT_STATE = 1u << 3,      ///< other live-state fields changed (e.g. poti position)
+};
+
+/**
+ * @brief Mark @p bits dirty. @p reason must be a string literal (stored by pointer).
+ * Safe to call from the BLE callback task.
+ */
+void postEvent(uint8_t bits, const char *reason = nullptr);
+
+/**
+ * @brief Coalesce pending events into outbound feedback. Call once per loop.
+ * Discrete changes flush immediately; continuous ones once settled or every
+ * Settings::EVENT_MAX_DELAY_MS while still changing.
+ */
+void dispatchEvents();
+
+/**
+ * @brief Report event/emission counters (`events` command).
+ */
+void eventStatsFeedback();
+
+/**
+ * @brief Reset event/emission counters.
+ */
+void resetEventStats();
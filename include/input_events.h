@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file input_events.h
+ * @brief Timestamped, debounced edges of the switch, push button and digital external input (`gpio` command).
+ *
+ * With ENABLE_INPUT_EVENTS a GPIO interrupt stamps every edge with
+ * esp_timer_get_time() and debounces on those stamps: the first edge that
+ * changes the level is accepted, further edges within the debounce time are
+ * bounce. Accepted edges wait in a small per-input queue and wake the loop
+ * (inputEventsWait()), so gesture timing uses the real edge times instead of
+ * the 10 ms loop grid. inputEventNext() also re-reads the pin and adds an
+ * edge the interrupt could not see (light sleep, level changed again inside
+ * the debounce time). With ENABLE_INPUT_EVENTS 0 the same debounce runs on
+ * polled levels.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+
+enum InputSource : uint8_t
+{
+  INPUT_SRC_SWITCH,
+  INPUT_SRC_PUSH,
+  INPUT_SRC_EXT,
+  INPUT_SRC_COUNT
+};
+
+/** @brief One debounced edge. */
+struct InputEdge
+{
+  bool active; // level after the edge, true = active (pressed / switched on)
+  uint32_t ms; // edge time on the millis() clock
+  uint32_t us; // edge time, low 32 bits of esp_timer_get_time()
+};
+
+/**
+ * @brief Start or stop edge capture for @p src and reset its debounced state to @p active.
+ * Drops queued edges. Call from the loop task (it is the one woken by edges).
+ */
+void inputEventsEnable(InputSource src, bool on, bool active);
+
+/**
+ * @brief Next debounced edge of @p src, oldest first.
+ * @param debounceMs Lockout after an accepted edge; applies from this call on.
+ * @return False if no edge is pending or the input is not enabled.
+ */
+bool inputEventNext(InputSource src, uint32_t debounceMs, InputEdge &e);
+
+/** @brief Sleep up to @p ms; returns early when an input edge arrives. */
+void inputEventsWait(uint32_t ms);
+
+/** @brief End a running inputEventsWait() early; for other input interrupts (touch). */
+void inputEventsWakeFromIsr();
+
+/**
+ * @brief Report edges, bounces, lost edges and edge-to-loop latency per input (`gpio` command).
+ */
+void inputEventsFeedback();
@@ -49,7 +49,7 @@ extern uint32_t pushHoldLastStepMs;
 extern const int SWITCH_ACTIVE_LEVEL;
 extern const uint32_t SWITCH_DEBOUNCE_MS;
 extern const uint32_t MODE_TAP_MAX_MS; // max. Dauer für "kurz Aus" (Mode-Wechsel)
-extern const uint32_t TOUCH_DOUBLE_MS; // Touch-Doppeltipp Erkennung
+extern const uint32_t TOUCH_DOUBLE_MS; // max. Pause zwischen Mehrfach-Tipps
 extern const uint32_t SECURE_BOOT_WINDOW_MS;
 
 #if ENABLE_TOUCH_DIM
@@ -57,7 +57,6 @@ extern const uint32_t SECURE_BOOT_WINDOW_MS;
 extern const int TOUCH_DELTA_ON_DEFAULT; // Counts relativ zur Baseline
 extern const int TOUCH_DELTA_OFF_DEFAULT; // Hysterese
 extern const uint32_t TOUCH_SAMPLE_DT_MS;
-extern const uint32_t TOUCH_EVENT_DEBOUNCE_MS;
 extern const float DIM_RAMP_STEP;
 extern const uint32_t DIM_RAMP_DT_MS;
 extern const float DIM_MIN;
@@ -66,11 +65,15 @@ extern const float DIM_MAX;
 // Touch sensing state
 extern int touchBaseline;
 extern bool touchActive;
+extern int touchLastDelta; // baseline - raw of the last touch sample
 extern uint32_t touchLastSampleMs;
 extern uint32_t touchStartMs;
 extern uint32_t touchLastRampMs;
 extern uint32_t lastTouchReleaseMs;
 extern uint32_t lastTouchChangeMs;
+extern String touchCmd1; // commands for 1/2/3 taps (empty = unbound)
+extern String touchCmd2;
+extern String touchCmd3;
 extern bool dimRampUp;
 extern bool brightnessChangedByTouch;
 extern int touchDeltaOn;
@@ -128,20 +131,25 @@ void updateSwitchLogic();
 void processStartupSwitch();
 
 /**
- * @brief Measure and store a fresh baseline value for the touch electrode.
+ * @brief Start measuring a fresh baseline for the touch electrode (non-blocking, touch_sensor.h).
  */
 void calibrateTouchBaseline();
 
 /**
- * @brief Guided calibration: measure baseline and touched delta to derive thresholds.
+ * @brief Start the guided calibration: baseline and touched delta to derive thresholds (non-blocking).
  */
 void calibrateTouchGuided();
 
 /**
- * @brief Periodically sample the touch sensor to control long-press dimming.
+ * @brief Sample the touch sensor and run gestures: tap bindings and long-press dimming (touch_gesture.h).
  */
 void updateTouchBrightness();
 
+/**
+ * @brief Run the command bound to @p count taps (touchCmd1..3); unbound counts are only logged.
+ */
+void executeTouchCommand(uint8_t count);
+
 
 #if ENABLE_PUSH_BUTTON
 void updatePushButton();
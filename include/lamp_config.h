@@ -21,6 +21,21 @@
 #define ENABLE_MUSIC_MODE 0
 #endif
 
+// Music pin via I2S-ADC DMA in a background task instead of one analogRead() per 25 ms
+#ifndef ENABLE_AUDIO_DMA
+#define ENABLE_AUDIO_DMA 1
+#endif
+
+// Light sensor, poti and external input converted by a background task instead of analogRead() in the loop
+#ifndef ENABLE_ADC_SCANNER
+#define ENABLE_ADC_SCANNER 1
+#endif
+
+// Switch, push button and digital external input via GPIO interrupts with timestamped edges instead of polling
+#ifndef ENABLE_INPUT_EVENTS
+#define ENABLE_INPUT_EVENTS 1
+#endif
+
 #ifndef ENABLE_BLE_MIDI
 #define ENABLE_BLE_MIDI 0
 #endif
@@ -52,6 +67,20 @@
 #ifndef PWM_INVERT_OUTPUT
 #define PWM_INVERT_OUTPUT 0
 #endif
+#ifndef ENABLE_TELEMETRY
+#define ENABLE_TELEMETRY 1
+#endif
+
+// Mirror the live state into RTC memory and restore it on warm resets (see rtc_state.h)
+#ifndef ENABLE_RTC_RESTORE
+#define ENABLE_RTC_RESTORE 1
+#endif
+
+// Light the lamp from persisted state first; touch calibration and BLE/BT start in a background task
+#ifndef ENABLE_FAST_BOOT
+#define ENABLE_FAST_BOOT 0
+#endif
+
 #ifndef DEBUG_BRIGHTNESS_LOG
 #define DEBUG_BRIGHTNESS_LOG 0
 #endif
@@ -44,7 +44,9 @@ extern uint32_t idleOffMs;
 // Core lamp helpers
 void applyPwmLevel(float normalized);
 void logBrightnessChange(const char *reason);
+bool emitBrightnessLog(const char *reason);
 void logLampState(const char *reason = nullptr);
+bool emitLampStateLog(const char *reason, bool force = false);
 void startBrightnessRamp(float target, uint32_t durationMs, bool affectMaster = true, uint8_t easeType = 1, float easePower = 2.0f);
 void updateBrightnessRamp();
 void setLampEnabled(bool enable, const char *reason = nullptr, bool skipRamp = false);
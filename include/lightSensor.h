@@ -8,10 +8,13 @@
 #if ENABLE_LIGHT_SENSOR
 extern bool lightSensorEnabled;
 extern float lightFiltered ;
+extern uint16_t lightLastRaw; // last ADC reading, before self-light compensation and filtering
 extern uint32_t lastLightSampleMs;
-extern uint16_t lightMinRaw;
+extern uint16_t lightMinRaw; // auto-range: min/max of the 5-min means over the last 24 h (persisted)
 extern uint16_t lightMaxRaw;
 extern float lightAlpha;
+extern float lightSelfGain;   // learned sensor counts per full output duty (lamp's own light, persisted)
+extern float lightSelfWeight; // evidence behind lightSelfGain; trusted from Settings::LIGHT_SELF_MIN_WEIGHT
 extern float rampAmbientFactor;
 #endif
 extern float lightGain;
@@ -19,4 +22,18 @@ extern float lightClampMin;
 extern float lightClampMax;
 
 
-void updateLightSensor();
\ No newline at end of file
+void updateLightSensor();
+
+#if ENABLE_LIGHT_SENSOR
+/**
+ * @brief Drop the auto-range history and restart it from lightMinRaw/lightMaxRaw
+ * (after `light calib` or loading settings; 4095/0 = nothing learned yet).
+ */
+void lightRangeRestart();
+
+/** @brief Set the self-illumination model from NVS (0 = learn from scratch). */
+void lightSelfModelRestore(float gain);
+
+/** @brief Report the self-illumination model (`light self`). */
+void lightSelfFeedback();
+#endif
\ No newline at end of file
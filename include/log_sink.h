@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file log_sink.h
+ * @brief Non-blocking output sinks for USB serial and BT-SPP.
+ *
+ * Every line is copied into a per-sink byte ring and written out by a
+ * background drain task, so loop()/input paths never wait on the UART or the
+ * SPP stack. A full ring drops the line and counts it instead of blocking.
+ * Diagnostics use the LOG_x() macros; levels above LOG_LEVEL compile to nothing.
+ */
+
+#include <Arduino.h>
+
+#include "settings.h"
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_VERBOSE 5
+
+// Highest level compiled in (set via -DLOG_LEVEL=...)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+enum LogSinkId : uint8_t
+{
+  LOG_SINK_USB = 0,
+  LOG_SINK_BT,
+  LOG_SINK_COUNT
+};
+
+extern uint8_t logRuntimeLevel; // runtime threshold, <= LOG_LEVEL
+
+/**
+ * @brief Start the background drain task. Lines written earlier stay queued.
+ */
+void logSinkBegin();
+
+/**
+ * @brief Queue one line (CRLF appended) for @p sink; drops it if the ring is full.
+ * @return True if queued.
+ */
+bool logSinkWrite(uint8_t sink, const String &line);
+
+/**
+ * @brief Queue a diagnostic line on USB if @p level passes the runtime threshold.
+ */
+void logWrite(uint8_t level, const String &line);
+
+/**
+ * @brief Report ring usage and drop counters (`log` command).
+ */
+void logSinkStatsFeedback();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(msg) logWrite(LOG_LEVEL_ERROR, (msg))
+#else
+#define LOG_E(msg) do { } while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(msg) logWrite(LOG_LEVEL_WARN, (msg))
+#else
+#define LOG_W(msg) do { } while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(msg) logWrite(LOG_LEVEL_INFO, (msg))
+#else
+#define LOG_I(msg) do { } while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(msg) logWrite(LOG_LEVEL_DEBUG, (msg))
+#else
+#define LOG_D(msg) do { } while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+#define LOG_V(msg) logWrite(LOG_LEVEL_VERBOSE, (msg))
+#else
+#define LOG_V(msg) do { } while (0)
+#endif
@@ -4,6 +4,7 @@
 
 #include "settings.h"
 #include "comms.h"
+#include "audio_bands.h"
 
 #if ENABLE_MUSIC_MODE
 
@@ -14,6 +15,12 @@ extern float musicFiltered;
 extern float musicDc;
 extern float musicEnv;
 extern float musicRawLevel;
+extern float musicBands[AUDIO_BAND_COUNT]; // bass/mid/treble 0..1 (per-band AGC), I2S capture only
+extern uint8_t musicBand;                   // band driving musicFiltered; AUDIO_BAND_COUNT = broadband envelope
+extern float musicBpm;                      // beat tracker tempo, 0 = none yet
+extern float musicBeatConf;                 // tempo confidence 0..1
+extern uint32_t musicBeatRefUs;             // micros() of a predicted beat
+extern uint32_t musicBeatPeriodUs;          // 0 = no tempo
 extern uint32_t lastMusicSampleMs;
 extern float musicGain;
 extern float musicSmoothing; // 0..1 low-pass for direct mode
@@ -28,6 +35,9 @@ extern uint32_t musicLastKickMs;
 extern float clapPrevEnv;
 extern bool clapEnabled;
 extern float clapThreshold;
+#if ENABLE_AUDIO_DMA
+extern float clapPeakThreshold; ///< classified claps count from this peak (1 = clipping); clapThreshold is the envelope level of the analogRead() path
+#endif
 extern uint32_t clapCooldownMs;
 extern uint32_t clapLastMs;
 extern bool clapAbove;
@@ -50,4 +60,8 @@ void executeClapCommand(uint8_t);
 
 #if ENABLE_MUSIC_MODE
 void updateMusicSensor();
+/** @brief Tempo confident enough that Music Beat fires on predicted beats. */
+bool musicBeatLocked();
+/** @brief Current position within the beat, 0..1 (0 = on the beat). */
+float musicBeatPhase();
 #endif
\ No newline at end of file
@@ -18,6 +18,7 @@ extern float patternMarginLow;
 extern float patternMarginHigh;
 extern float patternFilteredLevel;
 extern uint32_t patternFilterLastMs;
+extern float patternRelativeLevel; // last pattern value after invert/margins (0..1)
 
 // Custom pattern editor storage
 static const size_t CUSTOM_MAX = 32;
@@ -28,10 +29,16 @@ extern uint32_t customStepMs;
 float patternCustom(uint32_t ms);
 
 /**
- * @brief Log the currently selected pattern and its index.
+ * @brief Announce the selected pattern (forced: now, otherwise via the event bus).
  */
 void announcePattern(const bool &force=false);
 
+/**
+ * @brief Log the currently selected pattern and its index.
+ * @return true if the line went out (false: nobody subscribed to the log).
+ */
+bool emitPatternLog(const bool &force=false);
+
 /**
  * @brief Find the index of a pattern by name (case-insensitive), -1 if missing.
  */
@@ -5,35 +5,32 @@
 
 // ---------- Persistenz ----------
 extern Preferences prefs;
-extern const uint8_t PROFILE_SLOTS;
-extern const char *PREF_KEY_PROFILE_BASE;
 
 bool parseQuickCsv(const String &csv, uint64_t &outMask);
 
+void exportConfig();
+
+extern uint32_t settingsWriteDelayMs;
+
 /**
- * @brief Build a profile string (cfg import style) without presence/touch/quick.
+ * @brief Schedule persisting all settings (write-behind, coalesced, changed keys only).
  */
-String buildProfileString();
+void saveSettings();
 
 /**
- * @brief Default profiles for slots 1..3 (used if slot is empty).
+ * @brief Write pending settings now (before deliberate reboots/power-down).
  */
-String defaultProfileString(uint8_t slot);
-
+void flushSettings();
 
 /**
- * @brief Apply a profile string (same keys as buildProfileString).
+ * @brief Loop hook: flush once changes have been quiet for settingsWriteDelayMs.
  */
-void applyProfileString(const String &cfg);
-
-bool loadProfileSlot(uint8_t slot, bool announce = true);
-
-void exportConfig();
+void updateSettingsWriteBehind();
 
 /**
- * @brief Persist current brightness, pattern and auto-cycle flag in NVS.
+ * @brief Report NVS write-behind counters (`nvs` command).
  */
-void saveSettings();
+void settingsStatsFeedback();
 
 void applyDefaultSettings(float brightnessOverride, bool announce);
 
@@ -45,3 +42,8 @@ void loadSettings();
 
 
 void importConfig(const String &args);
+
+/**
+ * @brief Cross-field rules the per-entry registry ranges cannot express (pat_hi >= pat_lo, ...).
+ */
+void sanitizeLinkedSettings();
@@ -20,10 +20,30 @@ extern bool presenceLastOffByPresence;
 extern String lastBleAddr;
 extern String lastBtAddr;
 extern uint32_t lastPresenceSeenMs;
-extern uint32_t lastPresenceScanMs;
 
-// Active presence scan for target MAC (returns true if found)
-bool presenceScanOnce();
+/**
+ * @brief Run the background scan and the per-device enter/leave decision; call every loop pass.
+ *
+ * The passive BLE scan's callback looks each advertiser up in a hash table
+ * of 48-bit addresses and feeds the target's RSSI EMA; here a device enters
+ * at presenceRssiThreshold and leaves below threshold - PRESENCE_RSSI_HYST_DB
+ * or after PRESENCE_LEAVE_MS without advertisements. The scan adapts to the
+ * state: off while @p targetConnected, paused for PRESENCE_BACKOFF_MS after a
+ * present device was heard, then a fast burst until it is heard again (or
+ * leaves); fast during the grace time before auto-off, and a 15% search scan
+ * while nobody is present. Fast scans use short windows while a BLE client
+ * is connected. Never blocks.
+ * @param targetConnected A listed device is connected over BLE/BT (presence known without scanning).
+ * @return True while at least one listed device is present by scan.
+ */
+bool presenceScanUpdate(bool targetConnected);
+
+/** @brief Scan mode, radio-on time, loop cost, detection/leave latency and per-device RSSI (`presence stats`). */
+void presenceScanFeedback();
+
+/** @brief Parse "aa:bb:cc:dd:ee:ff" (':' / '-' optional, any case) into a 48-bit integer. */
+bool presenceParseAddr(const String &text, uint64_t &addr);
+
 String presenceListCsv();
 bool presenceAddDevice(const String &addr);
 bool presenceRemoveDevice(const String &addr);
@@ -26,13 +26,15 @@ void printStatusStructured(const bool &force=false);
 
 /**
  * @brief Queue a compact state event for connected UIs.
+ * @return true if the line went out now (false: unchanged, nobody subscribed or deferred by the rate limit).
  */
-void queueLiveState(const bool &force=false);
+bool queueLiveState(const bool &force=false);
 
 /**
- * @brief Emit a pending rate-limited state event when due.
+ * @brief Emit a pending rate-limited state event when due. Called by dispatchEvents().
+ * @return true if a line went out.
  */
-void flushLiveState();
+bool flushLiveState();
 
 /**
  * @brief Print available serial/BLE command usage.
@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file profiles.h
+ * @brief Profile slots stored as binary scene records and cached in RAM.
+ *
+ * A scene holds the look of the lamp (pattern, brightness, ramps, margins,
+ * light/music tuning). Recall copies the cached record into the live
+ * settings in one call, without parsing and without touching NVS unless the
+ * caller asks for it. Memory: Settings::PROFILE_SLOTS * sizeof(ProfileScene)
+ * bytes of RAM (32 * 84 B ~ 2.7 KB) plus one NVS blob per saved slot (the
+ * record and a CRC-32; a blob that fails the check falls back to the empty or
+ * built-in scene). Recall applies every value through the settings registry,
+ * so out-of-range values are clamped or skipped like `set` would.
+ */
+
+#include <Arduino.h>
+
+#include "settings.h"
+
+extern const uint8_t PROFILE_SLOTS;
+
+/** @brief Which fields of a scene are set (unset fields keep the live value). */
+enum SceneField : uint32_t
+{
+  SCENE_PATTERN = 1ul << 0,
+  SCENE_BRI = 1ul << 1,
+  SCENE_AUTO = 1ul << 2,
+  SCENE_PAT_SCALE = 1ul << 3,
+  SCENE_RAMP = 1ul << 4,
+  SCENE_RAMP_ON = 1ul << 5,
+  SCENE_RAMP_OFF = 1ul << 6,
+  SCENE_PAT_FADE = 1ul << 7,
+  SCENE_PAT_FADE_AMT = 1ul << 8,
+  SCENE_PAT_INV = 1ul << 9,
+  SCENE_PAT_LO = 1ul << 10,
+  SCENE_PAT_HI = 1ul << 11,
+  SCENE_EASE_ON = 1ul << 12,
+  SCENE_EASE_OFF = 1ul << 13,
+  SCENE_POW_ON = 1ul << 14,
+  SCENE_POW_OFF = 1ul << 15,
+  SCENE_BRI_MIN = 1ul << 16,
+  SCENE_BRI_MAX = 1ul << 17,
+  SCENE_GAMMA = 1ul << 18,
+  SCENE_RAMP_AMB = 1ul << 19,
+  SCENE_LIGHT_GAIN = 1ul << 20,
+  SCENE_LIGHT_MIN = 1ul << 21,
+  SCENE_LIGHT_MAX = 1ul << 22,
+  SCENE_LIGHT_ALPHA = 1ul << 23,
+  SCENE_LIGHT_EN = 1ul << 24,
+  SCENE_MUSIC_EN = 1ul << 25,
+  SCENE_MUSIC_GAIN = 1ul << 26,
+  SCENE_CLAP_EN = 1ul << 27,
+  SCENE_CLAP_THR = 1ul << 28,
+  SCENE_CLAP_COOL = 1ul << 29,
+};
+
+/** @brief Bool fields packed into ProfileScene::flags. */
+enum SceneFlag : uint8_t
+{
+  SCENE_FLAG_AUTO = 1u << 0,
+  SCENE_FLAG_PAT_FADE = 1u << 1,
+  SCENE_FLAG_PAT_INV = 1u << 2,
+  SCENE_FLAG_LIGHT_EN = 1u << 3,
+  SCENE_FLAG_MUSIC_EN = 1u << 4,
+  SCENE_FLAG_CLAP_EN = 1u << 5,
+};
+
+struct __attribute__((packed)) ProfileScene
+{
+  uint8_t version; // PROFILE_SCENE_VERSION, 0 = empty slot
+  uint8_t pattern; // index into PATTERNS
+  uint8_t flags;   // SceneFlag bits
+  uint8_t easeOn;
+  uint8_t easeOff;
+  uint8_t reserved;
+  uint16_t bri1000; // brightness * 1000
+  uint32_t fields;  // SceneField bits
+  uint16_t rampMs;
+  uint16_t rampOnMs;
+  uint16_t rampOffMs;
+  uint16_t clapCoolMs;
+  float patScale;
+  float patFadeAmt;
+  float patLo;
+  float patHi;
+  float powOn;
+  float powOff;
+  float briMin;
+  float briMax;
+  float gamma;
+  float rampAmb;
+  float lightGain;
+  float lightMin;
+  float lightMax;
+  float lightAlpha;
+  float musicGain;
+  float clapThr;
+};
+
+constexpr uint8_t PROFILE_SCENE_VERSION = 1;
+static_assert(sizeof(ProfileScene) == 84, "ProfileScene is a stored record; bump PROFILE_SCENE_VERSION on layout changes");
+
+/**
+ * @brief Read all slots into the RAM cache (migrates old text profiles). Call after prefs.begin().
+ */
+void profilesBegin();
+
+/**
+ * @brief Drop cached slots (after a factory reset cleared NVS).
+ */
+void profilesReset();
+
+/**
+ * @brief True if @p slot (1-based) holds a scene (saved or built-in default).
+ */
+bool profileSlotUsed(uint8_t slot);
+
+/**
+ * @brief Capture the live settings into @p slot (RAM + NVS).
+ */
+bool saveProfileSlot(uint8_t slot);
+
+/**
+ * @brief Apply a cached scene. Persists the resulting settings only if @p persist.
+ */
+bool loadProfileSlot(uint8_t slot, bool announce = true, bool persist = false);
+
+/**
+ * @brief Empty @p slot (RAM + NVS); slots 1..3 fall back to their built-in scene.
+ */
+bool clearProfileSlot(uint8_t slot);
+
+/**
+ * @brief Report used slots, record size and the last recall time (`profile` command).
+ */
+void profileStatsFeedback();
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file rtc_state.h
+ * @brief Live lamp state mirrored into RTC slow memory for instant restore after warm resets.
+ *
+ * The loop keeps a small CRC-checked record (lamp on, brightness, pattern,
+ * pattern phase, raw output) in RTC_NOINIT memory, which survives software,
+ * panic, watchdog and brownout resets but not power-on. On such a warm reset
+ * setup() re-drives the output from the record before Serial, NVS and the
+ * radios start, then restores the runtime state once settings are loaded and
+ * skips the secure-boot hold. Cold boots behave as before. After three warm
+ * resets in a row without reaching Settings::RTC_STABLE_MS of uptime, every
+ * further warm reset boots cold until one boot reaches stable uptime, so a
+ * state that crashes the firmware is not restored forever.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+
+#if ENABLE_RTC_RESTORE
+
+/**
+ * @brief First call in setup(): on a warm reset with a valid record, set up the output and drive it.
+ * @return True if the light was restored (warm boot).
+ */
+bool rtcStateRestoreOutput();
+
+/**
+ * @brief After loadSettings(): re-apply lamp on/off, brightness, pattern and phase from the record.
+ */
+void rtcStateApply();
+
+/**
+ * @brief Loop hook: refresh the record from the live state.
+ */
+void rtcStateUpdate();
+
+/**
+ * @brief Report reset reason and restore timing (`rtc` command).
+ */
+void rtcStateFeedback();
+
+#else
+inline bool rtcStateRestoreOutput() { return false; }
+inline void rtcStateApply() {}
+inline void rtcStateUpdate() {}
+inline void rtcStateFeedback() {}
+#endif
@@ -23,6 +23,7 @@ constexpr const char *BT_NAME_DEFAULT = "Superduperlampe-SPP";
 constexpr const char *BLE_SERVICE_UUID = "d94d86d7-1eaf-47a4-9d1e-7a90bf34e66b";
 constexpr const char *BLE_COMMAND_CHAR_UUID = "4bb5047d-0d8b-4c5e-81cd-6fb5c0d1d1f7";
 constexpr const char *BLE_STATUS_CHAR_UUID = "c5ad78b6-9b77-4a96-9a42-8e6e9a40c123"; ///< Read/Notify current status snapshot
+constexpr const char *BLE_TELEMETRY_CHAR_UUID = "7f3a2c10-5b6e-4d8a-9c41-2e8f0d6b7a31"; ///< Notify binary telemetry batches
 
 // ---- Defaults ----
 constexpr float DEFAULT_BRIGHTNESS = 0.7f;     ///< Used on first boot if no NVS value
@@ -78,9 +79,27 @@ constexpr uint32_t PRESENCE_GRACE_MS_DEFAULT = 3000; ///< Wait before presence-o
 constexpr int PRESENCE_RSSI_THRESHOLD_DEFAULT = -80; ///< Min RSSI (dBm) to count as present
 constexpr bool PRESENCE_AUTO_ON_DEFAULT = true;  ///< Turn lamp on when presence returns (if presence turned it off)
 constexpr bool PRESENCE_AUTO_OFF_DEFAULT = true; ///< Turn lamp off when last device leaves
+constexpr uint16_t PRESENCE_SEARCH_WINDOW_MS = 48;  ///< passive scan while nobody is present: window ...
+constexpr uint16_t PRESENCE_SEARCH_INTERVAL_MS = 320; ///< ... per interval (15% radio time)
+constexpr uint16_t PRESENCE_FAST_WINDOW_MS = 96;    ///< re-check bursts and grace time (75%) ...
+constexpr uint16_t PRESENCE_FAST_INTERVAL_MS = 128;
+constexpr uint16_t PRESENCE_CONN_WINDOW_MS = 30;    ///< fast/search windows capped to this while a BLE client is connected (fast 30%)
+constexpr uint16_t PRESENCE_CONN_INTERVAL_MS = 100;
+constexpr uint32_t PRESENCE_BACKOFF_MS = 10000;     ///< no scan this long after a present device was heard
+constexpr uint32_t PRESENCE_SCAN_CHUNK_S = 10;      ///< scan restarted (and its result list cleared) this often
+constexpr float PRESENCE_RSSI_ALPHA = 0.3f;         ///< per-advertisement RSSI EMA weight
+constexpr int PRESENCE_RSSI_HYST_DB = 6;            ///< leave below threshold - this (enter at threshold)
+constexpr uint32_t PRESENCE_LEAVE_MS = 14000;       ///< leave after no advertisement for this long (backoff + 4 s burst)
 constexpr bool TOUCH_DIM_DEFAULT_ENABLED = false;
 constexpr uint32_t TOUCH_HOLD_MS_DEFAULT = 1000; ///< Default touch hold start (ms)
 constexpr float TOUCH_DIM_STEP_DEFAULT = 0.005f; ///< Default step for touch-dimming per tick
+constexpr uint32_t TOUCH_FILTER_MS = 10;         ///< touch IIR filter period; the baseline is tracked in its callback
+constexpr uint16_t TOUCH_SLEEP_CYCLES = 0x300;   ///< FSM pause between pad measurements (~5 ms at 150 kHz; core default 0x1000 = 27 ms)
+constexpr uint16_t TOUCH_MEASURE_CYCLES = 0x1000; ///< pad measurement time (0.5 ms at 8 MHz, core default)
+constexpr uint32_t TOUCH_BASELINE_TAU_MS = 400;  ///< baseline drift time constant while untouched
+constexpr uint32_t TOUCH_CALIB_BASE_MS = 160;    ///< baseline calibration sampling time
+constexpr uint32_t TOUCH_CALIB_SETTLE_MS = 200;  ///< guided calibration: pause after each prompt
+constexpr uint32_t TOUCH_CALIB_PHASE_MS = 2000;  ///< guided calibration: release / hold sampling time
 constexpr float LIGHT_GAIN_DEFAULT = 1.0f;
 constexpr float LIGHT_CLAMP_MIN_DEFAULT = 0.2f;
 constexpr float LIGHT_CLAMP_MAX_DEFAULT = 1.0f;
@@ -93,11 +112,40 @@ constexpr uint32_t CUSTOM_STEP_MS_DEFAULT = 800;///< default step time for custo
 #define REQUIRE_FEEDBACK_HANDSHAKE 1
 #endif
 constexpr bool FEEDBACK_NEEDS_HANDSHAKE = REQUIRE_FEEDBACK_HANDSHAKE;
+constexpr uint32_t EVENT_SETTLE_MS = 150;    ///< Continuous changes (dim/ramp/poti) flush after this quiet time
+constexpr uint32_t EVENT_MAX_DELAY_MS = 500; ///< ...or at least this often while still changing
+constexpr uint16_t TELEMETRY_HZ_DEFAULT = 50;       ///< Telemetry sample rate (10..TELEMETRY_HZ_MAX)
+constexpr uint16_t TELEMETRY_HZ_MAX = 50;           ///< Sampled from the loop, which paces at 10 ms plus its own work
+constexpr uint32_t TELEMETRY_BATCH_MAX_MS = 100;    ///< Flush a partial telemetry batch after this age
+constexpr size_t LOG_USB_RING_BYTES = 4096;         ///< Async USB output ring (power of two)
+constexpr size_t LOG_BT_RING_BYTES = 2048;          ///< Async BT-SPP output ring (power of two)
+constexpr size_t TOKEN_ARGS_MAX = 64;               ///< Encoded argument bytes per tokenized line
+constexpr uint32_t NVS_WRITE_DELAY_MS_DEFAULT = 2000; ///< Write settings after this quiet period
+constexpr uint32_t NVS_WRITE_MAX_DELAY_MS = 30000;   ///< ...but no later than this after the first change
+constexpr size_t NVS_SHADOW_SLOTS = 160;             ///< Key/value hash cache (> number of persisted keys)
+constexpr size_t SETTINGS_INDEX_SLOTS = 128;         ///< Hashed cfg-key index of the settings registry (power of two)
+constexpr uint8_t PROFILE_SLOTS = 32;                ///< Scene slots, cached in RAM (32 * 84 B, see profiles.h)
+constexpr size_t CFG_SNAPSHOT_MAX_BYTES = 1024;       ///< Binary config snapshot limit (`cfg snap` / `cfg put`)
+constexpr uint32_t CFG_SNAPSHOT_PUT_TIMEOUT_MS = 30000; ///< Drop a partial `cfg put` transfer after this pause
+constexpr uint32_t RTC_STABLE_MS = 10000;             ///< Uptime after which a boot counts as stable (RTC restore guard)
+constexpr uint8_t RTC_MAX_QUICK_RESETS = 3;          ///< Warm resets in a row before the RTC state is ignored
+constexpr uint8_t BOOT_MARKS_MAX = 16;               ///< Boot-phase timestamps kept for `boot`
+constexpr uint32_t BOOT_TASK_STACK = 8192;           ///< Fast boot: stack of the radio/touch init task
 
 #ifndef ENABLE_HELP_TEXT
 #define ENABLE_HELP_TEXT 0
 #endif
 
+// Persist settings as one CRC-checked A/B record instead of one NVS key each (see settings_blob.h)
+#ifndef SETTINGS_BLOB
+#define SETTINGS_BLOB 0
+#endif
+
+// Keep TLOG() format strings in flash for plain-text clients (0 = tokens only and the flash saving, see tokenlog.h)
+#ifndef TOKEN_LOG_TEXT
+#define TOKEN_LOG_TEXT 1
+#endif
+
 #ifndef ENABLE_FILTERS
 #define ENABLE_FILTERS 1
 #endif
@@ -110,6 +158,7 @@ constexpr int EXT_INPUT_PIN = EXT_INPUT_PIN_NUM; ///< GPIO for optional external
 constexpr bool EXT_INPUT_ANALOG_DEFAULT = true;  ///< true=analog brightness, false=digital on/off
 constexpr bool EXT_INPUT_ACTIVE_LOW = true;      ///< for digital mode
 constexpr uint32_t EXT_INPUT_SAMPLE_MS = 50;     ///< sample interval for analog
+constexpr uint32_t EXT_INPUT_DEBOUNCE_MS = 10;   ///< edge lockout for digital
 constexpr float EXT_INPUT_ALPHA = 0.2f;          ///< low-pass alpha for analog
 constexpr float EXT_INPUT_DELTA = 0.02f;         ///< minimum change to apply brightness update
 #endif
@@ -138,6 +187,28 @@ constexpr bool LIGHT_SENSOR_DEFAULT_ENABLED = false;
 constexpr uint32_t LIGHT_SAMPLE_MS = 200;       ///< light sensor sample interval
 constexpr float LIGHT_ALPHA = 0.1f;             ///< low-pass filter factor
 constexpr int LIGHT_PIN = 35;                   ///< default ADC pin for ambient light
+constexpr uint32_t LIGHT_RANGE_BUCKET_MS = 300000; ///< auto-range history: one mean per 5 min
+constexpr uint16_t LIGHT_RANGE_BUCKETS = 288;   ///< auto-range window length in buckets (24 h)
+constexpr int LIGHT_RANGE_MIN_SPAN = 20;        ///< narrower window: fall back to raw / 4095
+constexpr uint32_t LIGHT_RANGE_SAVE_MS = 3600000; ///< persist the learned range at most hourly ...
+constexpr int LIGHT_RANGE_SAVE_DELTA = 16;      ///< ... and only after it moved by this many counts
+constexpr float LIGHT_SELF_MIN_STEP = 0.05f;    ///< self-illumination model: min. duty change between two steady outputs
+constexpr uint32_t LIGHT_SELF_MAX_GAP_MS = 10000; ///< ... within this time (longer: ambient may have moved too)
+constexpr uint32_t LIGHT_SELF_SETTLE_MS = 800;    ///< output unchanged this long counts as steady (16 scanner passes at 50 ms: IIR within 1 %)
+constexpr float LIGHT_SELF_DECAY = 0.95f;       ///< weight kept per observation (forgets old fixtures/placement)
+constexpr float LIGHT_SELF_MIN_WEIGHT = 0.25f;  ///< sum of squared duty steps before the model is trusted
+constexpr float LIGHT_AMBIENT_BLEND = 0.02f;    ///< ambientScale IIR per sample without a trusted model
+constexpr float LIGHT_AMBIENT_STEP = 0.005f;    ///< ambientScale step cap per sample without a trusted model
+constexpr float LIGHT_AMBIENT_BLEND_FAST = 0.1f; ///< ... with the lamp's own light subtracted
+constexpr float LIGHT_AMBIENT_STEP_FAST = 0.02f;
+#endif
+
+#if ENABLE_LIGHT_SENSOR || ENABLE_POTI || ENABLE_EXT_INPUT
+constexpr uint32_t ADC_SCAN_MS = 20;            ///< ADC scanner pass interval (ENABLE_ADC_SCANNER)
+constexpr uint32_t ADC_SCAN_AUDIO_MS = 50;      ///< pass interval while the I2S capture runs (each pass pauses it)
+constexpr uint8_t ADC_SCAN_OVERSAMPLE = 4;      ///< conversions averaged per channel and pass (poti: median burst)
+constexpr uint32_t ADC_SCAN_IDLE_MS = 3000;     ///< channels nobody read for this long are not converted
+constexpr uint32_t ADC_SCAN_TASK_STACK = 2048;
 #endif
 
 #if ENABLE_MUSIC_MODE
@@ -147,8 +218,28 @@ constexpr uint32_t MUSIC_SAMPLE_MS = 25;
 constexpr float MUSIC_ALPHA = 0.25f;
 constexpr float MUSIC_GAIN_DEFAULT = 1.0f;
 constexpr bool CLAP_DEFAULT_ENABLED = false;
-constexpr float CLAP_THRESHOLD_DEFAULT = 0.35f; ///< normalized 0..1
+constexpr float CLAP_THRESHOLD_DEFAULT = 0.35f; ///< analogRead() path: envelope level, normalized 0..1
+constexpr float CLAP_PEAK_DEFAULT = 0.35f;      ///< classified claps (ENABLE_AUDIO_DMA): peak relative to full scale
 constexpr uint32_t CLAP_COOLDOWN_MS_DEFAULT = 800;
+constexpr uint32_t AUDIO_SAMPLE_RATE = 16000;   ///< I2S-ADC capture rate of the music pin (ENABLE_AUDIO_DMA)
+constexpr uint16_t AUDIO_BLOCK_SAMPLES = 256;   ///< samples per DMA block (16 ms at 16 kHz)
+constexpr int AUDIO_DMA_BUFFERS = 4;            ///< DMA blocks queued before samples are dropped
+constexpr float AUDIO_ENV_ATTACK = 0.6f;        ///< envelope rise per block; release follows MUSIC_ALPHA
+constexpr uint32_t AUDIO_TASK_STACK = 3072;
+constexpr uint16_t AUDIO_BASS_MAX_HZ = 200;     ///< upper edge of the bass band (kick drums)
+constexpr uint16_t AUDIO_MID_MAX_HZ = 2000;     ///< upper edge of the mid band; treble above
+constexpr uint32_t AUDIO_AGC_DECAY_MS = 4000;   ///< per-band peak tracker decay (AGC)
+constexpr float AUDIO_AGC_FLOOR = 0.02f;        ///< smallest AGC reference, keeps silence dark
+constexpr float BEAT_MIN_BPM = 60.0f;            ///< beat tracker tempo search range
+constexpr float BEAT_MAX_BPM = 180.0f;
+constexpr float BEAT_PRIOR_BPM = 120.0f;         ///< centre of the tempo prior (against octave errors)
+constexpr uint16_t BEAT_HISTORY_FRAMES = 256;    ///< onset-strength history for the autocorrelation (~4 s)
+constexpr uint8_t BEAT_PHASE_BINS = 16;          ///< onset-phase histogram for re-acquiring a lost beat phase
+constexpr uint16_t BEAT_TEMPO_EVERY = 32;        ///< blocks between tempo estimates (~0.5 s)
+constexpr float BEAT_LOCK_CONF = 0.3f;           ///< confidence needed before predicted beats fire
+constexpr uint32_t MUSIC_BEAT_LEAD_MS = 10;      ///< fire predicted beats this early (loop granularity)
+constexpr uint8_t CLAP_DECAY_BLOCKS = 3;         ///< blocks after a clap onset until its decay is judged (~50 ms)
+constexpr uint32_t CLAP_SERIES_GAP_MS = 450;     ///< classified claps: the count is final this long after the last clap
 #endif
 
 #if ENABLE_BT_SERIAL
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file settings_blob.h
+ * @brief Versioned, CRC-protected settings record stored in two alternating NVS slots.
+ *
+ * Layout (little-endian):
+ *   header:  u32 magic "QLS1" | u16 version | u16 record count | u32 seq | u32 payload len | u32 crc32
+ *   payload: per setting: u32 FNV-1a(key) | u16 len | value bytes (native layout of the prefs type)
+ * Saves go to the slot not holding the newest valid record, so a power cut
+ * during a write leaves the previous record intact. Records are looked up by
+ * the hash of the existing PREF_KEY_* names; keys missing from the record
+ * fall back to the legacy key-per-setting entries (migration path).
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+struct SettingsBlobInfo
+{
+  bool valid;          // a record was restored at boot
+  uint8_t slot;        // 0 = A, 1 = B
+  uint32_t seq;        // sequence of the restored/last written record
+  uint16_t records;    // settings in the restored/last written record
+  uint32_t bytes;      // header + payload of the last record
+};
+
+/**
+ * @brief Read both slots and keep the newest valid record for settingsBlobFind().
+ */
+bool settingsBlobLoad(Preferences &prefs);
+
+/**
+ * @brief Look up @p key in the loaded record; false if absent.
+ */
+bool settingsBlobFind(const char *key, const uint8_t *&data, uint16_t &len);
+
+/**
+ * @brief Free the boot-time read buffer (after loadSettings()).
+ */
+void settingsBlobRelease();
+
+/**
+ * @brief Start building a new record.
+ */
+void settingsBlobBegin();
+
+/**
+ * @brief Append one setting to the record under construction.
+ */
+void settingsBlobAppend(const char *key, const void *data, uint16_t len);
+
+/**
+ * @brief Write the record to the inactive slot unless it equals the active one.
+ * @return Flash bytes consumed (NVS entries * 32), 0 if skipped or failed.
+ */
+size_t settingsBlobCommit(Preferences &prefs, bool &failed);
+
+/**
+ * @brief Forget the active record (after the namespace was cleared).
+ */
+void settingsBlobReset();
+
+const SettingsBlobInfo &settingsBlobInfo();
@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file settings_registry.h
+ * @brief One table for all plain scalar settings: CLI `set/get`, cfg import/export and NVS.
+ *
+ * Each entry carries its cfg key, NVS key, type, target variable, range and
+ * default. Filter parameters have a second table of the same entries over a
+ * copy of the filter state. Composite values (brightness, ramp, idle, touch
+ * thresholds, presence lists, quick mask) go through import/export hooks in
+ * persistence.cpp.
+ */
+
+#include <Arduino.h>
+
+enum class SettingType : uint8_t
+{
+  Bool,  // bool, "on"/"off"
+  U8,    // uint8_t
+  Ease,  // uint8_t ease type, "linear"/"ease"/...
+  Int,   // int
+  U32,   // uint32_t
+  Float, // float
+};
+
+enum SettingFlags : uint8_t
+{
+  SETTING_PERSIST = 0x01, // stored under prefKey
+  SETTING_EXPORT = 0x02,  // part of `cfg export`
+  SETTING_STATUS = 0x04,  // listed by `get`
+  SETTING_CLAMP = 0x08,   // out-of-range values are clamped (otherwise rejected)
+};
+
+struct SettingDef
+{
+  const char *key;     // cfg/CLI key
+  const char *prefKey; // NVS key
+  uint32_t hash;       // FNV-1a of key (compile time)
+  SettingType type;
+  void *ptr;
+  float minVal;
+  float maxVal;
+  float defVal;
+  uint8_t decimals; // Float formatting
+  uint8_t flags;
+};
+
+size_t settingCount();
+const SettingDef &settingAt(size_t i);
+
+/**
+ * @brief O(1) lookup by (lower-case) cfg key; nullptr if unknown.
+ */
+const SettingDef *settingFind(const char *key);
+
+/**
+ * @brief Lookup by key hash (binary config snapshots); nullptr if unknown.
+ */
+const SettingDef *settingFindHash(uint32_t hash);
+
+/**
+ * @brief Current value as float (bools 0/1).
+ */
+float settingValue(const SettingDef &def);
+
+/**
+ * @brief Range-check (or clamp) and assign; false if rejected.
+ */
+bool settingAssign(const SettingDef &def, float v);
+
+/**
+ * @brief Parse a cfg/CLI value ("on", "0.25", "ease", ...) and assign it.
+ */
+bool settingParse(const SettingDef &def, const String &val);
+
+/**
+ * @brief Format the current value the way settingParse() reads it back.
+ */
+String settingFormat(const SettingDef &def);
+
+/**
+ * @brief Append ` key=value` for every entry carrying @p flag.
+ */
+void settingsAppend(String &out, uint8_t flag);
+
+/**
+ * @brief Filter parameter entries (filter_iir, filter_clip_amt, ...); same helpers as the main table.
+ *
+ * The entries point into a copy of the filter state: call
+ * filterSettingsCapture() before reading or assigning them and
+ * filterSettingsApply() to hand assigned values to filtersSet*().
+ */
+size_t filterSettingCount();
+const SettingDef &filterSettingAt(size_t i);
+const SettingDef *filterSettingFind(const char *key);
+void filterSettingsCapture();
+void filterSettingsApply();
+
+/**
+ * @brief Append `<sep>key=value` for every filter entry carrying @p flag (call filterSettingsCapture() first).
+ */
+void filterSettingsAppend(String &out, uint8_t flag, char sep = ' ');
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file telemetry.h
+ * @brief Opt-in binary telemetry stream (output + sensors) at 10..50 Hz.
+ *
+ * Records are fixed-size and little-endian. Several records share one batch:
+ *   header: u8 magic(0xA7) | u8 version | u16 seq of first record | u8 count | u8 record size
+ *   record: u32 ms | u16 pwm | u16 pattern | u16 master | u16 ambient | u16 output |
+ *           u16 music | i16 touch delta | u16 light raw
+ * Levels are scaled 0..1 -> 0..65535 (ambient 0..2 -> 0..65535). Light raw is
+ * the last ADC reading of the sensor, before self-light compensation and filtering.
+ * BLE: one batch per notification on Settings::BLE_TELEMETRY_CHAR_UUID; a
+ * batch with one record is 26 bytes, so BLE needs an ATT MTU of at least 29
+ * (the default 23 is refused).
+ * Samples are taken by the loop, which runs every 10 ms plus its own work:
+ * Settings::TELEMETRY_HZ_MAX is the highest rate it holds.
+ * USB: one `TLM|<base64 batch>` line per batch so it can share the console.
+ */
+
+#include <Arduino.h>
+
+#include "lamp_config.h"
+
+#if ENABLE_TELEMETRY
+
+constexpr uint8_t TELEMETRY_MAGIC = 0xA7;
+constexpr uint8_t TELEMETRY_VERSION = 1;
+
+struct __attribute__((packed)) TelemetryBatchHeader
+{
+  uint8_t magic;
+  uint8_t version;
+  uint16_t seq;
+  uint8_t count;
+  uint8_t recordSize;
+};
+
+struct __attribute__((packed)) TelemetryRecord
+{
+  uint32_t ms;
+  uint16_t pwm;
+  uint16_t pattern;
+  uint16_t master;
+  uint16_t ambient;
+  uint16_t output;
+  uint16_t music;
+  int16_t touchDelta;
+  uint16_t lightRaw;
+};
+
+static_assert(sizeof(TelemetryBatchHeader) == 6, "telemetry header layout");
+static_assert(sizeof(TelemetryRecord) == 20, "telemetry record layout");
+
+extern bool telemetryBle;      // stream on the BLE telemetry characteristic
+extern bool telemetryUsb;      // stream as TLM| lines on USB serial
+extern uint16_t telemetryHz;   // sample rate (10..Settings::TELEMETRY_HZ_MAX)
+
+/**
+ * @brief Sample and flush telemetry batches when due. Call once per loop.
+ */
+void updateTelemetry();
+
+/**
+ * @brief Set the sample rate and restart the batch.
+ * @return False (with a usage message) if @p hz is outside 10..Settings::TELEMETRY_HZ_MAX.
+ */
+bool setTelemetryRate(uint16_t hz);
+
+/**
+ * @brief Switch the BLE sink; refuses (with feedback) while the MTU cannot carry one record.
+ * @return False if BLE telemetry was requested but refused.
+ */
+bool setTelemetryBle(bool enabled);
+
+/**
+ * @brief Report telemetry configuration and counters.
+ */
+void telemetryStatusFeedback();
+
+#endif
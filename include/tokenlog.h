@@ -0,0 +1,191 @@
+#pragma once
+
+/**
+ * @file tokenlog.h
+ * @brief Tokenized feedback lines: 16-bit format IDs plus binary arguments.
+ *
+ * TLOG("[Poti] alpha=%.2f", v) hashes the format string at compile time.
+ * Clients that sent `tok on` receive `~<base64>` lines instead of text:
+ *   u16 token (LE) | args...
+ *   %d/%i: zigzag varint, %u/%x/%X/%c: varint, %f: float32 LE, %s: u8 len + bytes
+ * The argument's C++ type (after integer promotion) selects the encoding, so
+ * specifiers must match: signed -> %d/%i, unsigned -> %u/%x/%X, either -> %c,
+ * float -> %f/%e/%g, String/char* -> %s. TLOG() checks this at compile time
+ * (uint8_t/uint16_t/bool promote to int and take %d).
+ * tools/tokens.py scans TLOG() calls into the token database that the
+ * frontend and the HA integration use to expand the lines again.
+ * With the default TOKEN_LOG_TEXT=1 the format strings stay in flash for
+ * plain-text clients: tokens save radio/serial bytes, not flash. Only
+ * -DTOKEN_LOG_TEXT=0 drops the strings from the image, and then every client
+ * gets tokens.
+ */
+
+#include <Arduino.h>
+#include <type_traits>
+
+#include "comms.h"
+#include "settings.h"
+
+/**
+ * @brief FNV-1a over a NUL-terminated string (compile-time usable).
+ */
+constexpr uint32_t tokenFnv1a(const char *s, uint32_t h = 2166136261u)
+{
+  return *s ? tokenFnv1a(s + 1, (h ^ static_cast<uint8_t>(*s)) * 16777619u) : h;
+}
+
+/**
+ * @brief 16-bit token of a format string (FNV-1a folded); mirrored in tools/tokens.py.
+ */
+constexpr uint16_t tokenHash(const char *s)
+{
+  return static_cast<uint16_t>((tokenFnv1a(s) >> 16) ^ (tokenFnv1a(s) & 0xFFFFu));
+}
+
+struct TokenArgs
+{
+  uint8_t buf[Settings::TOKEN_ARGS_MAX];
+  uint8_t len = 0;
+};
+
+void tokenEncode(TokenArgs &a, int v);
+void tokenEncode(TokenArgs &a, long v);
+void tokenEncode(TokenArgs &a, unsigned int v);
+void tokenEncode(TokenArgs &a, unsigned long v);
+void tokenEncode(TokenArgs &a, double v);
+void tokenEncode(TokenArgs &a, const char *v);
+void tokenEncode(TokenArgs &a, const String &v);
+void tokenEncode(TokenArgs &a, const __FlashStringHelper *v);
+
+/** @brief Encoding class of a TLOG() argument or specifier. */
+enum TokenArgKind : uint8_t
+{
+  TOKEN_ARG_SIGNED,
+  TOKEN_ARG_UNSIGNED,
+  TOKEN_ARG_FLOAT,
+  TOKEN_ARG_STRING,
+  TOKEN_ARG_CHAR, // %c: either integer class
+  TOKEN_ARG_NONE, // no further specifier
+  TOKEN_ARG_BAD,
+};
+
+template <typename T, bool Integral = std::is_integral<T>::value || std::is_enum<T>::value>
+struct TokenArgKindOf
+{
+  static constexpr uint8_t value = std::is_floating_point<T>::value ? TOKEN_ARG_FLOAT : TOKEN_ARG_BAD;
+};
+template <typename T>
+struct TokenArgKindOf<T, true>
+{
+  // Kind of the promoted type: that is the tokenEncode() overload that runs.
+  static constexpr uint8_t value = std::is_signed<decltype(+T())>::value ? TOKEN_ARG_SIGNED : TOKEN_ARG_UNSIGNED;
+};
+template <> struct TokenArgKindOf<const char *, false> { static constexpr uint8_t value = TOKEN_ARG_STRING; };
+template <> struct TokenArgKindOf<char *, false> { static constexpr uint8_t value = TOKEN_ARG_STRING; };
+template <> struct TokenArgKindOf<String, false> { static constexpr uint8_t value = TOKEN_ARG_STRING; };
+template <> struct TokenArgKindOf<const __FlashStringHelper *, false> { static constexpr uint8_t value = TOKEN_ARG_STRING; };
+
+constexpr bool tokenIsSpecModifier(char c)
+{
+  return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || (c >= '0' && c <= '9') || c == 'h' ||
+         c == 'l' || c == 'L' || c == 'z' || c == 'j' || c == 't';
+}
+
+constexpr const char *tokenSkipModifiers(const char *s)
+{
+  return (*s && tokenIsSpecModifier(*s)) ? tokenSkipModifiers(s + 1) : s;
+}
+
+/**
+ * @brief Conversion character of the next specifier in @p s (skips "%%"), or the terminating NUL.
+ */
+constexpr const char *tokenNextSpec(const char *s)
+{
+  return !*s ? s : *s != '%' ? tokenNextSpec(s + 1) : s[1] == '%' ? tokenNextSpec(s + 2) : tokenSkipModifiers(s + 1);
+}
+
+constexpr uint8_t tokenSpecKind(char c)
+{
+  return !c                                     ? TOKEN_ARG_NONE
+         : (c == 'd' || c == 'i')               ? TOKEN_ARG_SIGNED
+         : (c == 'u' || c == 'x' || c == 'X')   ? TOKEN_ARG_UNSIGNED
+         : c == 'c'                             ? TOKEN_ARG_CHAR
+         : (c == 'f' || c == 'e' || c == 'g')   ? TOKEN_ARG_FLOAT
+         : c == 's'                             ? TOKEN_ARG_STRING
+                                                : TOKEN_ARG_BAD;
+}
+
+constexpr bool tokenKindFits(uint8_t spec, uint8_t arg)
+{
+  return spec == arg || (spec == TOKEN_ARG_CHAR && (arg == TOKEN_ARG_SIGNED || arg == TOKEN_ARG_UNSIGNED));
+}
+
+/**
+ * @brief True if the specifiers of @p fmt match the argument kinds one to one.
+ */
+constexpr bool tokenArgsMatch(const char *fmt)
+{
+  return tokenSpecKind(*tokenNextSpec(fmt)) == TOKEN_ARG_NONE;
+}
+template <typename... Rest>
+constexpr bool tokenArgsMatch(const char *fmt, uint8_t kind, Rest... rest)
+{
+  return tokenKindFits(tokenSpecKind(*tokenNextSpec(fmt)), kind) && tokenArgsMatch(tokenNextSpec(fmt) + 1, rest...);
+}
+
+template <uint8_t... Kinds>
+struct TokenArgKinds
+{
+  static constexpr bool match(const char *fmt) { return tokenArgsMatch(fmt, Kinds...); }
+};
+
+/** @brief Argument kinds of a TLOG() call (unevaluated, decltype only). */
+template <typename... T>
+TokenArgKinds<TokenArgKindOf<typename std::decay<T>::type>::value...> tokenArgKinds(const T &...);
+
+inline void tokenEncodeArgs(TokenArgs &) {}
+template <typename T, typename... Rest>
+inline void tokenEncodeArgs(TokenArgs &a, const T &v, const Rest &...rest)
+{
+  tokenEncode(a, v);
+  tokenEncodeArgs(a, rest...);
+}
+
+/**
+ * @brief Send one tokenized line to @p route; text clients get it formatted from @p fmt.
+ */
+void tokenLogEmit(uint8_t route, uint16_t token, const char *fmt, const TokenArgs &args);
+
+/**
+ * @brief Expand @p fmt with encoded arguments (device-side twin of the host decoders).
+ */
+void tokenFormat(String &out, const char *fmt, const uint8_t *args, size_t len);
+
+/**
+ * @brief Report token/text line counters (`tok` command).
+ */
+void tokenStatsFeedback();
+
+#if TOKEN_LOG_TEXT
+#define TOKEN_FMT(fmt) (fmt)
+#else
+#define TOKEN_FMT(fmt) nullptr
+#endif
+
+/**
+ * @brief Log-topic feedback line with a compile-time token; args are only encoded if someone listens.
+ */
+#define TLOG(fmt, ...)                                                                     \
+  do                                                                                       \
+  {                                                                                        \
+    static_assert(decltype(tokenArgKinds(__VA_ARGS__))::match(fmt),                        \
+                  "TLOG: format specifiers do not match the argument types");            \
+    const uint8_t tokenRoute_ = feedbackRoute(FeedbackTopic::Log);                         \
+    if (tokenRoute_)                                                                       \
+    {                                                                                      \
+      TokenArgs tokenArgs_;                                                                \
+      tokenEncodeArgs(tokenArgs_, ##__VA_ARGS__);                                          \
+      tokenLogEmit(tokenRoute_, std::integral_constant<uint16_t, tokenHash(fmt)>::value,   \
+                   TOKEN_FMT(fmt), tokenArgs_);                                            \
+    }                                                                                      \
+  } while (0)
@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * @file touch_gesture.h
+ * @brief Touch gesture recognizer: tap, double, triple, hold and hold release.
+ *
+ * Fed with the touch delta (baseline - count) of every sample plus the
+ * threshold interrupt flag. Press and release use the on/off hysteresis (an
+ * interrupt press counts only once the filtered delta follows); a
+ * press reaching holdMs becomes a hold, shorter presses count as taps. A tap
+ * sequence is reported as soon as it cannot grow any more: right on the
+ * release that reaches maxTaps (the highest tap count with a binding), else
+ * once no new press followed within tapGapMs. With only single taps bound a
+ * tap therefore fires on release instead of after a double-tap window.
+ * Pure computation, no hardware access (host test: tools/touch_replay.py).
+ */
+
+#include <Arduino.h>
+
+enum TouchGestureEvent : uint8_t
+{
+  TG_PRESS = 1u << 0,    ///< finger down
+  TG_RELEASE = 1u << 1,  ///< finger up
+  TG_TAPS = 1u << 2,     ///< tap sequence finished, count in TouchGesture::taps
+  TG_HOLD = 1u << 3,     ///< press reached holdMs
+  TG_HOLD_END = 1u << 4, ///< finger up after a hold
+};
+
+struct TouchGestureConfig
+{
+  int onDelta;        // press when |delta| exceeds this
+  int offDelta;       // release when |delta| drops below this
+  uint32_t holdMs;    // press length that makes a hold
+  uint32_t tapGapMs;  // max. release-to-press gap inside a multi-tap
+  uint8_t maxTaps;    // 1..3: the sequence is reported at this count without waiting
+};
+
+struct TouchGesture
+{
+  bool pressed;
+  bool holding;
+  bool confirmed;      // filtered delta reached offDelta since the press
+  bool ignore;         // press consumed elsewhere: no taps/hold until released
+  uint8_t pending;     // taps so far in the running sequence
+  uint8_t taps;        // count of the sequence reported with TG_TAPS
+  uint32_t pressMs;
+  uint32_t releaseMs;
+};
+
+/** @brief Clear all state (released, no pending taps). */
+void touchGestureReset(TouchGesture &g);
+
+/**
+ * @brief Feed one sample.
+ * @param delta Baseline minus filtered count (sign ignored).
+ * @param irq Threshold interrupt fired since the last sample: counts as a press.
+ * @return TouchGestureEvent bits raised by this sample.
+ */
+uint8_t touchGestureFeed(TouchGesture &g, const TouchGestureConfig &cfg, int delta, bool irq, uint32_t nowMs);
+
+/** @brief Consume the current press: it produces neither taps nor a hold. */
+void touchGestureIgnorePress(TouchGesture &g);
@@ -0,0 +1,44 @@
+#pragma once
+
+/**
+ * @file touch_sensor.h
+ * @brief Touch electrode on the hardware FSM: IIR filter, threshold interrupt, background baseline, calibration.
+ *
+ * The touch peripheral measures the pad on its own timer; the IDF IIR filter
+ * smooths the counts every Settings::TOUCH_FILTER_MS in the esp_timer task.
+ * Its callback tracks the untouched baseline and keeps the pad's interrupt
+ * threshold at baseline - touchDeltaOn, so a touch wakes the loop instead of
+ * waiting for the next sample. Calibration runs as a state machine driven
+ * by touchCalibUpdate(); samples are summed in the same callback, so nothing
+ * blocks the loop, rendering or BLE.
+ */
+
+#include <Arduino.h>
+
+// No lamp_config.h here: print.cpp relies on the build flags alone; ENABLE_TOUCH_DIM comes from the includer.
+#if ENABLE_TOUCH_DIM
+
+/** @brief Start filter, baseline tracking and threshold interrupt (idempotent). */
+void touchSensorBegin();
+
+/** @brief Latest filtered count of the pad; no conversion, safe to call any time. */
+int touchSensorValue();
+
+/** @brief True once after the threshold interrupt fired (pad below baseline - touchDeltaOn). */
+bool touchSensorTakeIrq();
+
+/**
+ * @brief Start a calibration; replaces a running one.
+ * @param guided False: baseline only (Settings::TOUCH_CALIB_BASE_MS untouched).
+ *               True: untouched, then touched for Settings::TOUCH_CALIB_PHASE_MS each,
+ *               derive and save touchDeltaOn/Off; prompts and progress via feedback.
+ */
+void touchCalibStart(bool guided);
+
+/**
+ * @brief Advance the calibration; call every loop pass.
+ * @return True while a calibration runs (touch gestures are paused).
+ */
+bool touchCalibUpdate();
+
+#endif
@@ -9,3 +9,6 @@ float clamp01(float x);
 bool parseBool(const String &s, bool &out);
 uint8_t easeFromString(const String &s);
 String easeToString(uint8_t t);
+void base64Append(String &out, const uint8_t *data, size_t len);
+int base64Decode(const String &in, uint8_t *out, size_t maxLen);
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len);
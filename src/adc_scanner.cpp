@@ -0,0 +1,236 @@
+/**
+ * @file adc_scanner.cpp
+ * @brief Round-robin one-shot conversions of the slow analog inputs in a background task.
+ */
+
+#include "lamp_config.h"
+
+#include "adc_scanner.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "settings.h"
+#include "pinout.h"
+#include "audio_capture.h"
+#include "tokenlog.h"
+
+#if ENABLE_LIGHT_SENSOR || ENABLE_POTI || ENABLE_EXT_INPUT
+
+namespace
+{
+  constexpr uint8_t NO_PIN = 0xFF;
+  constexpr uint8_t MAX_BURST = 15;
+
+  struct ChannelConfig
+  {
+    uint8_t pin;
+    uint8_t samples; // conversions per pass
+    bool median;     // median of the burst instead of the mean (rejects single spikes)
+    float alpha;     // IIR weight of a new pass, 1 = off
+  };
+
+  // The consumers keep their own (configurable) low-pass; this only smooths
+  // between their samples. The poti stays unsmoothed so the knob feels direct.
+  const ChannelConfig CHANNELS[ADC_CH_COUNT] = {
+#if ENABLE_LIGHT_SENSOR
+      {(uint8_t)Settings::LIGHT_PIN, Settings::ADC_SCAN_OVERSAMPLE, false, 0.25f},
+#else
+      {NO_PIN, 0, false, 1.0f},
+#endif
+#if ENABLE_POTI
+      {(uint8_t)PIN_POTI, Settings::POTI_MEDIAN_SAMPLES, true, 1.0f},
+#else
+      {NO_PIN, 0, false, 1.0f},
+#endif
+#if ENABLE_EXT_INPUT
+      {(uint8_t)Settings::EXT_INPUT_PIN, Settings::ADC_SCAN_OVERSAMPLE, false, 0.5f},
+#else
+      {NO_PIN, 0, false, 1.0f},
+#endif
+  };
+
+#if ENABLE_POTI
+  static_assert(Settings::POTI_MEDIAN_SAMPLES > 0 && (Settings::POTI_MEDIAN_SAMPLES % 2) == 1,
+                "POTI_MEDIAN_SAMPLES must be a positive odd number");
+  static_assert(Settings::POTI_MEDIAN_SAMPLES <= MAX_BURST, "POTI_MEDIAN_SAMPLES too large");
+#endif
+  static_assert(Settings::ADC_SCAN_OVERSAMPLE > 0 && Settings::ADC_SCAN_OVERSAMPLE <= MAX_BURST,
+                "ADC_SCAN_OVERSAMPLE must be 1..15");
+
+  /** @brief One burst on ADC1; the caller holds audioAdcBegin(). */
+  int convert(const ChannelConfig &c)
+  {
+    int samples[MAX_BURST];
+    int32_t sum = 0;
+    for (uint8_t i = 0; i < c.samples; ++i)
+    {
+      samples[i] = analogRead(c.pin);
+      sum += samples[i];
+      if (!c.median)
+        continue;
+      for (uint8_t j = i; j > 0 && samples[j] < samples[j - 1]; --j)
+      {
+        int tmp = samples[j];
+        samples[j] = samples[j - 1];
+        samples[j - 1] = tmp;
+      }
+    }
+    return c.median ? samples[c.samples / 2] : (int)((sum + c.samples / 2) / c.samples);
+  }
+
+#if ENABLE_ADC_SCANNER
+  // (seq << 16) | value; seq 0 = no value. Aligned 32-bit stores are atomic on the ESP32.
+  volatile uint32_t published[ADC_CH_COUNT] = {};
+  volatile uint32_t wantedMs[ADC_CH_COUNT] = {}; // millis() of the last read, 0 = never
+  TaskHandle_t scanTask = nullptr;
+  bool startFailed = false;
+
+  // Statistics for `adc`, written by the task only.
+  volatile uint32_t statPasses = 0;
+  volatile uint32_t statBusySumUs = 0;
+  volatile uint32_t statBusyMaxUs = 0;
+  uint32_t statStartMs = 0;
+
+  bool channelWanted(uint8_t ch, uint32_t now)
+  {
+    const uint32_t wanted = wantedMs[ch];
+    return CHANNELS[ch].pin != NO_PIN && wanted && now - wanted < Settings::ADC_SCAN_IDLE_MS;
+  }
+
+  void scanTaskFn(void *)
+  {
+    float filtered[ADC_CH_COUNT] = {};
+    uint16_t seq[ADC_CH_COUNT] = {};
+    TickType_t wake = xTaskGetTickCount();
+    for (;;)
+    {
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+      // Every pass pauses the I2S-ADC; scan less often while it records.
+      const uint32_t periodMs = audioCaptureRunning() ? Settings::ADC_SCAN_AUDIO_MS : Settings::ADC_SCAN_MS;
+#else
+      const uint32_t periodMs = Settings::ADC_SCAN_MS;
+#endif
+      vTaskDelayUntil(&wake, pdMS_TO_TICKS(periodMs));
+      const uint32_t now = millis();
+      bool active[ADC_CH_COUNT];
+      bool any = false;
+      for (uint8_t ch = 0; ch < ADC_CH_COUNT; ++ch)
+      {
+        active[ch] = channelWanted(ch, now);
+        any = any || active[ch];
+        if (!active[ch] && seq[ch])
+        {
+          // Idle: forget the value so a later reader does not get a stale one.
+          seq[ch] = 0;
+          published[ch] = 0;
+        }
+      }
+      if (!any)
+        continue;
+
+      int raw[ADC_CH_COUNT];
+      const uint32_t t0 = micros();
+      audioAdcBegin();
+      for (uint8_t ch = 0; ch < ADC_CH_COUNT; ++ch)
+        if (active[ch])
+          raw[ch] = convert(CHANNELS[ch]);
+      audioAdcEnd();
+      const uint32_t busyUs = micros() - t0;
+
+      for (uint8_t ch = 0; ch < ADC_CH_COUNT; ++ch)
+      {
+        if (!active[ch])
+          continue;
+        filtered[ch] = seq[ch] ? filtered[ch] + CHANNELS[ch].alpha * ((float)raw[ch] - filtered[ch]) : (float)raw[ch];
+        if (++seq[ch] == 0)
+          seq[ch] = 1;
+        published[ch] = ((uint32_t)seq[ch] << 16) | (uint32_t)(filtered[ch] + 0.5f);
+      }
+      statPasses = statPasses + 1;
+      statBusySumUs = statBusySumUs + busyUs;
+      if (busyUs > statBusyMaxUs)
+        statBusyMaxUs = busyUs;
+    }
+  }
+
+  bool scannerStart()
+  {
+    if (scanTask)
+      return true;
+    if (startFailed)
+      return false;
+    statStartMs = millis();
+    // Below the audio capture (priority 2) on the same core; a pass is well under a millisecond.
+    if (xTaskCreatePinnedToCore(scanTaskFn, "adc_scan", Settings::ADC_SCAN_TASK_STACK, nullptr, 1, &scanTask, 0) !=
+        pdPASS)
+    {
+      scanTask = nullptr;
+      startFailed = true;
+      TLOG("[ADC] Scanner task failed, reading in the loop");
+      return false;
+    }
+    return true;
+  }
+#endif
+} // namespace
+
+bool adcScannerRead(AdcChannel ch, int &raw)
+{
+  if (ch >= ADC_CH_COUNT || CHANNELS[ch].pin == NO_PIN)
+    return false;
+#if ENABLE_ADC_SCANNER
+  wantedMs[ch] = millis() | 1;
+  if (scannerStart())
+  {
+    const uint32_t word = published[ch];
+    if (!(word >> 16))
+      return false;
+    raw = (int)(word & 0xFFFF);
+    return true;
+  }
+#endif
+  audioAdcBegin();
+  raw = convert(CHANNELS[ch]);
+  audioAdcEnd();
+  return true;
+}
+
+void adcScannerFeedback()
+{
+  static const char *const NAMES[ADC_CH_COUNT] = {"light", "poti", "ext"};
+#if ENABLE_ADC_SCANNER
+  if (!scanTask)
+  {
+    TLOG("[ADC] Scanner %s", startFailed ? "failed, reading in the loop" : "idle (no analog input read yet)");
+    return;
+  }
+  const uint32_t passes = statPasses;
+  const uint32_t elapsedMs = millis() - statStartMs;
+  TLOG("[ADC] %lu passes (%.1f Hz), busy %lu us avg, %lu us max per pass", (unsigned long)passes,
+       elapsedMs ? (float)passes * 1000.0f / (float)elapsedMs : 0.0f,
+       (unsigned long)(passes ? statBusySumUs / passes : 0), (unsigned long)statBusyMaxUs);
+  const uint32_t now = millis();
+  for (uint8_t ch = 0; ch < ADC_CH_COUNT; ++ch)
+  {
+    if (CHANNELS[ch].pin == NO_PIN)
+      continue;
+    const uint32_t word = published[ch];
+    if (!channelWanted(ch, now) || !(word >> 16))
+      TLOG("[ADC] %s GPIO%u idle", NAMES[ch], (unsigned)CHANNELS[ch].pin);
+    else
+      TLOG("[ADC] %s GPIO%u raw=%u (%u x %s)", NAMES[ch], (unsigned)CHANNELS[ch].pin, (unsigned)(word & 0xFFFF),
+           (unsigned)CHANNELS[ch].samples, CHANNELS[ch].median ? "median" : "mean");
+  }
+#else
+  for (uint8_t ch = 0; ch < ADC_CH_COUNT; ++ch)
+    if (CHANNELS[ch].pin != NO_PIN)
+      TLOG("[ADC] %s GPIO%u read in the loop (%u x %s)", NAMES[ch], (unsigned)CHANNELS[ch].pin,
+           (unsigned)CHANNELS[ch].samples, CHANNELS[ch].median ? "median" : "mean");
+#endif
+}
+
+#else
+bool adcScannerRead(AdcChannel, int &) { return false; }
+void adcScannerFeedback() { TLOG("[ADC] No analog inputs configured"); }
+#endif
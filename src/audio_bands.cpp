@@ -0,0 +1,138 @@
+/**
+ * @file audio_bands.cpp
+ * @brief Q15 radix-2 FFT over capture blocks, band summing and per-band AGC.
+ */
+
+#include "lamp_config.h"
+#include "audio_bands.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+#include <math.h>
+
+#include "settings.h"
+
+namespace
+{
+  constexpr uint16_t N = Settings::AUDIO_BLOCK_SAMPLES;
+  static_assert(N >= 16 && (N & (N - 1)) == 0, "AUDIO_BLOCK_SAMPLES must be a power of two");
+
+  // First bin above each band edge; bin k covers k * rate / N Hz.
+  constexpr uint16_t BASS_END = (uint16_t)(1 + (uint32_t)Settings::AUDIO_BASS_MAX_HZ * N / Settings::AUDIO_SAMPLE_RATE);
+  constexpr uint16_t MID_END = (uint16_t)(1 + (uint32_t)Settings::AUDIO_MID_MAX_HZ * N / Settings::AUDIO_SAMPLE_RATE);
+  static_assert(BASS_END > 1 && MID_END > BASS_END && MID_END < N / 2, "band edges outside the FFT range");
+
+  int16_t twCos[N / 2];
+  int16_t twSin[N / 2];
+  int16_t window[N]; // Hann, Q15
+  uint16_t bitRev[N];
+  int32_t re[N];
+  int32_t im[N];
+  float prevMag[N / 2]; // bass/mid bin magnitudes of the previous block (flux)
+  bool prevValid = false; // prevMag belongs to the current capture run
+  bool tablesReady = false;
+} // namespace
+
+void audioBandsInit()
+{
+  if (tablesReady)
+    return;
+  for (uint16_t k = 0; k < N / 2; ++k)
+  {
+    const float a = 2.0f * (float)M_PI * (float)k / (float)N;
+    twCos[k] = (int16_t)lroundf(32767.0f * cosf(a));
+    twSin[k] = (int16_t)lroundf(32767.0f * sinf(a));
+  }
+  for (uint16_t i = 0; i < N; ++i)
+  {
+    window[i] = (int16_t)lroundf(32767.0f * 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)i / (float)(N - 1))));
+    uint16_t r = 0;
+    for (uint16_t b = 1, v = i; b < N; b <<= 1, v >>= 1)
+      r = (uint16_t)((r << 1) | (v & 1));
+    bitRev[i] = r;
+  }
+  tablesReady = true;
+}
+
+void audioBandsReset()
+{
+  prevValid = false;
+}
+
+void audioBandsAnalyze(const uint16_t *samples, int32_t bias, float amp[AUDIO_BAND_COUNT], float &flux, float &centroidHz)
+{
+  // 12-bit input << 3 leaves headroom for the Q15 products; every stage halves, so X = DFT / N.
+  for (uint16_t i = 0; i < N; ++i)
+  {
+    const int32_t x = ((int32_t)(samples[i] & 0x0FFF) - bias) * 8;
+    re[bitRev[i]] = (x * window[i]) >> 15;
+    im[bitRev[i]] = 0;
+  }
+  for (uint16_t len = 2, step = N / 2; len <= N; len <<= 1, step >>= 1)
+  {
+    const uint16_t half = len >> 1;
+    for (uint16_t i = 0; i < N; i += len)
+    {
+      for (uint16_t j = 0; j < half; ++j)
+      {
+        const int32_t wr = twCos[j * step];
+        const int32_t wi = -twSin[j * step];
+        const uint16_t a = i + j;
+        const uint16_t b = a + half;
+        const int32_t tr = (re[b] * wr - im[b] * wi) >> 15;
+        const int32_t ti = (re[b] * wi + im[b] * wr) >> 15;
+        re[b] = (re[a] - tr) >> 1;
+        im[b] = (im[a] - ti) >> 1;
+        re[a] = (re[a] + tr) >> 1;
+        im[a] = (im[a] + ti) >> 1;
+      }
+    }
+  }
+  float e[AUDIO_BAND_COUNT] = {0.0f, 0.0f, 0.0f};
+  float rise = 0.0f;
+  float moment = 0.0f;
+  for (uint16_t k = 1; k < N / 2; ++k)
+  {
+    const float p = (float)re[k] * (float)re[k] + (float)im[k] * (float)im[k];
+    moment += (float)k * p;
+    if (k < MID_END)
+    {
+      // Half-wave rectified flux: only energy that appears counts (drums, not decays).
+      const float mag = sqrtf(p);
+      if (mag > prevMag[k])
+        rise += mag - prevMag[k];
+      prevMag[k] = mag;
+    }
+    e[k < BASS_END ? AUDIO_BAND_BASS : (k < MID_END ? AUDIO_BAND_MID : AUDIO_BAND_TREBLE)] += p;
+  }
+  // The first block of a run has nothing to rise from: its whole spectrum would read as an onset.
+  flux = prevValid ? rise / (2.0f * 4095.0f) : 0.0f;
+  prevValid = true;
+  const float total = e[AUDIO_BAND_BASS] + e[AUDIO_BAND_MID] + e[AUDIO_BAND_TREBLE];
+  centroidHz = total > 0.0f ? moment / total * (float)Settings::AUDIO_SAMPLE_RATE / (float)N : 0.0f;
+  // A Hann-windowed tone of amplitude A lands at |X| ~ 2A (input scaled by 8, window gain 1/2, one side 1/2).
+  for (uint8_t b = 0; b < AUDIO_BAND_COUNT; ++b)
+    amp[b] = sqrtf(e[b]) / (2.0f * 4095.0f);
+}
+
+void audioBandsAgc(AudioBandAgc &agc, const float amp[AUDIO_BAND_COUNT], float blockMs, float out[AUDIO_BAND_COUNT])
+{
+  const float decay = expf(-blockMs / (float)Settings::AUDIO_AGC_DECAY_MS);
+  const float release = 1.0f - powf(1.0f - Settings::MUSIC_ALPHA, blockMs / (float)Settings::MUSIC_SAMPLE_MS);
+  for (uint8_t b = 0; b < AUDIO_BAND_COUNT; ++b)
+  {
+    float peak = agc.peak[b] * decay;
+    if (amp[b] > peak)
+      peak = amp[b];
+    // The floor keeps silence dark instead of amplifying noise to full scale.
+    if (peak < Settings::AUDIO_AGC_FLOOR)
+      peak = Settings::AUDIO_AGC_FLOOR;
+    agc.peak[b] = peak;
+    const float target = amp[b] / peak;
+    float &lvl = agc.level[b];
+    lvl += (target > lvl ? Settings::AUDIO_ENV_ATTACK : release) * (target - lvl);
+    out[b] = lvl;
+  }
+}
+
+#endif
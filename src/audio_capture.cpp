@@ -0,0 +1,371 @@
+/**
+ * @file audio_capture.cpp
+ * @brief I2S-ADC DMA capture task for the music pin and its block statistics.
+ */
+
+#include "audio_capture.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+#include <driver/i2s.h>
+#include <driver/adc.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <math.h>
+
+#include "settings.h"
+#include "beat_tracker.h"
+#include "clap_detector.h"
+#include "tokenlog.h"
+
+namespace
+{
+  constexpr i2s_port_t AUDIO_I2S = I2S_NUM_0;
+  constexpr uint32_t BLOCK_US = (uint32_t)(1000000ULL * Settings::AUDIO_BLOCK_SAMPLES / Settings::AUDIO_SAMPLE_RATE);
+
+  TaskHandle_t volatile captureTask = nullptr;
+  volatile bool stopRequested = false;
+  bool startFailed = false;
+  adc1_channel_t channel = ADC1_CHANNEL_0;
+  uint16_t blockBuf[Settings::AUDIO_BLOCK_SAMPLES];
+  BeatTracker beat; // capture task only
+  ClapDetector clap; // capture task only
+
+  // Written by the capture task, read by the loop; all under levelMux.
+  portMUX_TYPE levelMux = portMUX_INITIALIZER_UNLOCKED;
+  AudioLevels shared = {};
+  uint32_t sharedReadyUs = 0; // micros() when the latest envelope was published
+  uint32_t statStartUs = 0;
+  uint32_t statBlocks = 0;
+  uint32_t statProcSumUs = 0;
+  uint32_t statProcMaxUs = 0;
+  uint32_t statBacklog = 0; // i2s_read returned without waiting: DMA had queued blocks
+  uint64_t statFftCycles = 0;
+  uint32_t statFftMaxCycles = 0;
+
+  // Loop side
+  uint32_t statPauses = 0;
+  uint32_t latSumUs = 0;
+  uint32_t latMaxUs = 0;
+  uint32_t latCount = 0;
+
+  // Serializes I2S install/uninstall and one-shot pauses between the loop and the ADC scanner task.
+  SemaphoreHandle_t adcMutex()
+  {
+    static StaticSemaphore_t buf;
+    static SemaphoreHandle_t mutex = xSemaphoreCreateMutexStatic(&buf);
+    return mutex;
+  }
+
+  bool adcChannelForPin(uint8_t pin, adc1_channel_t &out)
+  {
+    switch (pin)
+    {
+    case 36: out = ADC1_CHANNEL_0; return true;
+    case 37: out = ADC1_CHANNEL_1; return true;
+    case 38: out = ADC1_CHANNEL_2; return true;
+    case 39: out = ADC1_CHANNEL_3; return true;
+    case 32: out = ADC1_CHANNEL_4; return true;
+    case 33: out = ADC1_CHANNEL_5; return true;
+    case 34: out = ADC1_CHANNEL_6; return true;
+    case 35: out = ADC1_CHANNEL_7; return true;
+    default: return false;
+    }
+  }
+
+  void captureTaskFn(void *)
+  {
+    const float blockMs = (float)BLOCK_US / 1000.0f;
+    // Same time constants as the 40 Hz analogRead() path, rescaled to the block period.
+    const float blocksPerSample = blockMs / (float)Settings::MUSIC_SAMPLE_MS;
+    const float dcAlpha = 1.0f - powf(1.0f - 0.01f, blocksPerSample);
+    const float release = 1.0f - powf(1.0f - Settings::MUSIC_ALPHA, blocksPerSample);
+    float dc = -1.0f;
+    float env = 0.0f;
+    AudioBandAgc agc = {};
+    float amp[AUDIO_BAND_COUNT];
+    float bands[AUDIO_BAND_COUNT];
+    float flux = 0.0f;
+    float centroidHz = 0.0f;
+    audioBandsReset();
+    beatTrackerReset(beat);
+    clapDetectorReset(clap);
+    uint32_t lastReadUs = micros();
+    while (!stopRequested)
+    {
+      size_t got = 0;
+      if (i2s_read(AUDIO_I2S, blockBuf, sizeof(blockBuf), &got, pdMS_TO_TICKS(100)) != ESP_OK || got < sizeof(blockBuf))
+        continue;
+      const uint32_t readUs = micros();
+      const uint16_t n = Settings::AUDIO_BLOCK_SAMPLES;
+
+      // ADC words carry the channel in the top nibble.
+      uint32_t sum = 0;
+      for (uint16_t i = 0; i < n; ++i)
+        sum += blockBuf[i] & 0x0FFF;
+      const float mean = (float)sum / (float)n;
+      dc = dc < 0.0f ? mean : dc + dcAlpha * (mean - dc);
+      const int32_t bias = (int32_t)(dc + 0.5f);
+      uint32_t sumAbs = 0;
+      uint64_t sumSq = 0;
+      uint32_t peak = 0;
+      for (uint16_t i = 0; i < n; ++i)
+      {
+        int32_t d = (int32_t)(blockBuf[i] & 0x0FFF) - bias;
+        const uint32_t a = (uint32_t)(d < 0 ? -d : d);
+        sumAbs += a;
+        sumSq += (uint64_t)(a * a);
+        if (a > peak)
+          peak = a;
+      }
+      const float meanAbs = (float)sumAbs / ((float)n * 4095.0f);
+      env += (meanAbs > env ? Settings::AUDIO_ENV_ATTACK : release) * (meanAbs - env);
+      const float rms = sqrtf((float)sumSq / (float)n) / 4095.0f;
+      const float peakNorm = (float)peak / 4095.0f;
+      const uint32_t c0 = ESP.getCycleCount();
+      audioBandsAnalyze(blockBuf, bias, amp, flux, centroidHz);
+      audioBandsAgc(agc, amp, blockMs, bands);
+      const uint8_t beatFlags = beatTrackerFeed(beat, flux, blockMs);
+      const float bandPower = amp[AUDIO_BAND_BASS] * amp[AUDIO_BAND_BASS] + amp[AUDIO_BAND_MID] * amp[AUDIO_BAND_MID] +
+                              amp[AUDIO_BAND_TREBLE] * amp[AUDIO_BAND_TREBLE];
+      const float bassShare = bandPower > 0.0f ? amp[AUDIO_BAND_BASS] * amp[AUDIO_BAND_BASS] / bandPower : 0.0f;
+      const uint16_t clapCandidates = clap.candidates;
+      const bool isClap = clapDetectorFeed(clap, rms, peakNorm, centroidHz, bassShare, blockMs);
+      const uint32_t fftCycles = ESP.getCycleCount() - c0;
+      const uint32_t doneUs = micros();
+      const uint32_t procUs = doneUs - readUs;
+
+      portENTER_CRITICAL(&levelMux);
+      shared.blocks++;
+      shared.sampleUs = readUs - BLOCK_US;
+      shared.blockMs = blockMs;
+      shared.dc = dc / 4095.0f;
+      shared.rms = rms;
+      if (peakNorm > shared.peak)
+        shared.peak = peakNorm;
+      shared.env = env;
+      for (uint8_t b = 0; b < AUDIO_BAND_COUNT; ++b)
+        shared.bands[b] = bands[b];
+      if ((beatFlags & BEAT_ONSET) && shared.onsets < 255)
+        shared.onsets++;
+      shared.bpm = beat.periodFrames > 0.0f ? beat.bpm : 0.0f;
+      shared.beatConf = beat.confidence;
+      // Phase is at the block centre; step back to the beat it belongs to.
+      shared.beatPeriodUs = (uint32_t)(beat.periodFrames * (float)BLOCK_US);
+      shared.beatUs = readUs - BLOCK_US / 2 - (uint32_t)(beat.phase * (float)shared.beatPeriodUs);
+      if (clap.candidates != clapCandidates)
+      {
+        shared.clapCandidates = clap.candidates;
+        shared.clapLast = clap.last;
+        shared.clapLastWasClap = clap.lastWasClap;
+      }
+      if (isClap)
+      {
+        if (shared.claps < 255)
+          shared.claps++;
+        if (clap.last.peak > shared.clapPeak)
+          shared.clapPeak = clap.last.peak;
+      }
+      sharedReadyUs = doneUs;
+      statFftCycles += fftCycles;
+      if (fftCycles > statFftMaxCycles)
+        statFftMaxCycles = fftCycles;
+      statBlocks++;
+      statProcSumUs += procUs;
+      if (procUs > statProcMaxUs)
+        statProcMaxUs = procUs;
+      if (readUs - lastReadUs < BLOCK_US / 4)
+        statBacklog++;
+      portEXIT_CRITICAL(&levelMux);
+      lastReadUs = readUs;
+    }
+    captureTask = nullptr;
+    vTaskDelete(nullptr);
+  }
+} // namespace
+
+static bool captureStartLocked()
+{
+  if (!adcChannelForPin(Settings::MUSIC_PIN, channel))
+  {
+    startFailed = true;
+    TLOG("[Audio] Pin %d is not on ADC1, using analogRead", (int)Settings::MUSIC_PIN);
+    return false;
+  }
+  audioBandsInit();
+  i2s_config_t cfg = {};
+  cfg.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+  cfg.sample_rate = Settings::AUDIO_SAMPLE_RATE;
+  cfg.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  cfg.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  cfg.intr_alloc_flags = 0;
+  cfg.dma_buf_count = Settings::AUDIO_DMA_BUFFERS;
+  cfg.dma_buf_len = Settings::AUDIO_BLOCK_SAMPLES;
+  cfg.use_apll = false;
+  if (i2s_driver_install(AUDIO_I2S, &cfg, 0, nullptr) != ESP_OK)
+  {
+    startFailed = true;
+    TLOG("[Audio] I2S-ADC driver failed, using analogRead");
+    return false;
+  }
+  i2s_set_adc_mode(ADC_UNIT_1, channel);
+  adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);
+  i2s_adc_enable(AUDIO_I2S);
+
+  portENTER_CRITICAL(&levelMux);
+  shared = AudioLevels();
+  statStartUs = micros();
+  statBlocks = 0;
+  statProcSumUs = 0;
+  statProcMaxUs = 0;
+  statBacklog = 0;
+  statFftCycles = 0;
+  statFftMaxCycles = 0;
+  portEXIT_CRITICAL(&levelMux);
+  statPauses = 0;
+  latSumUs = 0;
+  latMaxUs = 0;
+  latCount = 0;
+  stopRequested = false;
+  TaskHandle_t handle = nullptr;
+  if (xTaskCreatePinnedToCore(captureTaskFn, "audio", Settings::AUDIO_TASK_STACK, nullptr, 2, &handle, 0) != pdPASS)
+  {
+    i2s_adc_disable(AUDIO_I2S);
+    i2s_driver_uninstall(AUDIO_I2S);
+    startFailed = true;
+    TLOG("[Audio] Capture task failed, using analogRead");
+    return false;
+  }
+  captureTask = handle;
+  TLOG("[Audio] I2S-ADC capture at %lu Hz, %d samples per block", (unsigned long)Settings::AUDIO_SAMPLE_RATE,
+       (int)Settings::AUDIO_BLOCK_SAMPLES);
+  return true;
+}
+
+bool audioCaptureStart()
+{
+  if (captureTask)
+    return true;
+  if (startFailed)
+    return false;
+  xSemaphoreTake(adcMutex(), portMAX_DELAY);
+  const bool ok = captureStartLocked();
+  xSemaphoreGive(adcMutex());
+  return ok;
+}
+
+void audioCaptureStop()
+{
+  if (!captureTask)
+    return;
+  xSemaphoreTake(adcMutex(), portMAX_DELAY);
+  TaskHandle_t task = captureTask;
+  stopRequested = true;
+  // The task leaves within one i2s_read() timeout and clears captureTask on its way out.
+  const uint32_t t0 = millis();
+  while (captureTask && millis() - t0 < 300)
+    delay(1);
+  if (captureTask)
+  {
+    // Still inside the driver: it must be gone before the driver is.
+    vTaskDelete(task);
+    captureTask = nullptr;
+    TLOG("[Audio] Capture task did not exit, deleted");
+  }
+  i2s_adc_disable(AUDIO_I2S);
+  i2s_driver_uninstall(AUDIO_I2S);
+  xSemaphoreGive(adcMutex());
+  TLOG("[Audio] Capture stopped");
+}
+
+bool audioCaptureRunning()
+{
+  return captureTask != nullptr;
+}
+
+bool audioCaptureRead(AudioLevels &out)
+{
+  portENTER_CRITICAL(&levelMux);
+  out = shared;
+  shared.blocks = 0;
+  shared.peak = 0.0f;
+  shared.onsets = 0;
+  shared.claps = 0;
+  shared.clapPeak = 0.0f;
+  const uint32_t readyUs = sharedReadyUs;
+  portEXIT_CRITICAL(&levelMux);
+  if (!out.blocks)
+    return false;
+  const uint32_t lat = micros() - readyUs;
+  latSumUs += lat;
+  if (lat > latMaxUs)
+    latMaxUs = lat;
+  latCount++;
+  return true;
+}
+
+void audioAdcBegin()
+{
+  xSemaphoreTake(adcMutex(), portMAX_DELAY);
+  if (!captureTask)
+    return;
+  // ADC1 serves one controller at a time; analogRead() also rewrites the SAR setup.
+  i2s_adc_disable(AUDIO_I2S);
+  statPauses++;
+}
+
+void audioAdcEnd()
+{
+  if (captureTask)
+  {
+    i2s_set_adc_mode(ADC_UNIT_1, channel);
+    i2s_adc_enable(AUDIO_I2S);
+  }
+  xSemaphoreGive(adcMutex());
+}
+
+int audioAnalogRead(uint8_t pin)
+{
+  audioAdcBegin();
+  const int raw = analogRead(pin);
+  audioAdcEnd();
+  return raw;
+}
+
+void audioCaptureFeedback()
+{
+  if (!captureTask)
+  {
+    TLOG("[Audio] Capture off (%s)", startFailed ? "failed, analogRead" : "no audio feature active");
+    return;
+  }
+  portENTER_CRITICAL(&levelMux);
+  const uint32_t blocks = statBlocks;
+  const uint32_t procSum = statProcSumUs;
+  const uint32_t procMax = statProcMaxUs;
+  const uint32_t backlog = statBacklog;
+  const uint64_t fftCycles = statFftCycles;
+  const uint32_t fftMax = statFftMaxCycles;
+  const uint32_t elapsedUs = micros() - statStartUs;
+  portEXIT_CRITICAL(&levelMux);
+  const float rate = elapsedUs ? (float)blocks * Settings::AUDIO_BLOCK_SAMPLES * 1e6f / (float)elapsedUs : 0.0f;
+  const uint32_t procAvg = blocks ? procSum / blocks : 0;
+  TLOG("[Audio] %.0f Hz measured (%lu set), %lu blocks, %lu backlog, %lu ADC pauses", rate,
+       (unsigned long)Settings::AUDIO_SAMPLE_RATE, (unsigned long)blocks, (unsigned long)backlog,
+       (unsigned long)statPauses);
+  TLOG("[Audio] CPU per %lu us block: %lu us avg, %lu us max (%.2f%%)", (unsigned long)BLOCK_US,
+       (unsigned long)procAvg, (unsigned long)procMax, 100.0f * (float)procAvg / (float)BLOCK_US);
+  // Share of one core at the current clock; the task runs on core 0 next to the BLE/BT stack.
+  const uint32_t fftAvg = blocks ? (uint32_t)(fftCycles / blocks) : 0;
+  TLOG("[Audio] FFT, bands, beat and clap: %lu cycles avg, %lu max per block (%.2f%% of core 0)", (unsigned long)fftAvg,
+       (unsigned long)fftMax, 100.0f * (float)fftAvg / ((float)BLOCK_US * (float)ESP.getCpuFreqMHz()));
+  // Newest sample -> envelope in the loop = DMA wake-up + block math + hand-off (measured);
+  // the oldest sample of a block is one block period older on top.
+  const uint32_t latAvg = latCount ? latSumUs / latCount : 0;
+  TLOG("[Audio] ADC to envelope: %lu us avg, %lu us max + block %lu us", (unsigned long)(procAvg + latAvg),
+       (unsigned long)(procMax + latMaxUs), (unsigned long)BLOCK_US);
+}
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file beat_tracker.cpp
+ * @brief Spectral-flux onsets, autocorrelation tempo estimate and beat phase loop.
+ */
+
+#include "beat_tracker.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  constexpr uint16_t H = Settings::BEAT_HISTORY_FRAMES;
+  static_assert((H & (H - 1)) == 0, "BEAT_HISTORY_FRAMES must be a power of two");
+
+  constexpr float ONSET_RATIO = 1.6f;     // flux above this multiple of its mean is an onset
+  constexpr float ONSET_FLOOR = 0.004f;   // absolute flux floor (keeps mic noise out)
+  constexpr float ONSET_MEAN_MS = 500.0f; // time constant of the threshold mean
+  constexpr float REFRACTORY_MS = 100.0f; // no second onset within this time
+  constexpr float PRIOR_OCTAVES = 1.0f;   // width of the log-tempo prior
+  constexpr float PLL_WINDOW = 0.2f;      // onsets within +-20 % of a beat correct the phase
+  constexpr float PLL_PHASE_GAIN = 0.3f;
+  constexpr float PLL_PERIOD_GAIN = 0.05f;
+  constexpr float TEMPO_JUMP = 0.08f;     // larger tempo changes are taken over at once
+  constexpr uint8_t REACQUIRE_MISSES = 4; // onsets in a row outside the window re-seed the phase ...
+  constexpr float REACQUIRE_DOMINANCE = 2.0f; // ... as does a histogram peak this much stronger than the window
+  constexpr float PHASE_HIST_DECAY = 0.9f; // per onset
+  constexpr uint8_t B = Settings::BEAT_PHASE_BINS;
+
+  float histAt(const BeatTracker &bt, uint16_t i) // i = 0 is the oldest entry
+  {
+    return bt.history[(bt.head + H - bt.filled + i) & (H - 1)];
+  }
+
+  void estimateTempo(BeatTracker &bt, float frameMs)
+  {
+    const uint16_t lagMin = (uint16_t)(60000.0f / (Settings::BEAT_MAX_BPM * frameMs));
+    const uint16_t lagMax = (uint16_t)ceilf(60000.0f / (Settings::BEAT_MIN_BPM * frameMs));
+    const uint16_t n = bt.filled;
+    if (lagMin < 2 || n < 2 * lagMax + 2)
+      return;
+    float mean = 0.0f;
+    for (uint16_t i = 0; i < n; ++i)
+      mean += histAt(bt, i);
+    mean /= (float)n;
+    static float x[H];
+    for (uint16_t i = 0; i < n; ++i)
+      x[i] = histAt(bt, i) - mean;
+
+    float r0 = 0.0f;
+    for (uint16_t i = 0; i < n; ++i)
+      r0 += x[i] * x[i];
+    if (r0 <= 0.0f)
+      return;
+    // Unbiased autocorrelation over the lag range, one extra lag on each side for interpolation.
+    static float r[H];
+    for (uint16_t lag = lagMin - 1; lag <= lagMax + 1; ++lag)
+    {
+      float acc = 0.0f;
+      for (uint16_t i = lag; i < n; ++i)
+        acc += x[i] * x[i - lag];
+      r[lag] = acc * (float)n / (float)(n - lag);
+    }
+    uint16_t best = 0;
+    float bestScore = 0.0f;
+    for (uint16_t lag = lagMin; lag <= lagMax; ++lag)
+    {
+      const float bpm = 60000.0f / ((float)lag * frameMs);
+      const float oct = log2f(bpm / Settings::BEAT_PRIOR_BPM) / PRIOR_OCTAVES;
+      const float score = r[lag] * expf(-0.5f * oct * oct);
+      if (score > bestScore)
+      {
+        bestScore = score;
+        best = lag;
+      }
+    }
+    if (!best)
+    {
+      bt.confidence *= 0.7f;
+      return;
+    }
+    // Parabolic interpolation for a sub-block period.
+    float period = (float)best;
+    const float den = r[best - 1] - 2.0f * r[best] + r[best + 1];
+    if (den < 0.0f)
+      period += 0.5f * (r[best - 1] - r[best + 1]) / den;
+    float conf = r[best] / r0;
+    conf = conf < 0.0f ? 0.0f : (conf > 1.0f ? 1.0f : conf);
+    bt.confidence += 0.4f * (conf - bt.confidence);
+
+    if (bt.periodFrames <= 0.0f || fabsf(period / bt.periodFrames - 1.0f) > TEMPO_JUMP)
+      bt.periodFrames = period;
+    else
+      bt.periodFrames += 0.25f * (period - bt.periodFrames);
+  }
+
+  /**
+   * @brief Record an onset of @p strength at the current phase in the decaying histogram.
+   */
+  void phaseHistAdd(BeatTracker &bt, float strength)
+  {
+    for (uint8_t i = 0; i < B; ++i)
+      bt.phaseHist[i] *= PHASE_HIST_DECAY;
+    bt.phaseHist[(uint8_t)(bt.phase * B) % B] += strength;
+  }
+
+  uint8_t phaseHistPeak(const BeatTracker &bt)
+  {
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < B; ++i)
+    {
+      if (bt.phaseHist[i] > bt.phaseHist[best])
+        best = i;
+    }
+    return best;
+  }
+
+  /**
+   * @brief True if the strongest onsets land outside the correction window (locked on an off-beat).
+   */
+  bool phaseHistOffBeat(const BeatTracker &bt)
+  {
+    const uint8_t peak = phaseHistPeak(bt);
+    float window = 0.0f;
+    bool peakInWindow = false;
+    for (uint8_t i = 0; i < B; ++i)
+    {
+      const float centre = ((float)i + 0.5f) / (float)B;
+      if (centre < PLL_WINDOW || centre > 1.0f - PLL_WINDOW)
+      {
+        window += bt.phaseHist[i];
+        peakInWindow = peakInWindow || i == peak;
+      }
+    }
+    return !peakInWindow && bt.phaseHist[peak] > REACQUIRE_DOMINANCE * window;
+  }
+
+  /**
+   * @brief Move the beat to the phase where the strongest recent onsets landed.
+   */
+  void phaseReacquire(BeatTracker &bt)
+  {
+    const uint8_t best = phaseHistPeak(bt);
+    // Centre of mass over the peak and its neighbours (circular).
+    const float l = bt.phaseHist[(best + B - 1) % B];
+    const float c = bt.phaseHist[best];
+    const float r = bt.phaseHist[(best + 1) % B];
+    const float offset = (l + c + r) > 0.0f ? (r - l) / (l + c + r) : 0.0f;
+    float peak = ((float)best + 0.5f + offset) / (float)B;
+    bt.phase -= peak;
+    while (bt.phase < 0.0f)
+      bt.phase += 1.0f;
+    while (bt.phase >= 1.0f)
+      bt.phase -= 1.0f;
+    memset(bt.phaseHist, 0, sizeof(bt.phaseHist));
+    bt.misses = 0;
+  }
+} // namespace
+
+void beatTrackerReset(BeatTracker &bt)
+{
+  memset(&bt, 0, sizeof(bt));
+}
+
+uint8_t beatTrackerFeed(BeatTracker &bt, float flux, float frameMs)
+{
+  uint8_t flags = 0;
+  bt.history[bt.head] = flux;
+  bt.head = (bt.head + 1) & (H - 1);
+  if (bt.filled < H)
+    bt.filled++;
+
+  // Onsets: flux well above its recent mean, at most one per refractory period.
+  const float threshold = bt.fluxMean * ONSET_RATIO + ONSET_FLOOR;
+  if (bt.refractory)
+    bt.refractory--;
+  else if (flux > threshold)
+  {
+    flags |= BEAT_ONSET;
+    bt.refractory = (uint16_t)(REFRACTORY_MS / frameMs);
+  }
+  bt.fluxMean += (frameMs / ONSET_MEAN_MS) * (flux - bt.fluxMean);
+
+  if (++bt.sinceTempo >= Settings::BEAT_TEMPO_EVERY)
+  {
+    bt.sinceTempo = 0;
+    estimateTempo(bt, frameMs);
+  }
+  if (bt.periodFrames <= 0.0f)
+    return flags;
+
+  bt.phase += 1.0f / bt.periodFrames;
+  if (bt.phase >= 1.0f)
+  {
+    bt.phase -= 1.0f;
+    flags |= BEAT_PREDICTED;
+  }
+  if (flags & BEAT_ONSET)
+  {
+    if (!beatTrackerLocked(bt))
+    {
+      bt.phase = 0.0f; // not locked yet: align the next prediction to this onset
+      bt.misses = 0;
+    }
+    else
+    {
+      phaseHistAdd(bt, flux / threshold);
+      // >0: the onset came after the predicted beat
+      const float err = bt.phase < 0.5f ? bt.phase : bt.phase - 1.0f;
+      if (fabsf(err) < PLL_WINDOW)
+      {
+        bt.phase -= PLL_PHASE_GAIN * err;
+        if (bt.phase < 0.0f)
+          bt.phase += 1.0f;
+        bt.periodFrames *= 1.0f + PLL_PERIOD_GAIN * err;
+        bt.misses = 0;
+      }
+      else
+      {
+        bt.misses++;
+      }
+      if (bt.misses >= REACQUIRE_MISSES || phaseHistOffBeat(bt))
+        phaseReacquire(bt);
+    }
+  }
+  bt.bpm = 60000.0f / (bt.periodFrames * frameMs);
+  return flags;
+}
+
+#endif
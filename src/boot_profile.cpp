@@ -0,0 +1,53 @@
+/**
+ * @file boot_profile.cpp
+ * @brief Fixed table of boot-phase timestamps and their report.
+ */
+
+#include "boot_profile.h"
+
+#include <atomic>
+
+#include "settings.h"
+#include "lamp_config.h"
+#include "tokenlog.h"
+
+volatile uint32_t bootFirstLightUs = 0;
+
+namespace
+{
+  struct BootMark
+  {
+    const char *phase;
+    uint32_t us;
+  };
+
+  BootMark marks[Settings::BOOT_MARKS_MAX];
+  std::atomic<uint8_t> markCount(0); // setup() and the boot task both mark
+} // namespace
+
+void bootMark(const char *phase)
+{
+  const uint32_t now = micros();
+  const uint8_t i = markCount.fetch_add(1);
+  if (i >= Settings::BOOT_MARKS_MAX)
+    return;
+  marks[i].phase = phase;
+  marks[i].us = now;
+}
+
+void bootProfileFeedback()
+{
+  uint8_t n = markCount.load();
+  if (n > Settings::BOOT_MARKS_MAX)
+    n = Settings::BOOT_MARKS_MAX;
+  uint32_t prev = 0;
+  for (uint8_t i = 0; i < n; ++i)
+  {
+    // Marks from the boot task interleave with setup(); durations are to the previous mark.
+    TLOG("[Boot] %s at %lu us (+%lu us)", marks[i].phase, (unsigned long)marks[i].us,
+         (unsigned long)(marks[i].us >= prev ? marks[i].us - prev : 0));
+    prev = marks[i].us;
+  }
+  // 0 = the lamp has not been lit since boot
+  TLOG("[Boot] first light at %lu us, fast=%s", (unsigned long)bootFirstLightUs, ENABLE_FAST_BOOT ? "on" : "off");
+}
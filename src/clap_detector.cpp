@@ -0,0 +1,143 @@
+/**
+ * @file clap_detector.cpp
+ * @brief Clap candidates from block RMS jumps, classified by a fixed-point decision tree.
+ */
+
+#include "clap_detector.h"
+
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  constexpr float ONSET_JUMP = 2.0f;       // RMS rise over the previous block (6 dB): claps start abruptly
+  constexpr float ONSET_RATIO = 2.8f;      // and over the background (9 dB)
+  constexpr float RMS_FLOOR = 0.005f;      // background never counts as quieter than this
+  constexpr float BACKGROUND_MS = 1000.0f; // time constant of the background RMS
+
+  enum ClapFeature : uint8_t
+  {
+    F_RISE,
+    F_DECAY,
+    F_CENTROID,
+    F_CREST,
+    F_BASS,
+  };
+
+  constexpr int8_t NO = -1;
+  constexpr int8_t YES = -2;
+
+  /** @brief Tree node: go to `below` if feature < threshold, else to `atOrAbove` (node index or leaf). */
+  struct ClapNode
+  {
+    uint8_t feature;
+    int16_t threshold;
+    int8_t below;
+    int8_t atOrAbove;
+  };
+
+  // Thresholds (here and ONSET_* above) are tuned on synthetic signals only:
+  // generated claps, door slams, speech-like bursts and kick/hi-hat loops from
+  // `tools/audio_replay.py synth`. No recorded room audio has been labelled yet,
+  // so real microphones, rooms and clap styles may need retuning; check with
+  // `clap train on` and add a labelled recording to tools/audio_replay/suite.json.
+  constexpr ClapNode TREE[] = {
+      {F_RISE, 120, NO, 1},      // 0: less than 12 dB over the room/music: transient in music
+      {F_BASS, 500, 2, NO},      // 1: half the energy below 200 Hz: door, knock, kick (a clap on a kick: up to 25 %)
+      {F_CENTROID, 1000, NO, 3}, // 2: dull: speech vowel, thump
+      {F_DECAY, 80, NO, 4},      // 3: still loud after ~50 ms: speech, music, slammed objects ringing
+      {F_CREST, 15, NO, YES},    // 4: sine-like (crest 1.4) or clipped flat: hum, beeps, overload
+  };
+
+  int16_t featureValue(const ClapFeatures &f, uint8_t feature)
+  {
+    switch (feature)
+    {
+    case F_RISE: return f.riseDb10;
+    case F_DECAY: return f.decayDb10;
+    case F_CENTROID: return f.centroidHz;
+    case F_CREST: return f.crest10;
+    default: return f.bassPermille;
+    }
+  }
+
+  bool classify(const ClapFeatures &f)
+  {
+    int8_t node = 0;
+    while (node >= 0)
+    {
+      const ClapNode &n = TREE[node];
+      node = featureValue(f, n.feature) < n.threshold ? n.below : n.atOrAbove;
+    }
+    return node == YES;
+  }
+
+  int16_t db10(float ratio)
+  {
+    const float v = 200.0f * log10f(ratio > 1e-6f ? ratio : 1e-6f);
+    return (int16_t)(v > 32767.0f ? 32767.0f : (v < -32767.0f ? -32767.0f : v));
+  }
+
+  int16_t sat16(float v)
+  {
+    return (int16_t)(v > 32767.0f ? 32767.0f : (v < 0.0f ? 0.0f : v));
+  }
+
+  void takeBlock(ClapDetector &cd, float rms, float peak, float centroidHz, float bassShare)
+  {
+    cd.maxRms = rms;
+    cd.peak = peak;
+    cd.centroidHz = centroidHz;
+    cd.crest = rms > 0.0f ? peak / rms : 0.0f;
+    cd.bassShare = bassShare;
+  }
+} // namespace
+
+void clapDetectorReset(ClapDetector &cd)
+{
+  memset(&cd, 0, sizeof(cd));
+  cd.background = RMS_FLOOR;
+}
+
+bool clapDetectorFeed(ClapDetector &cd, float rms, float peak, float centroidHz, float bassShare, float blockMs)
+{
+  const float prev = cd.prevRms;
+  cd.prevRms = rms;
+  if (!cd.stage)
+  {
+    const float bg = cd.background > RMS_FLOOR ? cd.background : RMS_FLOOR;
+    if (rms > prev * ONSET_JUMP && rms > bg * ONSET_RATIO)
+    {
+      cd.stage = 1;
+      cd.onsetBackground = bg;
+      takeBlock(cd, rms, peak, centroidHz, bassShare);
+    }
+    else
+    {
+      cd.background += (blockMs / BACKGROUND_MS) * (rms - cd.background);
+    }
+    return false;
+  }
+  cd.stage++;
+  // A clap starting late in a block peaks in the next one.
+  if (cd.stage == 2 && rms > cd.maxRms)
+    takeBlock(cd, rms, peak, centroidHz, bassShare);
+  if (cd.stage < 1 + Settings::CLAP_DECAY_BLOCKS)
+    return false;
+
+  ClapFeatures &f = cd.last;
+  f.riseDb10 = db10(cd.maxRms / cd.onsetBackground);
+  f.decayDb10 = db10(cd.maxRms / (rms > 1e-6f ? rms : 1e-6f));
+  f.centroidHz = sat16(cd.centroidHz);
+  f.crest10 = sat16(cd.crest * 10.0f);
+  f.bassPermille = sat16(cd.bassShare * 1000.0f);
+  f.peak = 2.0f * cd.peak;
+  cd.lastWasClap = classify(f);
+  cd.candidates++;
+  cd.stage = 0;
+  return cd.lastWasClap;
+}
+
+#endif
@@ -23,6 +23,18 @@
 #include "notifications.h"
 #include "pattern.h"
 #include "demo.h"
+#include "events.h"
+#include "telemetry.h"
+#include "log_sink.h"
+#include "tokenlog.h"
+#include "settings_registry.h"
+#include "audio_capture.h"
+#include "adc_scanner.h"
+#include "input_events.h"
+#include "profiles.h"
+#include "config_snapshot.h"
+#include "rtc_state.h"
+#include "boot_profile.h"
 
 #if ENABLE_BLE
 #include <BLEDevice.h>
@@ -35,6 +47,15 @@ size_t sosPrevPattern = 0;
 bool sosPrevAutoCycle = false;
 bool sosPrevLampOn = false;
 
+/**
+ * @brief Parse a command argument into a registry setting; its table range clamps or rejects it.
+ */
+static bool setRegistered(const char *key, String val)
+{
+    val.trim();
+    const SettingDef *def = settingFind(key);
+    return def && settingParse(*def, val);
+}
 
 /**
  * @brief Parse and execute a command string from any input channel.
@@ -69,7 +90,7 @@ void handleCommand(String line)
             quickMask = computeDefaultQuickMask();
             sanitizeQuickMask();
             saveSettings();
-            sendFeedback(String(F("[Quick] default -> ")) + quickMaskToCsv());
+            TLOG("[Quick] default -> %s", quickMaskToCsv());
             return;
         }
         uint64_t mask = 0;
@@ -78,7 +99,7 @@ void handleCommand(String line)
             quickMask = mask;
             sanitizeQuickMask();
             saveSettings();
-            sendFeedback(String(F("[Quick] set -> ")) + quickMaskToCsv());
+            TLOG("[Quick] set -> %s", quickMaskToCsv());
         }
         else
         {
@@ -134,7 +155,7 @@ void handleCommand(String line)
 #if ENABLE_TOUCH_DIM
         printTouchDebug();
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -143,7 +164,7 @@ void handleCommand(String line)
 #if ENABLE_TOUCH_DIM
         calibrateTouchGuided();
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -158,14 +179,14 @@ void handleCommand(String line)
             touchDeltaOn = on;
             touchDeltaOff = off;
             saveSettings();
-            sendFeedback(String(F("[Touch] tune on=")) + String(on) + F(" off=") + String(off));
+            TLOG("[Touch] tune on=%d off=%d", on, off);
         }
         else
         {
             sendFeedback(F("Usage: touch tune <on> <off>"));
         }
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -177,14 +198,42 @@ void handleCommand(String line)
         {
             touchHoldStartMs = v;
             saveSettings();
-            sendFeedback(String(F("[Touch] hold ms=")) + String(v));
+            TLOG("[Touch] hold ms=%lu", v);
         }
         else
         {
             sendFeedback(F("Usage: touch hold 500-5000"));
         }
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
+#endif
+        return;
+    }
+    if (lower.startsWith("touch 1") || lower.startsWith("touch 2") || lower.startsWith("touch 3"))
+    {
+#if ENABLE_TOUCH_DIM
+        // Tap bindings; `none` clears. Without a 2x/3x binding a single tap fires on release.
+        uint8_t count = lower[6] - '0';
+        String cmd = line.substring(7);
+        cmd.trim();
+        if (cmd.length() == 0)
+        {
+            String &cur = (count == 1) ? touchCmd1 : (count == 2) ? touchCmd2 : touchCmd3;
+            TLOG("[Touch] %dx -> %s", count, cur.isEmpty() ? String(F("none")) : cur);
+            return;
+        }
+        if (cmd.equalsIgnoreCase("none"))
+            cmd = "";
+        if (count == 1)
+            touchCmd1 = cmd;
+        else if (count == 2)
+            touchCmd2 = cmd;
+        else
+            touchCmd3 = cmd;
+        saveSettings();
+        TLOG("[Touch] %dx -> %s", count, cmd.isEmpty() ? String(F("none")) : cmd);
+#else
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -193,9 +242,9 @@ void handleCommand(String line)
 #if ENABLE_TOUCH_DIM
         touchDimEnabled = true;
         saveSettings();
-        sendFeedback(F("[TouchDim] Enabled"));
+        TLOG("[TouchDim] Enabled");
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -204,9 +253,9 @@ void handleCommand(String line)
 #if ENABLE_TOUCH_DIM
         touchDimEnabled = false;
         saveSettings();
-        sendFeedback(F("[TouchDim] Disabled"));
+        TLOG("[TouchDim] Disabled");
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -220,9 +269,9 @@ void handleCommand(String line)
             v = 0.05f;
         touchDimStep = v;
         saveSettings();
-        sendFeedback(String(F("[TouchDim] speed=")) + String(v, 3));
+        TLOG("[TouchDim] speed=%.3f", v);
 #else
-        sendFeedback(F("[Touch] disabled in build"));
+        TLOG("[Touch] disabled in build");
 #endif
         return;
     }
@@ -250,7 +299,7 @@ void handleCommand(String line)
             {
                 customStepMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Custom] step ms=")) + String(v));
+                TLOG("[Custom] step ms=%lu", v);
             }
             else
             {
@@ -291,7 +340,7 @@ void handleCommand(String line)
             for (size_t i = 0; i < count; ++i)
                 customPattern[i] = vals[i];
             saveSettings();
-            sendFeedback(String(F("[Custom] Stored ")) + String(count) + F(" values"));
+            TLOG("[Custom] Stored %u values", count);
         }
         else
         {
@@ -337,7 +386,7 @@ void handleCommand(String line)
         {
             patternSpeedScale = v;
             saveSettings();
-            sendFeedback(String(F("[Pattern] speed scale=")) + String(v, 2));
+            TLOG("[Pattern] speed scale=%.2f", v);
         }
         else
         {
@@ -357,7 +406,7 @@ void handleCommand(String line)
             {
                 patternFadeStrength = v;
                 saveSettings();
-                sendFeedback(String(F("[Pattern] fade amt=")) + String(v, 2));
+                TLOG("[Pattern] fade amt=%.2f", v);
             }
             else
             {
@@ -371,7 +420,7 @@ void handleCommand(String line)
             {
                 patternFadeEnabled = v;
                 saveSettings();
-                sendFeedback(String(F("[Pattern] fade ")) + (v ? F("ON") : F("OFF")));
+                TLOG("[Pattern] fade %s", v ? "ON" : "OFF");
             }
             else
             {
@@ -398,7 +447,7 @@ void handleCommand(String line)
         }
         patternInvert = v;
         saveSettings();
-        sendFeedback(String(F("[Pattern] invert ")) + (patternInvert ? F("ON") : F("OFF")));
+        TLOG("[Pattern] invert %s", patternInvert ? "ON" : "OFF");
         return;
     }
     if (lower.startsWith("pat margin") || lower.startsWith("pattern margin"))
@@ -418,7 +467,7 @@ void handleCommand(String line)
             patternMarginLow = lo;
             patternMarginHigh = hi;
             saveSettings();
-            sendFeedback(String(F("[Pattern] margin lo=")) + String(lo, 3) + F(" hi=") + String(hi, 3));
+            TLOG("[Pattern] margin lo=%.3f hi=%.3f", lo, hi);
         }
         else
         {
@@ -451,7 +500,7 @@ void handleCommand(String line)
                 a = 1.0f;
             filtersSetIir(en, a);
             saveSettings();
-            sendFeedback(String(F("[Filter] IIR ")) + (en ? F("ON ") : F("OFF ")) + F("alpha=") + String(a, 3));
+            TLOG("[Filter] IIR %salpha=%.3f", en ? "ON " : "OFF ", a);
         }
         else if (arg.startsWith("clip"))
         {
@@ -485,7 +534,7 @@ void handleCommand(String line)
             }
             filtersSetClip(en, amt, curve);
             saveSettings();
-            sendFeedback(String(F("[Filter] Clip ")) + (en ? F("ON ") : F("OFF ")) + F("amt=") + String(amt, 2) + F(" curve=") + (curve ? F("soft") : F("tanh")));
+            TLOG("[Filter] Clip %samt=%.2f curve=%s", en ? "ON " : "OFF ", amt, curve ? "soft" : "tanh");
         }
         else if (arg.startsWith("trem"))
         {
@@ -534,7 +583,7 @@ void handleCommand(String line)
                 depth = 1.0f;
             filtersSetTrem(en, rate, depth, wave);
             saveSettings();
-            sendFeedback(String(F("[Filter] Trem ")) + (en ? F("ON ") : F("OFF ")) + F(" rate=") + String(rate, 2) + F(" depth=") + String(depth, 2));
+            TLOG("[Filter] Trem %s rate=%.2f depth=%.2f", en ? "ON " : "OFF ", rate, depth);
         }
         else if (arg.startsWith("spark"))
         {
@@ -583,7 +632,7 @@ void handleCommand(String line)
                 dec = 5000;
             filtersSetSpark(en, dens, inten, dec);
             saveSettings();
-            sendFeedback(String(F("[Filter] Spark ")) + (en ? F("ON ") : F("OFF ")) + F(" dens=") + String(dens, 2) + F(" int=") + String(inten, 2) + F(" dec=") + String(dec) + F("ms"));
+            TLOG("[Filter] Spark %s dens=%.2f int=%.2f dec=%lums", en ? "ON " : "OFF ", dens, inten, dec);
         }
         else if (arg.startsWith("comp"))
         {
@@ -643,7 +692,7 @@ void handleCommand(String line)
                 rel = 4000;
             filtersSetComp(en, thr, ratio, att, rel);
             saveSettings();
-            sendFeedback(String(F("[Filter] Comp ")) + (en ? F("ON ") : F("OFF ")) + F(" thr=") + String(thr, 2) + F(" ratio=") + String(ratio, 2) + F(" att=") + String(att) + F("ms rel=") + String(rel) + F("ms"));
+            TLOG("[Filter] Comp %s thr=%.2f ratio=%.2f att=%lums rel=%lums", en ? "ON " : "OFF ", thr, ratio, att, rel);
         }
         else if (arg.startsWith("env"))
         {
@@ -682,7 +731,7 @@ void handleCommand(String line)
                 rel = 6000;
             filtersSetEnv(en, att, rel);
             saveSettings();
-            sendFeedback(String(F("[Filter] Env ")) + (en ? F("ON ") : F("OFF ")) + F(" att=") + String(att) + F("ms rel=") + String(rel) + F("ms"));
+            TLOG("[Filter] Env %s att=%lums rel=%lums", en ? "ON " : "OFF ", att, rel);
         }
         else if (arg.startsWith("delay"))
         {
@@ -731,7 +780,7 @@ void handleCommand(String line)
                 mix = 1.0f;
             filtersSetDelay(en, dMs, fb, mix);
             saveSettings();
-            sendFeedback(String(F("[Filter] Delay ")) + (en ? F("ON ") : F("OFF ")) + F(" ms=") + String(dMs) + F(" fb=") + String(fb, 2) + F(" mix=") + String(mix, 2));
+            TLOG("[Filter] Delay %s ms=%lu fb=%.2f mix=%.2f", en ? "ON " : "OFF ", dMs, fb, mix);
             return;
         }
         else
@@ -750,7 +799,7 @@ void handleCommand(String line)
         {
             outputGamma = v;
             saveSettings();
-            sendFeedback(String(F("[PWM] gamma=")) + String(v, 2));
+            TLOG("[PWM] gamma=%.2f", v);
         }
         else
         {
@@ -767,13 +816,13 @@ void handleCommand(String line)
         {
             extInputEnabled = true;
             saveSettings();
-            sendFeedback(F("[Ext] Enabled"));
+            TLOG("[Ext] Enabled");
         }
         else if (arg.startsWith("off"))
         {
             extInputEnabled = false;
             saveSettings();
-            sendFeedback(F("[Ext] Disabled"));
+            TLOG("[Ext] Disabled");
         }
         else if (arg.startsWith("mode"))
         {
@@ -796,7 +845,7 @@ void handleCommand(String line)
                 pinMode(Settings::EXT_INPUT_PIN, Settings::EXT_INPUT_ACTIVE_LOW ? INPUT_PULLUP : INPUT);
             }
             saveSettings();
-            sendFeedback(String(F("[Ext] Mode=")) + (extInputAnalog ? F("analog") : F("digital")));
+            TLOG("[Ext] Mode=%s", extInputAnalog ? "analog" : "digital");
         }
         else if (arg.startsWith("alpha"))
         {
@@ -807,7 +856,7 @@ void handleCommand(String line)
                 v = 1.0f;
             extInputAlpha = v;
             saveSettings();
-            sendFeedback(String(F("[Ext] alpha=")) + String(v, 3));
+            TLOG("[Ext] alpha=%.3f", v);
         }
         else if (arg.startsWith("delta"))
         {
@@ -818,7 +867,7 @@ void handleCommand(String line)
                 v = 1.0f;
             extInputDelta = v;
             saveSettings();
-            sendFeedback(String(F("[Ext] delta=")) + String(v, 3));
+            TLOG("[Ext] delta=%.3f", v);
         }
         else
         {
@@ -835,7 +884,7 @@ void handleCommand(String line)
         if (briMaxUser < briMinUser)
             briMaxUser = briMinUser;
         saveSettings();
-        sendFeedback(String(F("[Bri] min=")) + String(v, 3));
+        TLOG("[Bri] min=%.3f", v);
         return;
     }
     if (lower.startsWith("bri max"))
@@ -846,7 +895,7 @@ void handleCommand(String line)
             v = briMinUser;
         briMaxUser = v;
         saveSettings();
-        sendFeedback(String(F("[Bri] max=")) + String(v, 3));
+        TLOG("[Bri] max=%.3f", v);
         return;
     }
     if (lower.startsWith("bri"))
@@ -889,7 +938,7 @@ void handleCommand(String line)
             setBtSleepAfterBootMs(ms);
 #endif
             saveSettings();
-            sendFeedback(String(F("[BT] sleep after boot=")) + String(min, 2) + F(" min"));
+            TLOG("[BT] sleep after boot=%.2f min", min);
         }
         else if (arg.startsWith("ble"))
         {
@@ -901,7 +950,7 @@ void handleCommand(String line)
             setBtSleepAfterBleMs(ms);
 #endif
             saveSettings();
-            sendFeedback(String(F("[BT] sleep after idle command=")) + String(min, 2) + F(" min"));
+            TLOG("[BT] sleep after idle command=%.2f min", min);
         }
         else
         {
@@ -986,17 +1035,8 @@ void handleCommand(String line)
 #if ENABLE_LIGHT_SENSOR
         else if (lower.startsWith("ramp ambient") || lower.startsWith("ramp amb"))
         {
-            arg = arg.substring(arg.indexOf(' ') + 1);
-            arg.trim();
-            float v = arg.toFloat();
-            if (isnan(v))
-                v = rampAmbientFactor;
-            if (v < 0.0f)
-                v = 0.0f;
-            if (v > 5.0f)
-                v = 5.0f;
-            rampAmbientFactor = v;
-            sendFeedback(String(F("[Ramp] ambient factor=")) + String(rampAmbientFactor, 2));
+            setRegistered("ramp_amb", arg.substring(arg.indexOf(' ') + 1));
+            TLOG("[Ramp] ambient factor=%.2f", rampAmbientFactor);
             saveSettings();
         }
 #endif
@@ -1017,17 +1057,17 @@ void handleCommand(String line)
                     rampDurationMs = val;
                     rampOnDurationMs = val;
                     rampOffDurationMs = val;
-                    sendFeedback(String(F("[Ramp] on/off=")) + String(val) + F(" ms"));
+                    TLOG("[Ramp] on/off=%lu ms", val);
                 }
                 else if (isOn)
                 {
                     rampOnDurationMs = val;
-                    sendFeedback(String(F("[Ramp] on=")) + String(val) + F(" ms"));
+                    TLOG("[Ramp] on=%lu ms", val);
                 }
                 else if (isOff)
                 {
                     rampOffDurationMs = val;
-                    sendFeedback(String(F("[Ramp] off=")) + String(val) + F(" ms"));
+                    TLOG("[Ramp] off=%lu ms", val);
                 }
                 saveSettings();
             }
@@ -1052,7 +1092,7 @@ void handleCommand(String line)
                 v = 1.0f;
             notifyMinBrightness = v;
             saveSettings();
-            sendFeedback(String(F("[Notify] min_bri=")) + String(v * 100.0f, 1) + F("%"));
+            TLOG("[Notify] min_bri=%.1f%%", v * 100.0f);
             return;
         }
         String args = line.substring(6);
@@ -1102,7 +1142,7 @@ void handleCommand(String line)
                 seqStr += F("/");
             seqStr += String(notifySeq[i]);
         }
-        sendFeedback(String(F("[Notify] ")) + seqStr + (notifyInvert ? F(" invert") : F("")));
+        TLOG("[Notify] %s%s", seqStr, notifyInvert ? " invert" : "");
         return;
     }
     if (lower.startsWith("morse"))
@@ -1227,7 +1267,7 @@ void handleCommand(String line)
         }
         if (seq.empty())
         {
-            sendFeedback(F("[Morse] no valid symbols"));
+            TLOG("[Morse] no valid symbols");
             return;
         }
         bool wasActive = notifyActive;
@@ -1245,7 +1285,7 @@ void handleCommand(String line)
         }
         if (notifyRestoreLamp || !lampEnabled)
             setLampEnabled(true, "morse");
-        sendFeedback(String(F("[Morse] ")) + text);
+        TLOG("[Morse] %s", text);
         return;
     }
     if (lower == "notify stop")
@@ -1253,7 +1293,7 @@ void handleCommand(String line)
         notifyActive = false;
         if (!notifyPrevLampOn)
             forceLampOff("notify stop");
-        sendFeedback(F("[Notify] stopped"));
+        TLOG("[Notify] stopped");
         return;
     }
     if (lower.startsWith("idleoff"))
@@ -1266,9 +1306,9 @@ void handleCommand(String line)
         idleOffMs = (minutes == 0) ? 0 : (uint32_t)minutes * 60000U;
         saveSettings();
         if (idleOffMs == 0)
-            sendFeedback(F("[IdleOff] Disabled"));
+            TLOG("[IdleOff] Disabled");
         else
-            sendFeedback(String(F("[IdleOff] ")) + String(minutes) + F(" min"));
+            TLOG("[IdleOff] %d min", minutes);
         return;
     }
     if (lower.startsWith("light"))
@@ -1281,26 +1321,26 @@ void handleCommand(String line)
         {
             lightSensorEnabled = true;
             saveSettings();
-            sendFeedback(F("[Light] Enabled"));
+            TLOG("[Light] Enabled");
         }
         else if (arg == "off")
         {
             lightSensorEnabled = false;
             saveSettings();
-            sendFeedback(F("[Light] Disabled"));
+            TLOG("[Light] Disabled");
         }
         else if (arg.startsWith("calib"))
         {
             String which = arg.substring(5);
             which.trim();
-            int raw = analogRead(Settings::LIGHT_PIN);
+            int raw = audioAnalogRead(Settings::LIGHT_PIN);
             if (which == "min")
             {
                 lightFiltered = raw;
                 lightMinRaw = raw;
                 if ((int)lightMaxRaw <= (int)lightMinRaw)
                     lightMaxRaw = (uint16_t)min(4095, lightMinRaw + 50);
-                sendFeedback(String(F("[Light] Calibrated min raw=")) + String(raw) + F(" max=") + String((int)lightMaxRaw));
+                TLOG("[Light] Calibrated min raw=%d max=%d", raw, (int)lightMaxRaw);
             }
             else if (which == "max")
             {
@@ -1308,26 +1348,24 @@ void handleCommand(String line)
                 lightMaxRaw = raw;
                 if ((int)lightMinRaw >= (int)lightMaxRaw)
                     lightMinRaw = (uint16_t)((lightMaxRaw > 50) ? (lightMaxRaw - 50) : 0);
-                sendFeedback(String(F("[Light] Calibrated max raw=")) + String(raw) + F(" min=") + String((int)lightMinRaw));
+                TLOG("[Light] Calibrated max raw=%d min=%d", raw, (int)lightMinRaw);
             }
             else
             {
                 lightFiltered = raw;
                 lightMinRaw = raw;
                 lightMaxRaw = raw;
-                sendFeedback(String(F("[Light] Calibrated raw=")) + String(raw));
+                TLOG("[Light] Calibrated raw=%d", raw);
             }
+            // Calibrated values seed the auto-range window and age out of it like measured ones.
+            lightRangeRestart();
+            saveSettings();
         }
         else if (arg.startsWith("gain"))
         {
-            float g = arg.substring(4).toFloat();
-            if (g < 0.1f)
-                g = 0.1f;
-            if (g > 5.0f)
-                g = 5.0f;
-            lightGain = g;
+            setRegistered("light_gain", arg.substring(4));
             saveSettings();
-            sendFeedback(String(F("[Light] gain=")) + String(g, 2));
+            TLOG("[Light] gain=%.2f", lightGain);
         }
         else if (arg.startsWith("alpha"))
         {
@@ -1338,7 +1376,7 @@ void handleCommand(String line)
                 a = 0.8f;
             lightAlpha = a;
             saveSettings();
-            sendFeedback(String(F("[Light] alpha=")) + String(a, 3));
+            TLOG("[Light] alpha=%.3f", a);
         }
         else if (arg.startsWith("clamp"))
         {
@@ -1354,22 +1392,31 @@ void handleCommand(String line)
                 mx = 1.5f;
             if (mn >= mx)
             {
-                sendFeedback(F("[Light] clamp invalid (min>=max)"));
+                TLOG("[Light] clamp invalid (min>=max)");
             }
             else
             {
                 lightClampMin = mn;
                 lightClampMax = mx;
                 saveSettings();
-                sendFeedback(String(F("[Light] clamp ")) + String(mn, 2) + F("..") + String(mx, 2));
+                TLOG("[Light] clamp %.2f..%.2f", mn, mx);
             }
         }
+        else if (arg.startsWith("self"))
+        {
+            if (arg.endsWith("reset"))
+            {
+                lightSelfModelRestore(0.0f);
+                saveSettings();
+            }
+            lightSelfFeedback();
+        }
         else
         {
-            sendFeedback(String(F("[Light] raw=")) + String((int)lightFiltered) + F(" en=") + (lightSensorEnabled ? F("1") : F("0")));
+            TLOG("[Light] raw=%d en=%s", (int)lightFiltered, lightSensorEnabled ? "1" : "0");
         }
 #else
-        sendFeedback(F("[Light] Sensor disabled at build (ENABLE_LIGHT_SENSOR=0)"));
+        TLOG("[Light] Sensor disabled at build (ENABLE_LIGHT_SENSOR=0)");
 #endif
         return;
     }
@@ -1383,13 +1430,13 @@ void handleCommand(String line)
         {
             potiEnabled = true;
             saveSettings();
-            sendFeedback(F("[Poti] Enabled"));
+            TLOG("[Poti] Enabled");
         }
         else if (arg == "off")
         {
             potiEnabled = false;
             saveSettings();
-            sendFeedback(F("[Poti] Disabled"));
+            TLOG("[Poti] Disabled");
         }
         else if (arg.startsWith("alpha"))
         {
@@ -1398,7 +1445,7 @@ void handleCommand(String line)
             {
                 potiAlpha = v;
                 saveSettings();
-                sendFeedback(String(F("[Poti] alpha=")) + String(v, 2));
+                TLOG("[Poti] alpha=%.2f", v);
             }
             else
             {
@@ -1412,7 +1459,7 @@ void handleCommand(String line)
             {
                 potiDeltaMin = v;
                 saveSettings();
-                sendFeedback(String(F("[Poti] delta=")) + String(v, 3));
+                TLOG("[Poti] delta=%.3f", v);
             }
             else
             {
@@ -1426,7 +1473,7 @@ void handleCommand(String line)
             {
                 potiOffThreshold = v;
                 saveSettings();
-                sendFeedback(String(F("[Poti] off=")) + String(v, 3));
+                TLOG("[Poti] off=%.3f", v);
             }
             else
             {
@@ -1440,7 +1487,7 @@ void handleCommand(String line)
             {
                 potiSampleMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Poti] sample=")) + String(v) + F("ms"));
+                TLOG("[Poti] sample=%lums", v);
             }
             else
             {
@@ -1467,7 +1514,7 @@ void handleCommand(String line)
                 potiCalibMin = minV;
                 potiCalibMax = maxV;
                 saveSettings();
-                sendFeedback(String(F("[Poti] calib min=")) + String(minV, 3) + F(" max=") + String(maxV, 3));
+                TLOG("[Poti] calib min=%.3f max=%.3f", minV, maxV);
             }
             else
             {
@@ -1481,7 +1528,7 @@ void handleCommand(String line)
             bool val = (v == "1" || v == "on" || v == "true");
             potiInvert = val;
             saveSettings();
-            sendFeedback(String(F("[Poti] invert=")) + (potiInvert ? F("ON") : F("OFF")));
+            TLOG("[Poti] invert=%s", potiInvert ? "ON" : "OFF");
         }
         else
         {
@@ -1504,13 +1551,13 @@ void handleCommand(String line)
         {
             pushEnabled = true;
             saveSettings();
-            sendFeedback(F("[Push] Enabled"));
+            TLOG("[Push] Enabled");
         }
         else if (arg == "off")
         {
             pushEnabled = false;
             saveSettings();
-            sendFeedback(F("[Push] Disabled"));
+            TLOG("[Push] Disabled");
         }
         else if (arg.startsWith("debounce"))
         {
@@ -1519,7 +1566,7 @@ void handleCommand(String line)
             {
                 pushDebounceMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Push] debounce=")) + String(v) + F("ms"));
+                TLOG("[Push] debounce=%lums", v);
             }
             else
             {
@@ -1533,7 +1580,7 @@ void handleCommand(String line)
             {
                 pushDoubleMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Push] double=")) + String(v) + F("ms"));
+                TLOG("[Push] double=%lums", v);
             }
             else
             {
@@ -1547,7 +1594,7 @@ void handleCommand(String line)
             {
                 pushHoldMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Push] hold=")) + String(v) + F("ms"));
+                TLOG("[Push] hold=%lums", v);
             }
             else
             {
@@ -1561,7 +1608,7 @@ void handleCommand(String line)
             {
                 pushStepMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Push] step_ms=")) + String(v) + F("ms"));
+                TLOG("[Push] step_ms=%lums", v);
             }
             else
             {
@@ -1575,7 +1622,7 @@ void handleCommand(String line)
             {
                 pushStep = v;
                 saveSettings();
-                sendFeedback(String(F("[Push] step=")) + String(v * 100.0f, 1) + F("%"));
+                TLOG("[Push] step=%.1f%%", v * 100.0f);
             }
             else
             {
@@ -1599,29 +1646,22 @@ void handleCommand(String line)
         arg.toLowerCase();
         if (arg.startsWith("sens"))
         {
-            float g = arg.substring(4).toFloat();
-            if (g < 0.1f)
-                g = 0.1f;
-            if (g > 12.0f)
-                g = 12.0f;
-            musicGain = g;
+            setRegistered("music_gain", arg.substring(4));
             saveSettings();
-            sendFeedback(String(F("[Music] gain=")) + String(g, 2));
+            TLOG("[Music] gain=%.2f", musicGain);
         }
         else if (arg.startsWith("smooth"))
         {
-            float s = arg.substring(6).toFloat();
-            if (s < 0.0f)
-                s = 0.0f;
-            if (s > 1.0f)
-                s = 1.0f;
-            musicSmoothing = s;
+            setRegistered("music_smooth", arg.substring(6));
             saveSettings();
-            sendFeedback(String(F("[Music] smooth=")) + String(s, 2));
+            TLOG("[Music] smooth=%.2f", musicSmoothing);
         }
         else if (arg == "calib")
         {
-            sendFeedback(F("[Music] Calibrating... stay quiet, then clap once"));
+            TLOG("[Music] Calibrating... stay quiet, then clap once");
+#if ENABLE_AUDIO_DMA
+            audioCaptureStop(); // blocking analogRead() sweep; the loop restarts the capture
+#endif
             // Baseline: 500ms
             uint32_t t0 = millis();
             float dc = 0.0f;
@@ -1657,14 +1697,11 @@ void handleCommand(String line)
                 peak = 0.05f; // avoid zero
             // derive gain so peak lands near 0.6
             float targetEnv = 0.6f;
-            float g = targetEnv / peak;
-            if (g < 0.1f)
-                g = 0.1f;
-            if (g > 12.0f)
-                g = 12.0f;
-            musicGain = g;
+            const SettingDef *gainDef = settingFind("music_gain");
+            if (gainDef)
+                settingAssign(*gainDef, targetEnv / peak); // clamped to the table range
             // threshold at ~35% of peak
-            float thr = peak * g * 0.35f;
+            float thr = peak * musicGain * 0.35f;
             if (thr < 0.05f)
                 thr = 0.05f;
             if (thr > 1.0f)
@@ -1675,16 +1712,38 @@ void handleCommand(String line)
             musicFiltered = 0.0f;
             musicSmoothing = 0.4f;
             saveSettings();
-            sendFeedback(String(F("[Music] calib gain=")) + String(musicGain, 2) + F(" thr=") + String(clapThreshold, 2));
+            TLOG("[Music] calib gain=%.2f thr=%.2f", musicGain, clapThreshold);
         }
         else if (arg.startsWith("mode") || arg == "on" || arg == "off")
         {
-            sendFeedback(F("[Music] Select pattern 'Music Direct' or 'Music Beat' to use music mode."));
+            TLOG("[Music] Select pattern 'Music Direct' or 'Music Beat' to use music mode.");
+        }
+        else if (arg.startsWith("band"))
+        {
+            String rest = arg.substring(4);
+            rest.trim();
+            static const char *const bandNames[] = {"bass", "mid", "treble", "all"};
+            uint8_t band = 0xFF;
+            for (uint8_t i = 0; i <= AUDIO_BAND_COUNT; ++i)
+            {
+                if (rest == bandNames[i])
+                    band = i;
+            }
+            if (band == 0xFF)
+            {
+                sendFeedback(F("Usage: music band bass|mid|treble|all"));
+            }
+            else
+            {
+                musicBand = band;
+                saveSettings();
+                TLOG("[Music] band=%s", bandNames[band]);
+            }
         }
         else if (arg == "raw")
         {
-            int raw = analogRead(Settings::MUSIC_PIN);
-            sendFeedback(String(F("[Music] raw=")) + String(raw));
+            int raw = audioAnalogRead(Settings::MUSIC_PIN);
+            TLOG("[Music] raw=%d", raw);
         }
         else if (arg.startsWith("auto"))
         {
@@ -1695,13 +1754,13 @@ void handleCommand(String line)
             {
                 musicAutoLamp = true;
                 saveSettings();
-                sendFeedback(F("[Music] auto lamp ON"));
+                TLOG("[Music] auto lamp ON");
             }
             else if (rest == "off")
             {
                 musicAutoLamp = false;
                 saveSettings();
-                sendFeedback(F("[Music] auto lamp OFF"));
+                TLOG("[Music] auto lamp OFF");
             }
             else if (rest.startsWith("thr"))
             {
@@ -1712,7 +1771,7 @@ void handleCommand(String line)
                     v = 1.5f;
                 musicAutoThr = v;
                 saveSettings();
-                sendFeedback(String(F("[Music] auto thr=")) + String(v, 2));
+                TLOG("[Music] auto thr=%.2f", v);
             }
             else
             {
@@ -1738,7 +1797,7 @@ void handleCommand(String line)
         {
             clapEnabled = true;
             saveSettings();
-            sendFeedback(F("[Clap] Enabled"));
+            TLOG("[Clap] Enabled");
         }
         else if (arg == "off")
         {
@@ -1746,7 +1805,7 @@ void handleCommand(String line)
             clapCount = 0;
             clapWindowStartMs = 0;
             saveSettings();
-            sendFeedback(F("[Clap] Disabled"));
+            TLOG("[Clap] Disabled");
         }
         else if (arg.startsWith("thr"))
         {
@@ -1755,13 +1814,29 @@ void handleCommand(String line)
             {
                 clapThreshold = v;
                 saveSettings();
-                sendFeedback(String(F("[Clap] thr=")) + String(v, 2));
+                TLOG("[Clap] thr=%.2f", v);
             }
             else
             {
                 sendFeedback(F("Usage: clap thr 0.05-1.5"));
             }
         }
+#if ENABLE_AUDIO_DMA
+        else if (arg.startsWith("peak"))
+        {
+            float v = arg.substring(4).toFloat();
+            if (v >= 0.02f && v <= 1.0f)
+            {
+                clapPeakThreshold = v;
+                saveSettings();
+                TLOG("[Clap] peak=%.2f", v);
+            }
+            else
+            {
+                sendFeedback(F("Usage: clap peak 0.02-1"));
+            }
+        }
+#endif
         else if (arg.startsWith("cool"))
         {
             uint32_t v = arg.substring(4).toInt();
@@ -1769,7 +1844,7 @@ void handleCommand(String line)
             {
                 clapCooldownMs = v;
                 saveSettings();
-                sendFeedback(String(F("[Clap] cool=")) + String(v) + F("ms"));
+                TLOG("[Clap] cool=%lums", v);
             }
             else
             {
@@ -1785,12 +1860,12 @@ void handleCommand(String line)
             {
                 clapTraining = true;
                 clapTrainLastLog = 0;
-                sendFeedback(F("[Clap] Training ON"));
+                TLOG("[Clap] Training ON");
             }
             else if (mode == "off")
             {
                 clapTraining = false;
-                sendFeedback(F("[Clap] Training OFF"));
+                TLOG("[Clap] Training OFF");
             }
             else
             {
@@ -1815,15 +1890,20 @@ void handleCommand(String line)
                 else
                     clapCmd3 = cmd;
                 saveSettings();
-                sendFeedback(String(F("[Clap] ")) + count + F("x -> ") + cmd);
+                TLOG("[Clap] %dx -> %s", count, cmd);
             }
         }
         else
         {
-            sendFeedback(String(F("[Clap] ")) + (clapEnabled ? F("ON ") : F("OFF ")) + F("thr=") + String(clapThreshold, 2) + F(" cool=") + String(clapCooldownMs));
+#if ENABLE_AUDIO_DMA
+            TLOG("[Clap] %sthr=%.2f peak=%.2f cool=%lu", clapEnabled ? "ON " : "OFF ", clapThreshold, clapPeakThreshold,
+                 clapCooldownMs);
+#else
+            TLOG("[Clap] %sthr=%.2f cool=%lu", clapEnabled ? "ON " : "OFF ", clapThreshold, clapCooldownMs);
+#endif
         }
 #else
-        sendFeedback(F("[Clap] Audio sensor not built (ENABLE_MUSIC_MODE=0)"));
+        TLOG("[Clap] Audio sensor not built (ENABLE_MUSIC_MODE=0)");
 #endif
         return;
     }
@@ -1899,7 +1979,7 @@ void handleCommand(String line)
         {
             if (!sosModeActive)
             {
-                sendFeedback(F("[SOS] Nicht aktiv"));
+                TLOG("[SOS] Nicht aktiv");
             }
             else
             {
@@ -1916,7 +1996,7 @@ void handleCommand(String line)
                 else
                     setLampEnabled(false, "sos stop");
                 saveSettings();
-                sendFeedback(F("[SOS] beendet, Zustand wiederhergestellt"));
+                TLOG("[SOS] beendet, Zustand wiederhergestellt");
             }
         }
         else
@@ -1940,7 +2020,7 @@ void handleCommand(String line)
             if (sosIdx >= 0)
                 setPattern((size_t)sosIdx, true, false);
             sosModeActive = true;
-            sendFeedback(F("[SOS] aktiv (100% Helligkeit)"));
+            TLOG("[SOS] aktiv (100%% Helligkeit)");
         }
         return;
     }
@@ -1952,7 +2032,7 @@ void handleCommand(String line)
         if (arg == "stop" || arg == "cancel")
         {
             cancelSleepFade();
-            sendFeedback(F("[Sleep] Abgebrochen."));
+            TLOG("[Sleep] Abgebrochen.");
         }
         else
         {
@@ -1982,13 +2062,13 @@ void handleCommand(String line)
         {
             presenceEnabled = true;
             saveSettings();
-            sendFeedback(F("[Presence] Enabled"));
+            TLOG("[Presence] Enabled");
         }
         else if (arg == "off")
         {
             presenceEnabled = false;
             saveSettings();
-            sendFeedback(F("[Presence] Disabled"));
+            TLOG("[Presence] Disabled");
         }
         else if (arg.startsWith("set"))
         {
@@ -2001,11 +2081,11 @@ void handleCommand(String line)
                     presenceClearDevices();
                     presenceAddDevice(lastBleAddr);
                     saveSettings();
-                    sendFeedback(String(F("[Presence] Set to connected device ")) + lastBleAddr);
+                    TLOG("[Presence] Set to connected device %s", lastBleAddr);
                 }
                 else
                 {
-                    sendFeedback(F("[Presence] Kein aktives BLE-Geraet gefunden."));
+                    TLOG("[Presence] Kein aktives BLE-Geraet gefunden.");
                 }
             }
             else if (addr.length() >= 11)
@@ -2013,7 +2093,7 @@ void handleCommand(String line)
                 presenceClearDevices();
                 presenceAddDevice(addr);
                 saveSettings();
-                sendFeedback(String(F("[Presence] Set to ")) + addr);
+                TLOG("[Presence] Set to %s", addr);
             }
             else
             {
@@ -2028,14 +2108,17 @@ void handleCommand(String line)
             {
                 presenceAddDevice(lastBleAddr);
                 saveSettings();
-                sendFeedback(String(F("[Presence] Added connected ")) + lastBleAddr);
+                TLOG("[Presence] Added connected %s", lastBleAddr);
             }
             else if (addr.length() >= 11)
             {
-                if (presenceAddDevice(addr))
-                    sendFeedback(String(F("[Presence] Added ")) + addr);
+                uint64_t parsed;
+                if (!presenceParseAddr(addr, parsed))
+                    sendFeedback(F("Usage: presence add <MAC>"));
+                else if (presenceAddDevice(addr))
+                    TLOG("[Presence] Added %s", addr);
                 else
-                    sendFeedback(F("[Presence] Already on list"));
+                    TLOG("[Presence] Already on list");
                 saveSettings();
             }
             else
@@ -2049,37 +2132,32 @@ void handleCommand(String line)
             addr.trim();
             if (presenceRemoveDevice(addr))
             {
-                sendFeedback(String(F("[Presence] Removed ")) + addr);
+                TLOG("[Presence] Removed %s", addr);
                 saveSettings();
             }
             else
             {
-                sendFeedback(F("[Presence] Not found"));
+                TLOG("[Presence] Not found");
             }
         }
         else if (arg == "clear")
         {
             presenceClearDevices();
             saveSettings();
-            sendFeedback(F("[Presence] Cleared"));
+            TLOG("[Presence] Cleared");
         }
         else if (arg.startsWith("grace"))
         {
             uint32_t v = line.substring(line.indexOf("grace") + 5).toInt();
             presenceGraceMs = v;
             saveSettings();
-            sendFeedback(String(F("[Presence] Grace ")) + String(v) + F(" ms"));
+            TLOG("[Presence] Grace %lu ms", v);
         }
         else if (arg.startsWith("thr"))
         {
-            int v = line.substring(line.indexOf("thr") + 3).toInt();
-            if (v < -120)
-                v = -120;
-            if (v > -5)
-                v = -5;
-            presenceRssiThreshold = v;
+            setRegistered("presence_thr", line.substring(line.indexOf("thr") + 3));
             saveSettings();
-            sendFeedback(String(F("[Presence] RSSI >= ")) + String(v) + F(" dBm"));
+            TLOG("[Presence] RSSI >= %d dBm", presenceRssiThreshold);
         }
         else if (arg.startsWith("auto on"))
         {
@@ -2090,7 +2168,7 @@ void handleCommand(String line)
             {
                 presenceAutoOn = v;
                 saveSettings();
-                sendFeedback(String(F("[Presence] Auto-ON ")) + (v ? F("ON") : F("OFF")));
+                TLOG("[Presence] Auto-ON %s", v ? "ON" : "OFF");
             }
         }
         else if (arg.startsWith("auto off"))
@@ -2102,7 +2180,7 @@ void handleCommand(String line)
             {
                 presenceAutoOff = v;
                 saveSettings();
-                sendFeedback(String(F("[Presence] Auto-OFF ")) + (v ? F("ON") : F("OFF")));
+                TLOG("[Presence] Auto-OFF %s", v ? "ON" : "OFF");
             }
         }
         else if (arg.startsWith("on "))
@@ -2112,7 +2190,7 @@ void handleCommand(String line)
             {
                 presenceAutoOn = v;
                 saveSettings();
-                sendFeedback(String(F("[Presence] Auto-ON ")) + (v ? F("ON") : F("OFF")));
+                TLOG("[Presence] Auto-ON %s", v ? "ON" : "OFF");
             }
         }
         else if (arg.startsWith("off "))
@@ -2122,13 +2200,17 @@ void handleCommand(String line)
             {
                 presenceAutoOff = v;
                 saveSettings();
-                sendFeedback(String(F("[Presence] Auto-OFF ")) + (v ? F("ON") : F("OFF")));
+                TLOG("[Presence] Auto-OFF %s", v ? "ON" : "OFF");
             }
         }
         else if (arg == "list")
         {
             sendStatus();
         }
+        else if (arg == "stats")
+        {
+            presenceScanFeedback();
+        }
         else
         {
             sendStatus();
@@ -2148,9 +2230,24 @@ void handleCommand(String line)
             String payload = line.substring(line.indexOf("import") + 6);
             importConfig(payload);
         }
+        else if (arg.startsWith("snap"))
+        {
+            configSnapshotExport();
+        }
+        else if (arg.startsWith("put"))
+        {
+            String chunk = arg.substring(3);
+            chunk.trim();
+            if (!configSnapshotPut(chunk))
+                sendFeedback(F("[Config] Snapshot chunk rejected, transfer reset"));
+        }
+        else if (arg.startsWith("apply"))
+        {
+            configSnapshotApply();
+        }
         else
         {
-            sendFeedback(F("cfg export | cfg import key=val ..."));
+            sendFeedback(F("cfg export | cfg import key=val ... | cfg snap | cfg put <b64> | cfg apply"));
         }
         return;
     }
@@ -2160,7 +2257,7 @@ void handleCommand(String line)
         args.trim();
         if (args.isEmpty())
         {
-            sendFeedback(String(F("[Name] BLE=")) + getBleName() + F(" BT=") + getBtName());
+            TLOG("[Name] BLE=%s BT=%s", getBleName(), getBtName());
             return;
         }
         int sp = args.indexOf(' ');
@@ -2181,13 +2278,13 @@ void handleCommand(String line)
         {
             setBleName(val);
             saveSettings();
-            sendFeedback(String(F("[Name] BLE set to ")) + val);
+            TLOG("[Name] BLE set to %s", val);
         }
         else if (kind.equalsIgnoreCase(F("bt")))
         {
             setBtName(val);
             saveSettings();
-            sendFeedback(String(F("[Name] BT set to ")) + val);
+            TLOG("[Name] BT set to %s", val);
         }
         else
         {
@@ -2238,52 +2335,318 @@ void handleCommand(String line)
         }
         return;
     }
-    if (lower == "factory")
+#if ENABLE_TELEMETRY
+    if (lower.startsWith("telem"))
     {
-        applyDefaultSettings(-1.0f, true);
+        // telem [on|off] [hz] | telem ble|usb on|off | telem rate <hz>
+        String args = line.substring(5);
+        args.trim();
+        String argsLower = args;
+        argsLower.toLowerCase();
+        bool val = false;
+        if (args.isEmpty())
+        {
+            telemetryStatusFeedback();
+            return;
+        }
+        if (argsLower.startsWith("rate"))
+        {
+            if (!setTelemetryRate((uint16_t)args.substring(4).toInt()))
+                return;
+        }
+        else if (argsLower.startsWith("ble ") && parseBool(args.substring(4), val))
+        {
+            setTelemetryBle(val);
+        }
+        else if (argsLower.startsWith("usb ") && parseBool(args.substring(4), val))
+        {
+            telemetryUsb = val;
+        }
+        else
+        {
+            int sp = args.indexOf(' ');
+            String state = sp > 0 ? args.substring(0, sp) : args;
+            if (!parseBool(state, val))
+            {
+                sendFeedback(String(F("Usage: telem [on|off] [hz] | telem ble|usb on|off | telem rate <10-")) +
+                             String(Settings::TELEMETRY_HZ_MAX) + F(">"));
+                return;
+            }
+            // An out-of-range rate refuses the whole command instead of streaming at a clamped rate
+            if (sp > 0 && !setTelemetryRate((uint16_t)args.substring(sp + 1).toInt()))
+                return;
+            // "telem on" streams on the transport that asked for it
+            const bool fromBle = feedbackCommandFromBle();
+            setTelemetryBle(val && fromBle);
+            telemetryUsb = val && !fromBle;
+        }
+        telemetryStatusFeedback();
         return;
     }
-    if (lower.startsWith("profile"))
+#endif
+    if (lower == "boot")
     {
-        String arg = line.substring(7);
-        arg.trim();
-        if (arg.startsWith("save"))
+        // Boot-phase timestamps and time to first light
+        bootProfileFeedback();
+        return;
+    }
+    if (lower == "rtc")
+    {
+        // Reset reason and warm-reset restore timing
+        rtcStateFeedback();
+        return;
+    }
+#if ENABLE_MUSIC_MODE && ENABLE_AUDIO_DMA
+    if (lower == "audio")
+    {
+        // I2S-ADC capture rate, CPU per block and ADC-to-envelope latency
+        audioCaptureFeedback();
+        return;
+    }
+#endif
+    if (lower == "gpio")
+    {
+        // Switch/push/ext edges: bounces, lost edges, edge-to-loop latency
+        inputEventsFeedback();
+        return;
+    }
+    if (lower == "adc")
+    {
+        // Background scanner: pass rate, busy time per pass, latest light/poti/ext values
+        adcScannerFeedback();
+        return;
+    }
+    if (lower == "tok" || lower == "tok on" || lower == "tok off")
+    {
+        // Per client: TLOG() lines as `~<base64>` frames (decoded via tools/tokens.py DB)
+        if (lower != "tok")
+            feedbackSetTokens(lower == "tok on");
+        tokenStatsFeedback();
+        return;
+    }
+    if (lower == "get" || lower.startsWith("get ") || lower.startsWith("set "))
+    {
+        // get | get <key> | set <key> <value> (same keys and ranges as cfg import)
+        if (lower == "get")
+        {
+            String line = F("[Settings]");
+            settingsAppend(line, SETTING_STATUS);
+            sendFeedback(line);
+            return;
+        }
+        String rest = lower.substring(4);
+        rest.trim();
+        int sp = rest.indexOf(' ');
+        String key = sp > 0 ? rest.substring(0, sp) : rest;
+        const SettingDef *def = settingFind(key.c_str());
+        if (!def)
         {
-            int slot = arg.substring(4).toInt();
-            if (slot >= 1 && slot <= PROFILE_SLOTS)
+            sendFeedback(F("Usage: get [key] | set <key> <value>"));
+            return;
+        }
+        if (lower.startsWith("set "))
+        {
+            String val = sp > 0 ? rest.substring(sp + 1) : String();
+            val.trim();
+            if (val.length() == 0 || !settingParse(*def, val))
             {
-                String key = String(PREF_KEY_PROFILE_BASE) + String(slot);
-                String cfg = buildProfileString();
-                prefs.putString(key.c_str(), cfg);
-                sendFeedback(String(F("[Profile] Saved slot ")) + String(slot));
+                String usage = String(F("Usage: set ")) + def->key;
+                if (def->type == SettingType::Bool)
+                    usage += F(" on|off");
+                else if (def->type != SettingType::Ease)
+                    usage += String(F(" <")) + String(def->minVal, (unsigned int)def->decimals) + F("..") +
+                             String(def->maxVal, (unsigned int)def->decimals) + F(">");
+                sendFeedback(usage);
+                return;
             }
-            else
+            sanitizeLinkedSettings();
+            saveSettings();
+        }
+        TLOG("[Settings] %s=%s", def->key, settingFormat(*def));
+        return;
+    }
+    if (lower == "nvs" || lower.startsWith("nvs "))
+    {
+        // nvs | nvs flush | nvs delay <ms>
+        if (lower == "nvs flush")
+        {
+            flushSettings();
+        }
+        else if (lower.startsWith("nvs delay "))
+        {
+            long v = lower.substring(10).toInt();
+            if (v < 0 || v > (long)Settings::NVS_WRITE_MAX_DELAY_MS)
             {
-                sendFeedback(F("Usage: profile save <1-3>"));
+                sendFeedback(String(F("Usage: nvs delay <0-")) + String(Settings::NVS_WRITE_MAX_DELAY_MS) + F(">"));
+                return;
             }
+            settingsWriteDelayMs = (uint32_t)v;
+        }
+        else if (lower != "nvs")
+        {
+            sendFeedback(F("Usage: nvs | nvs flush | nvs delay <ms>"));
+            return;
         }
-        else if (arg.startsWith("load"))
+        settingsStatsFeedback();
+        return;
+    }
+    if (lower == "log" || lower.startsWith("log "))
+    {
+        // log | log level <0-5>
+        if (lower.startsWith("log level "))
         {
-            int slot = arg.substring(4).toInt();
-            if (slot >= 1 && slot <= PROFILE_SLOTS)
+            int lvl = lower.substring(10).toInt();
+            if (lvl < LOG_LEVEL_NONE || lvl > LOG_LEVEL)
             {
-                loadProfileSlot((uint8_t)slot, true);
+                sendFeedback(String(F("Usage: log level <0-")) + String(LOG_LEVEL) + F(">"));
+                return;
             }
-            else
+            logRuntimeLevel = (uint8_t)lvl;
+        }
+        else if (lower != "log")
+        {
+            sendFeedback(F("Usage: log | log level <0-5>"));
+            return;
+        }
+        logSinkStatsFeedback();
+        return;
+    }
+    if (lower == "events" || lower == "events reset")
+    {
+        eventStatsFeedback();
+        if (lower.endsWith("reset"))
+            resetEventStats();
+        return;
+    }
+    if (lower.startsWith("sub"))
+    {
+        // sub [all|none|<topic,...>|+topic|-topic] | sub rate <topic> <ms>
+        String args = line.substring(3);
+        args.trim();
+        String argsLower = args;
+        argsLower.toLowerCase();
+        if (args.isEmpty())
+        {
+            subscriptionFeedback();
+            return;
+        }
+        if (argsLower.startsWith("rate"))
+        {
+            String rest = args.substring(4);
+            rest.trim();
+            int sp = rest.indexOf(' ');
+            FeedbackTopic topic;
+            if (sp > 0 && feedbackTopicFromName(rest.substring(0, sp), topic))
+            {
+                long ms = rest.substring(sp + 1).toInt();
+                if (ms < 0)
+                    ms = 0;
+                feedbackSetRate(topic, (uint32_t)ms);
+                subscriptionFeedback();
+                return;
+            }
+            sendFeedback(F("Usage: sub rate <state|status|sensors|log|debug|midi> <ms>"));
+            return;
+        }
+        uint8_t mask = 0;
+        bool ok = true;
+        if (argsLower == "all")
+        {
+            mask = FEEDBACK_TOPICS_ALL;
+        }
+        else if (argsLower == "none")
+        {
+            mask = 0;
+        }
+        else if (args[0] == '+' || args[0] == '-')
+        {
+            FeedbackTopic topic;
+            ok = feedbackTopicFromName(args.substring(1), topic);
+            mask = feedbackGetTopics();
+            if (ok)
             {
-                sendFeedback(F("Usage: profile load <1-3>"));
+                const uint8_t bit = 1u << static_cast<uint8_t>(topic);
+                mask = (args[0] == '+') ? (mask | bit) : (mask & ~bit);
             }
         }
         else
         {
-            sendFeedback(F("profile save <1-3> | profile load <1-3>"));
+            int start = 0;
+            while (ok && start < (int)args.length())
+            {
+                int comma = args.indexOf(',', start);
+                if (comma < 0)
+                    comma = args.length();
+                String name = args.substring(start, comma);
+                name.trim();
+                FeedbackTopic topic;
+                if (!name.isEmpty())
+                {
+                    ok = feedbackTopicFromName(name, topic);
+                    if (ok)
+                        mask |= 1u << static_cast<uint8_t>(topic);
+                }
+                start = comma + 1;
+            }
+        }
+        if (!ok)
+        {
+            sendFeedback(F("Usage: sub | sub all|none | sub state,status,sensors,log,debug,midi | sub +<topic>|-<topic> | sub rate <topic> <ms>"));
+            return;
+        }
+        feedbackSetTopics(mask);
+        subscriptionFeedback();
+        return;
+    }
+    if (lower == "factory")
+    {
+        applyDefaultSettings(-1.0f, true);
+        return;
+    }
+    if (lower.startsWith("profile"))
+    {
+        // profile | profile save|load|clear <n> | profile load <n> keep (also persist the recalled settings)
+        String arg = lower.substring(7);
+        arg.trim();
+        if (arg.length() == 0)
+        {
+            profileStatsFeedback();
+            return;
+        }
+        int sp = arg.indexOf(' ');
+        String verb = sp > 0 ? arg.substring(0, sp) : arg;
+        String rest = sp > 0 ? arg.substring(sp + 1) : String();
+        rest.trim();
+        int slot = rest.toInt();
+        if (slot < 1 || slot > PROFILE_SLOTS)
+        {
+            sendFeedback(String(F("Usage: profile [save|load|clear <1-")) + String(PROFILE_SLOTS) + F(">]"));
+            return;
+        }
+        if (verb == "save")
+        {
+            if (saveProfileSlot((uint8_t)slot))
+                TLOG("[Profile] Saved slot %d", slot);
+        }
+        else if (verb == "load")
+        {
+            loadProfileSlot((uint8_t)slot, true, rest.endsWith(" keep"));
+        }
+        else if (verb == "clear")
+        {
+            clearProfileSlot((uint8_t)slot);
+            TLOG("[Profile] Cleared slot %d", slot);
+        }
+        else
+        {
+            sendFeedback(String(F("Usage: profile [save|load|clear <1-")) + String(PROFILE_SLOTS) + F(">]"));
         }
         return;
     }
     if (lower == "calibrate")
     {
         calibrateTouchBaseline();
-        sendFeedback(F("[Touch] Baseline neu kalibriert."));
+        TLOG("[Touch] Baseline-Kalibrierung gestartet.");
         return;
     }
 
@@ -2,6 +2,8 @@
 
 #include "lamp_config.h"
 #include "settings.h"
+#include "log_sink.h"
+#include "tokenlog.h"
 #include <vector>
 #include <deque>
 #include <algorithm>
@@ -56,6 +58,8 @@ static uint32_t btPairStartMs = 0;
 static String btPendingAddr;
 static const uint32_t BT_PAIR_TIMEOUT_MS = 20000;
 #endif
+static volatile bool commsStarted = false; // set once setupCommunications() finished
+
 // Line buffers
 static String bufferUsb;
 #if ENABLE_BT_SERIAL
@@ -68,6 +72,34 @@ static bool btSerialActive = false;
 static bool btSerialDisabled = false;
 #endif
 
+// Per-client topic subscriptions (reset whenever a client (re)connects)
+enum FeedbackChannel : uint8_t
+{
+  FEEDBACK_CH_USB = 0,
+  FEEDBACK_CH_BT,
+  FEEDBACK_CH_BLE,
+  FEEDBACK_CH_COUNT
+};
+struct FeedbackClient
+{
+  uint8_t topics = FEEDBACK_TOPICS_ALL;
+  uint32_t rateMs[FEEDBACK_TOPIC_COUNT] = {};
+  uint32_t lastMs[FEEDBACK_TOPIC_COUNT] = {};
+  bool tokens = false; // receives TLOG() lines as `~<base64>` frames
+};
+static FeedbackClient feedbackClients[FEEDBACK_CH_COUNT];
+static uint8_t commandChannel = FEEDBACK_CH_USB; // client of the command being handled
+static uint32_t feedbackSentCount[FEEDBACK_TOPIC_COUNT] = {};
+static uint32_t feedbackSkippedCount[FEEDBACK_TOPIC_COUNT] = {};
+static const char *const FEEDBACK_TOPIC_NAMES[FEEDBACK_TOPIC_COUNT] = {"state", "status", "sensors", "log", "debug", "midi"};
+static const char *const FEEDBACK_CHANNEL_NAMES[FEEDBACK_CH_COUNT] = {"usb", "bt", "ble"};
+
+static void resetFeedbackClient(uint8_t channel)
+{
+  if (channel < FEEDBACK_CH_COUNT)
+    feedbackClients[channel] = FeedbackClient();
+}
+
 inline bool feedbackAllowed()
 {
   return !Settings::FEEDBACK_NEEDS_HANDSHAKE || feedbackArmed;
@@ -178,7 +210,7 @@ bool allowBtAddr(const String &addr)
 /**
  * @brief Append a character to the line buffer and dispatch full commands.
  */
-void processInputChar(String &buffer, char c)
+void processInputChar(String &buffer, char c, uint8_t channel)
 {
   if (c == '\r')
     return;
@@ -188,6 +220,7 @@ void processInputChar(String &buffer, char c)
     if (!buffer.isEmpty())
     {
       armFeedback();
+      commandChannel = channel;
       handleCommand(buffer);
     }
     buffer = "";
@@ -253,14 +286,14 @@ static void powerOffBtSerial(const char *reason)
   btSerialDisabled = true;
   if (feedbackAllowed())
   {
-    Serial.print(F("[BT] Serial disabled"));
+    String msg = F("[BT] Serial disabled");
     if (reason && reason[0])
     {
-      Serial.print(F(" ("));
-      Serial.print(reason);
-      Serial.print(F(")"));
+      msg += F(" (");
+      msg += reason;
+      msg += F(")");
     }
-    Serial.println();
+    LOG_I(msg);
   }
 }
 
@@ -276,6 +309,7 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
   switch (event)
   {
   case ESP_SPP_SRV_OPEN_EVT:
+    resetFeedbackClient(FEEDBACK_CH_BT);
     if (param)
     {
       lastSppAddr = formatMac(param->srv_open.rem_bda);
@@ -285,7 +319,7 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
         if (!allowBtAddr(lastSppAddr))
         {
           if (feedbackAllowed())
-            Serial.println(F("[BT] Rejected unknown device"));
+            LOG_W(F("[BT] Rejected unknown device"));
           esp_spp_disconnect(param->srv_open.handle);
           return;
         }
@@ -294,7 +328,7 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
         btPairStartMs = millis();
         btPendingAddr = lastSppAddr;
         if (feedbackAllowed())
-          sendFeedback(String(F("[BT] Pair request ")) + lastSppAddr + F(" – confirm via switch or poti"));
+          TLOG("[BT] Pair request %s – confirm via switch or poti", lastSppAddr);
       }
       else
       {
@@ -310,16 +344,15 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
         saveSettings();
       if (known && feedbackAllowed())
       {
-        Serial.print(F("[BT] Client connected: "));
-        Serial.println(lastSppAddr);
-        sendFeedback(String(F("[BT] Client connected ")) + lastSppAddr);
+        LOG_I(String(F("[BT] Client connected: ")) + lastSppAddr);
+        TLOG("[BT] Client connected %s", lastSppAddr);
       }
     }
     else
     {
       lastBtActivityMs = millis();
       if (feedbackAllowed())
-        Serial.println(F("[BT] Client connected"));
+        LOG_I(F("[BT] Client connected"));
     }
     break;
   case ESP_SPP_CLOSE_EVT:
@@ -328,15 +361,14 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
       String addr = lastSppAddr;
       if (feedbackAllowed())
       {
-        Serial.print(F("[BT] Client disconnected: "));
-        Serial.println(addr);
-        sendFeedback(String(F("[BT] Client disconnected ")) + addr);
+        LOG_I(String(F("[BT] Client disconnected: ")) + addr);
+        TLOG("[BT] Client disconnected %s", addr);
       }
     }
     else
     {
       if (feedbackAllowed())
-        Serial.println(F("[BT] Client disconnected"));
+        LOG_I(F("[BT] Client disconnected"));
     }
 #if ENABLE_BT_PAIRING
     btPairPending = false;
@@ -353,6 +385,9 @@ void sppCallbackLocal(esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
 BLEServer *bleServer = nullptr;
 BLECharacteristic *bleCommandCharacteristic = nullptr;
 BLECharacteristic *bleStatusCharacteristic = nullptr;
+#if ENABLE_TELEMETRY
+BLECharacteristic *bleTelemetryCharacteristic = nullptr;
+#endif
 bool bleClientConnected = false;
 // Most recent BLE client address
 String bleLastAddr;
@@ -451,6 +486,42 @@ static void flushBleNotification()
   }
 }
 
+#if ENABLE_TELEMETRY
+/**
+ * @brief Largest notification payload all connected peers accept (ATT MTU - 3).
+ */
+size_t bleTelemetryPayloadMax()
+{
+  if (!bleClientConnected || !bleServer)
+    return 0;
+  size_t chunkSize = 20;
+  const auto peers = bleServer->getPeerDevices(false);
+  if (!peers.empty())
+  {
+    chunkSize = 514;
+    for (const auto &peer : peers)
+    {
+      size_t peerChunkSize = peer.second.mtu > 3 ? peer.second.mtu - 3 : 20;
+      if (peerChunkSize < chunkSize)
+        chunkSize = peerChunkSize;
+    }
+  }
+  return chunkSize;
+}
+
+/**
+ * @brief Notify one binary telemetry batch (must fit bleTelemetryPayloadMax()).
+ */
+bool bleNotifyTelemetry(const uint8_t *data, size_t length)
+{
+  if (!bleClientConnected || !bleTelemetryCharacteristic || length == 0)
+    return false;
+  bleTelemetryCharacteristic->setValue(const_cast<uint8_t *>(data), length);
+  bleTelemetryCharacteristic->notify();
+  return true;
+}
+#endif
+
 /**
  * @brief Handles BLE server connection events.
  */
@@ -477,23 +548,18 @@ class LampBleServerCallbacks : public BLEServerCallbacks
     if (!allowBleAddr(addr))
     {
       if (feedbackAllowed())
-      {
-        Serial.print(F("[BLE] Rejecting unknown "));
-        Serial.println(addr);
-      }
+        LOG_W(String(F("[BLE] Rejecting unknown ")) + addr);
       if (server)
         server->disconnect(param->connect.conn_id);
       bleClientConnected = false;
       return;
     }
     lastBtActivityMs = millis();
+    resetFeedbackClient(FEEDBACK_CH_BLE);
     if (addToList(trustedBle, addr))
       saveSettings();
     if (feedbackAllowed())
-    {
-      Serial.print(F("[BLE] Verbunden: "));
-      Serial.println(addr);
-    }
+      LOG_I(String(F("[BLE] Verbunden: ")) + addr);
   }
 
   // void onDisconnect(BLEServer *server) override
@@ -508,10 +574,7 @@ class LampBleServerCallbacks : public BLEServerCallbacks
     bleClientConnected = false;
     String addr = formatAddr(param->disconnect.remote_bda);
     if (feedbackAllowed())
-    {
-      Serial.print(F("[BLE] Getrennt: "));
-      Serial.println(addr);
-    }
+      LOG_I(String(F("[BLE] Getrennt: ")) + addr);
     bleLastAddr = addr;
     BLEDevice::startAdvertising();
   }
@@ -536,6 +599,7 @@ class LampBleCommandCallbacks : public BLECharacteristicCallbacks
         if (!line.isEmpty())
         {
           armFeedback();
+          commandChannel = FEEDBACK_CH_BLE;
           handleCommand(line);
         }
         line = "";
@@ -550,6 +614,7 @@ class LampBleCommandCallbacks : public BLECharacteristicCallbacks
     {
       lastBtActivityMs = millis();
       armFeedback();
+      commandChannel = FEEDBACK_CH_BLE;
       handleCommand(line);
     }
   }
@@ -576,6 +641,12 @@ void startBle()
   cccStat->setNotifications(true);
   cccStat->setIndications(true);
   bleStatusCharacteristic->addDescriptor(cccStat);
+#if ENABLE_TELEMETRY
+  bleTelemetryCharacteristic = service->createCharacteristic(
+      Settings::BLE_TELEMETRY_CHAR_UUID,
+      BLECharacteristic::PROPERTY_NOTIFY);
+  bleTelemetryCharacteristic->addDescriptor(new BLE2902());
+#endif
   service->start();
   BLEAdvertising *advertising = BLEDevice::getAdvertising();
   advertising->addServiceUUID(Settings::BLE_SERVICE_UUID);
@@ -603,7 +674,7 @@ void startBle()
   setupBleMidi(bleServer, advertising);
 #endif
   BLEDevice::startAdvertising();
-  Serial.println(F("[BLE] Werbung aktiv. Über BLE-Kommandos steuerbar."));
+  LOG_I(F("[BLE] Werbung aktiv. Über BLE-Kommandos steuerbar."));
 }
 #endif
 
@@ -615,13 +686,11 @@ void startBtSerial()
 {
   if (!serialBt.begin(btName))
   {
-    Serial.println(F("[BT] Classic Serial konnte nicht gestartet werden."));
+    LOG_E(F("[BT] Classic Serial konnte nicht gestartet werden."));
   }
   else
   {
-    Serial.print(F("[BT] Classic Serial aktiv als '"));
-    Serial.print(btName);
-    Serial.println(F("'"));
+    LOG_I(String(F("[BT] Classic Serial aktiv als '")) + btName + F("'"));
     serialBt.register_callback([](esp_spp_cb_event_t event, esp_spp_cb_param_t *param)
                               { sppCallbackLocal(event, param); });
     btSerialActive = true;
@@ -729,8 +798,8 @@ void confirmBtPairing(const char *reason)
 
 void trustListFeedback()
 {
-  sendFeedback(String(F("[Trust] BLE: ")) + trustGetBleCsv());
-  sendFeedback(String(F("[Trust] BT : ")) + trustGetBtCsv());
+  TLOG("[Trust] BLE: %s", trustGetBleCsv());
+  TLOG("[Trust] BT : %s", trustGetBtCsv());
 }
 
 
@@ -748,10 +817,16 @@ void setupCommunications()
   startBle();
 #else
   if (feedbackAllowed())
-    Serial.println(F("[BLE] deaktiviert (ENABLE_BLE=0)."));
+    LOG_I(F("[BLE] deaktiviert (ENABLE_BLE=0)."));
 #endif
   bootMsComm = millis();
   lastBtActivityMs = bootMsComm;
+  commsStarted = true;
+}
+
+bool communicationsReady()
+{
+  return commsStarted;
 }
 
 #if ENABLE_BT_SERIAL
@@ -775,8 +850,10 @@ void pollCommunications()
   while (Serial.available())
   {
     char c = (char)Serial.read();
-    processInputChar(bufferUsb, c);
+    processInputChar(bufferUsb, c, FEEDBACK_CH_USB);
   }
+  if (!commsStarted)
+    return; // fast boot: radios still starting in the boot task
 
 #if ENABLE_BT_SERIAL
   maybeSleepBtSerial(millis());
@@ -784,7 +861,7 @@ void pollCommunications()
   if (btPairPending && btPairStartMs > 0 && (millis() - btPairStartMs) > BT_PAIR_TIMEOUT_MS)
   {
     if (feedbackAllowed())
-      sendFeedback(F("[BT] Pair request timed out"));
+      TLOG("[BT] Pair request timed out");
     if (serialBt.hasClient())
       serialBt.disconnect();
     btPairPending = false;
@@ -804,7 +881,7 @@ void pollCommunications()
       if (btPairPending)
         continue; // commands are gated until pairing is confirmed
 #endif
-      processInputChar(bufferBt, c);
+      processInputChar(bufferBt, c, FEEDBACK_CH_BT);
     }
   }
 #endif
@@ -813,31 +890,198 @@ void pollCommunications()
 #endif
 }
 
+static bool feedbackChannelUp(uint8_t channel)
+{
+  switch (channel)
+  {
+  case FEEDBACK_CH_USB:
+    return true;
+#if ENABLE_BT_SERIAL
+  case FEEDBACK_CH_BT:
+    return btSerialActive && serialBt.hasClient();
+#endif
+#if ENABLE_BLE
+  case FEEDBACK_CH_BLE:
+    return bleClientConnected && bleStatusCharacteristic;
+#endif
+  default:
+    return false;
+  }
+}
+
 /**
- * @brief Broadcast a single text line to Serial, BT Serial (if connected) and BLE notify.
+ * @brief Compute the client bitmask for @p topic; optionally stamp the rate limiters.
  */
-void sendFeedback(const String &line, const bool &force)
+static uint8_t resolveFeedbackRoute(FeedbackTopic topic, bool force, bool claim)
 {
-  bool allow = feedbackAllowed();
-  if (!allow && !force)
-    return;
+  const uint8_t t = static_cast<uint8_t>(topic);
+  const bool allow = feedbackAllowed();
+  if ((!allow && !force) || t >= FEEDBACK_TOPIC_COUNT)
+    return 0;
+  const uint32_t now = millis();
+  uint8_t route = 0;
+  for (uint8_t ch = 0; ch < FEEDBACK_CH_COUNT; ++ch)
+  {
+    // Without handshake only forced lines reach USB (matches the old behavior).
+    if (!allow && ch != FEEDBACK_CH_USB)
+      continue;
+    FeedbackClient &client = feedbackClients[ch];
+    if (!(client.topics & (1u << t)) || !feedbackChannelUp(ch))
+      continue;
+    const uint32_t rate = client.rateMs[t];
+    if (!force && rate > 0 && client.lastMs[t] != 0 && (now - client.lastMs[t]) < rate)
+      continue;
+    route |= (1u << ch);
+    if (claim)
+      client.lastMs[t] = now;
+  }
+  if (claim)
+  {
+    if (route)
+      feedbackSentCount[t]++;
+    else
+      feedbackSkippedCount[t]++;
+  }
+  return route;
+}
 
-  Serial.println(line);
+bool feedbackWanted(FeedbackTopic topic, const bool &force)
+{
+  if (resolveFeedbackRoute(topic, force, false))
+    return true;
+  const uint8_t t = static_cast<uint8_t>(topic);
+  if (t < FEEDBACK_TOPIC_COUNT)
+    feedbackSkippedCount[t]++;
+  return false;
+}
+
+uint8_t feedbackRoute(FeedbackTopic topic, const bool &force)
+{
+  return resolveFeedbackRoute(topic, force, true);
+}
+
+/**
+ * @brief Deliver a text line to the clients in @p route.
+ */
+void sendFeedbackRoute(uint8_t route, const String &line)
+{
+  // USB/SPP go through the async sinks so a slow UART or SPP stack never
+  // stalls the caller; full rings drop the line (see `log`).
+  if (route & (1u << FEEDBACK_CH_USB))
+    logSinkWrite(LOG_SINK_USB, line);
 #if ENABLE_BT_SERIAL
-  if (allow && serialBt.hasClient())
+  // Fast boot: the radios may still be starting on the other core.
+  if ((route & (1u << FEEDBACK_CH_BT)) && commsStarted && serialBt.hasClient())
   {
-    serialBt.println(line);
+    logSinkWrite(LOG_SINK_BT, line);
   }
 #endif
 #if ENABLE_BLE
   // Queue newline-delimited feedback and split it according to the negotiated
   // ATT MTU. The main loop drains the queue so BLE callbacks never burst large
   // status snapshots into a single oversized notification.
-  if (allow && bleClientConnected && bleStatusCharacteristic)
+  if ((route & (1u << FEEDBACK_CH_BLE)) && commsStarted && bleClientConnected && bleStatusCharacteristic)
     queueBleNotification(line);
 #endif
 }
 
+void sendFeedback(FeedbackTopic topic, const String &line, const bool &force)
+{
+  const uint8_t route = feedbackRoute(topic, force);
+  if (route)
+    sendFeedbackRoute(route, line);
+}
+
+/**
+ * @brief Broadcast a single text line (Log topic) to Serial, BT Serial and BLE notify.
+ */
+void sendFeedback(const String &line, const bool &force)
+{
+  sendFeedback(FeedbackTopic::Log, line, force);
+}
+
+bool feedbackTopicFromName(const String &name, FeedbackTopic &out)
+{
+  for (uint8_t t = 0; t < FEEDBACK_TOPIC_COUNT; ++t)
+  {
+    if (name.equalsIgnoreCase(FEEDBACK_TOPIC_NAMES[t]))
+    {
+      out = static_cast<FeedbackTopic>(t);
+      return true;
+    }
+  }
+  return false;
+}
+
+void feedbackSetTopics(uint8_t mask) { feedbackClients[commandChannel].topics = mask & FEEDBACK_TOPICS_ALL; }
+uint8_t feedbackGetTopics() { return feedbackClients[commandChannel].topics; }
+
+void feedbackSetTokens(bool enabled) { feedbackClients[commandChannel].tokens = enabled; }
+bool feedbackGetTokens() { return feedbackClients[commandChannel].tokens; }
+uint8_t feedbackCommandRoute() { return 1u << commandChannel; }
+bool feedbackCommandFromBle() { return commandChannel == FEEDBACK_CH_BLE; }
+
+uint8_t feedbackTokenClients(uint8_t route)
+{
+  uint8_t out = 0;
+  for (uint8_t ch = 0; ch < FEEDBACK_CH_COUNT; ++ch)
+  {
+    if ((route & (1u << ch)) && feedbackClients[ch].tokens)
+      out |= (1u << ch);
+  }
+  return out;
+}
+
+void feedbackSetRate(FeedbackTopic topic, uint32_t minIntervalMs)
+{
+  const uint8_t t = static_cast<uint8_t>(topic);
+  if (t < FEEDBACK_TOPIC_COUNT)
+    feedbackClients[commandChannel].rateMs[t] = minIntervalMs;
+}
+
+/**
+ * @brief Report the caller's subscriptions and global per-topic counters.
+ */
+void subscriptionFeedback()
+{
+  const FeedbackClient &client = feedbackClients[commandChannel];
+  String line = F("[Sub] ");
+  line += FEEDBACK_CHANNEL_NAMES[commandChannel];
+  line += F(" topics=");
+  bool first = true;
+  for (uint8_t t = 0; t < FEEDBACK_TOPIC_COUNT; ++t)
+  {
+    if (!(client.topics & (1u << t)))
+      continue;
+    if (!first)
+      line += ',';
+    line += FEEDBACK_TOPIC_NAMES[t];
+    if (client.rateMs[t] > 0)
+    {
+      line += '@';
+      line += String(client.rateMs[t]);
+      line += F("ms");
+    }
+    first = false;
+  }
+  if (first)
+    line += F("none");
+  // Reply to the asking client even if it unsubscribed from "log".
+  const uint8_t route = 1u << commandChannel;
+  sendFeedbackRoute(route, line);
+  String stats = F("[Sub] sent/skipped");
+  for (uint8_t t = 0; t < FEEDBACK_TOPIC_COUNT; ++t)
+  {
+    stats += ' ';
+    stats += FEEDBACK_TOPIC_NAMES[t];
+    stats += '=';
+    stats += String(feedbackSentCount[t]);
+    stats += '/';
+    stats += String(feedbackSkippedCount[t]);
+  }
+  sendFeedbackRoute(route, stats);
+}
+
 
 /**
  * @brief Update BLE status characteristic (read + notify if connected).
@@ -0,0 +1,328 @@
+/**
+ * @file config_snapshot.cpp
+ * @brief Binary config snapshot: build/export, chunked receive and all-or-nothing apply.
+ */
+
+#include "config_snapshot.h"
+
+#include <string.h>
+#include <vector>
+
+#include "settings.h"
+#include "settings_registry.h"
+#include "persistence.h"
+#include "lamp_state.h"
+#include "inputs.h"
+#include "presence.h"
+#include "quickmode.h"
+#include "filters.h"
+#include "events.h"
+#include "comms.h"
+#include "tokenlog.h"
+#include "utils.h"
+
+namespace
+{
+  constexpr uint32_t SNAP_MAGIC = 0x31434C51; // "QLC1"
+  constexpr uint8_t SNAP_VERSION = 1;
+
+  struct __attribute__((packed)) SnapHeader
+  {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t settings; // registry records following the header
+    uint16_t len;     // header + settings + extras + presence tail
+    uint32_t crc;     // over header (crc = 0) and the rest
+  };
+
+  struct __attribute__((packed)) SnapSetting
+  {
+    uint32_t hash;
+    float value;
+  };
+
+  enum SnapFilterFlag : uint8_t
+  {
+    SNAP_FIL_IIR = 1u << 0,
+    SNAP_FIL_CLIP = 1u << 1,
+    SNAP_FIL_TREM = 1u << 2,
+    SNAP_FIL_SPARK = 1u << 3,
+    SNAP_FIL_COMP = 1u << 4,
+    SNAP_FIL_ENV = 1u << 5,
+    SNAP_FIL_DELAY = 1u << 6,
+    SNAP_FIL_PRESENT = 1u << 7, // sender was built with filters
+  };
+
+  // Composite settings that `cfg export` writes by hand (not in the registry)
+  struct __attribute__((packed)) SnapshotExtras
+  {
+    float bri;
+    uint32_t rampMs;
+    uint32_t idleMs;
+    int16_t touchOn; // 0 = sender has no touch dimming
+    int16_t touchOff;
+    uint64_t quickMask;
+    uint8_t filterFlags; // SnapFilterFlag bits
+    uint8_t clipCurve;
+    uint8_t tremWave;
+    uint8_t reserved;
+    float iirAlpha;
+    float clipAmount;
+    float tremRateHz;
+    float tremDepth;
+    float sparkDensity;
+    float sparkIntensity;
+    uint32_t sparkDecayMs;
+    float compThr;
+    float compRatio;
+    uint32_t compAttackMs;
+    uint32_t compReleaseMs;
+    uint32_t envAttackMs;
+    uint32_t envReleaseMs;
+    uint32_t delayMs;
+    float delayFeedback;
+    float delayMix;
+  };
+
+  String pending; // base64 received via `cfg put`
+  uint32_t pendingLastMs = 0;
+
+  uint32_t snapCrc(const uint8_t *buf, size_t len)
+  {
+    SnapHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    hdr.crc = 0;
+    const uint32_t crc = crc32Update(0, reinterpret_cast<const uint8_t *>(&hdr), sizeof(hdr));
+    return crc32Update(crc, buf + sizeof(hdr), len - sizeof(hdr));
+  }
+
+  float clampf(float v, float lo, float hi)
+  {
+    return v < lo ? lo : (v > hi ? hi : v);
+  }
+
+  uint32_t clampu(uint32_t v, uint32_t lo, uint32_t hi)
+  {
+    return v < lo ? lo : (v > hi ? hi : v);
+  }
+
+  void captureExtras(SnapshotExtras &x)
+  {
+    memset(&x, 0, sizeof(x));
+    x.bri = masterBrightness;
+    x.rampMs = rampDurationMs;
+    x.idleMs = idleOffMs;
+#if ENABLE_TOUCH_DIM
+    x.touchOn = (int16_t)touchDeltaOn;
+    x.touchOff = (int16_t)touchDeltaOff;
+#endif
+    x.quickMask = quickMask;
+#if ENABLE_FILTERS
+    FilterState f;
+    filtersGetState(f);
+    x.filterFlags = SNAP_FIL_PRESENT | (f.iirEnabled ? SNAP_FIL_IIR : 0) | (f.clipEnabled ? SNAP_FIL_CLIP : 0) |
+                    (f.tremEnabled ? SNAP_FIL_TREM : 0) | (f.sparkEnabled ? SNAP_FIL_SPARK : 0) |
+                    (f.compEnabled ? SNAP_FIL_COMP : 0) | (f.envEnabled ? SNAP_FIL_ENV : 0) |
+                    (f.delayEnabled ? SNAP_FIL_DELAY : 0);
+    x.clipCurve = f.clipCurve;
+    x.tremWave = f.tremWave;
+    x.iirAlpha = f.iirAlpha;
+    x.clipAmount = f.clipAmount;
+    x.tremRateHz = f.tremRateHz;
+    x.tremDepth = f.tremDepth;
+    x.sparkDensity = f.sparkDensity;
+    x.sparkIntensity = f.sparkIntensity;
+    x.sparkDecayMs = f.sparkDecayMs;
+    x.compThr = f.compThr;
+    x.compRatio = f.compRatio;
+    x.compAttackMs = f.compAttackMs;
+    x.compReleaseMs = f.compReleaseMs;
+    x.envAttackMs = f.envAttackMs;
+    x.envReleaseMs = f.envReleaseMs;
+    x.delayMs = f.delayMs;
+    x.delayFeedback = f.delayFeedback;
+    x.delayMix = f.delayMix;
+#endif
+  }
+
+  /**
+   * @brief Apply the composite settings with the same ranges as importConfig().
+   */
+  void applyExtras(const SnapshotExtras &x)
+  {
+    if (!isnan(x.bri))
+    {
+      masterBrightness = clamp01(x.bri);
+      lastLoggedBrightness = masterBrightness;
+    }
+    if (x.rampMs >= 50 && x.rampMs <= 10000)
+      rampDurationMs = x.rampMs;
+    idleOffMs = x.idleMs;
+#if ENABLE_TOUCH_DIM
+    if (x.touchOn > 0)
+      touchDeltaOn = x.touchOn;
+    if (x.touchOff > 0)
+      touchDeltaOff = x.touchOff;
+#endif
+    if (x.quickMask != 0)
+    {
+      quickMask = x.quickMask;
+      sanitizeQuickMask();
+    }
+    if (!(x.filterFlags & SNAP_FIL_PRESENT))
+      return;
+    filtersSetIir(x.filterFlags & SNAP_FIL_IIR, clampf(x.iirAlpha, 0.0f, 1.0f));
+    filtersSetClip(x.filterFlags & SNAP_FIL_CLIP, clampf(x.clipAmount, 0.0f, 1.0f), x.clipCurve > 1 ? 0 : x.clipCurve);
+    filtersSetTrem(x.filterFlags & SNAP_FIL_TREM, clampf(x.tremRateHz, 0.05f, 20.0f), clampf(x.tremDepth, 0.0f, 1.0f),
+                   x.tremWave > 1 ? 0 : x.tremWave);
+    filtersSetSpark(x.filterFlags & SNAP_FIL_SPARK, clampf(x.sparkDensity, 0.0f, 20.0f),
+                    clampf(x.sparkIntensity, 0.0f, 1.0f), clampu(x.sparkDecayMs, 10, 5000));
+    filtersSetComp(x.filterFlags & SNAP_FIL_COMP, clampf(x.compThr, 0.0f, 1.2f), clampf(x.compRatio, 1.0f, 10.0f),
+                   clampu(x.compAttackMs, 1, 2000), clampu(x.compReleaseMs, 1, 4000));
+    filtersSetEnv(x.filterFlags & SNAP_FIL_ENV, clampu(x.envAttackMs, 1, 4000), clampu(x.envReleaseMs, 1, 6000));
+    filtersSetDelay(x.filterFlags & SNAP_FIL_DELAY, clampu(x.delayMs, 10, 5000), clampf(x.delayFeedback, 0.0f, 0.95f),
+                    clampf(x.delayMix, 0.0f, 1.0f));
+  }
+
+  void applyPresenceList(const char *csv, size_t len)
+  {
+    presenceClearDevices();
+    size_t start = 0;
+    while (start < len)
+    {
+      size_t end = start;
+      while (end < len && csv[end] != ',')
+        end++;
+      String tok;
+      tok.reserve(end - start);
+      for (size_t i = start; i < end; ++i)
+        tok += csv[i];
+      tok.trim();
+      if (tok.length() > 0)
+        presenceAddDevice(tok);
+      start = end + 1;
+    }
+    presenceAddr = presenceHasDevices() ? presenceDevices.back() : String();
+  }
+} // namespace
+
+void configSnapshotExport()
+{
+  const uint32_t startUs = micros();
+  std::vector<uint8_t> buf(sizeof(SnapHeader));
+  uint8_t count = 0;
+  for (size_t i = 0; i < settingCount(); ++i)
+  {
+    const SettingDef &def = settingAt(i);
+    if (!(def.flags & SETTING_EXPORT))
+      continue;
+    SnapSetting rec = {def.hash, settingValue(def)};
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&rec);
+    buf.insert(buf.end(), p, p + sizeof(rec));
+    count++;
+  }
+  SnapshotExtras extras;
+  captureExtras(extras);
+  const uint8_t *px = reinterpret_cast<const uint8_t *>(&extras);
+  buf.insert(buf.end(), px, px + sizeof(extras));
+  const String presence = presenceListCsv();
+  buf.insert(buf.end(), presence.c_str(), presence.c_str() + presence.length());
+  if (buf.size() > Settings::CFG_SNAPSHOT_MAX_BYTES)
+  {
+    TLOG("[Config] Snapshot too large (%d B)", (int)buf.size());
+    return;
+  }
+
+  SnapHeader hdr = {SNAP_MAGIC, SNAP_VERSION, count, (uint16_t)buf.size(), 0};
+  memcpy(buf.data(), &hdr, sizeof(hdr));
+  hdr.crc = snapCrc(buf.data(), buf.size());
+  memcpy(buf.data(), &hdr, sizeof(hdr));
+
+  String line = F("CFG|");
+  base64Append(line, buf.data(), buf.size());
+  sendFeedback(line);
+  TLOG("[Config] Snapshot %d B, %d keys, %d chars (%lu us)", (int)buf.size(), (int)count, (int)line.length() - 4,
+       (unsigned long)(micros() - startUs));
+}
+
+bool configSnapshotPut(const String &chunk)
+{
+  const uint32_t now = millis();
+  if (pending.length() > 0 && now - pendingLastMs > Settings::CFG_SNAPSHOT_PUT_TIMEOUT_MS)
+    pending = "";
+  pendingLastMs = now;
+  if (chunk.length() == 0 || chunk.length() % 4 != 0 ||
+      pending.length() + chunk.length() > (Settings::CFG_SNAPSHOT_MAX_BYTES + 2) / 3 * 4)
+  {
+    pending = "";
+    return false;
+  }
+  pending += chunk;
+  return true;
+}
+
+bool configSnapshotApply()
+{
+  const uint32_t startUs = micros();
+  std::vector<uint8_t> buf(Settings::CFG_SNAPSHOT_MAX_BYTES);
+  const int len = base64Decode(pending, buf.data(), buf.size());
+  pending = "";
+  SnapHeader hdr;
+  if (len < (int)(sizeof(SnapHeader) + sizeof(SnapshotExtras)))
+  {
+    TLOG("[Config] Snapshot invalid (%s)", "length");
+    return false;
+  }
+  memcpy(&hdr, buf.data(), sizeof(hdr));
+  const size_t settingsEnd = sizeof(SnapHeader) + (size_t)hdr.settings * sizeof(SnapSetting);
+  if (hdr.magic != SNAP_MAGIC || hdr.version != SNAP_VERSION || hdr.len != len ||
+      settingsEnd + sizeof(SnapshotExtras) > (size_t)len)
+  {
+    TLOG("[Config] Snapshot invalid (%s)", "header");
+    return false;
+  }
+  if (hdr.crc != snapCrc(buf.data(), len))
+  {
+    TLOG("[Config] Snapshot invalid (%s)", "crc");
+    return false;
+  }
+
+  // Validate everything first so a bad record leaves the lamp untouched.
+  int skipped = 0;
+  for (size_t pos = sizeof(SnapHeader); pos < settingsEnd; pos += sizeof(SnapSetting))
+  {
+    SnapSetting rec;
+    memcpy(&rec, &buf[pos], sizeof(rec));
+    const SettingDef *def = settingFindHash(rec.hash);
+    if (!def || !(def->flags & SETTING_EXPORT))
+    {
+      skipped++;
+      continue;
+    }
+    if (isnan(rec.value) || (!(def->flags & SETTING_CLAMP) && (rec.value < def->minVal || rec.value > def->maxVal)))
+    {
+      TLOG("[Config] Snapshot invalid (%s)", def->key);
+      return false;
+    }
+  }
+
+  for (size_t pos = sizeof(SnapHeader); pos < settingsEnd; pos += sizeof(SnapSetting))
+  {
+    SnapSetting rec;
+    memcpy(&rec, &buf[pos], sizeof(rec));
+    const SettingDef *def = settingFindHash(rec.hash);
+    if (def && (def->flags & SETTING_EXPORT))
+      settingAssign(*def, rec.value);
+  }
+  SnapshotExtras extras;
+  memcpy(&extras, &buf[settingsEnd], sizeof(extras));
+  applyExtras(extras);
+  const size_t tail = settingsEnd + sizeof(SnapshotExtras);
+  applyPresenceList(reinterpret_cast<const char *>(&buf[tail]), len - tail);
+  sanitizeLinkedSettings();
+  saveSettings();
+  postEvent(EVT_BRIGHTNESS | EVT_STATE, "cfg");
+  TLOG("[Config] Snapshot applied: %d keys, %d skipped (%lu us)", (int)hdr.settings - skipped, skipped,
+       (unsigned long)(micros() - startUs));
+  return true;
+}
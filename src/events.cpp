@@ -0,0 +1,113 @@
+/**
+ * @file events.cpp
+ * @brief Dirty-bit change bus with a single coalescing consumer.
+ */
+
+#include "events.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include "comms.h"
+#include "lamp_state.h"
+#include "pattern.h"
+#include "print.h"
+#include "settings.h"
+
+static portMUX_TYPE eventMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t pendingBits = 0;
+static const char *pendingBrightnessReason = nullptr;
+static const char *pendingLampReason = nullptr;
+static uint32_t pendingFirstMs = 0;
+static uint32_t pendingLastMs = 0;
+
+// Counters (reset with `events reset`)
+static uint32_t eventPostCount = 0;
+static uint32_t eventFlushCount = 0;
+static uint32_t eventLineCount = 0;
+
+void postEvent(uint8_t bits, const char *reason)
+{
+  if (!bits)
+    return;
+  const uint32_t now = millis();
+  portENTER_CRITICAL(&eventMux);
+  if (!pendingBits)
+    pendingFirstMs = now;
+  pendingBits |= bits;
+  pendingLastMs = now;
+  if (reason && (bits & EVT_BRIGHTNESS))
+    pendingBrightnessReason = reason;
+  if (reason && (bits & EVT_LAMP))
+    pendingLampReason = reason;
+  eventPostCount++;
+  portEXIT_CRITICAL(&eventMux);
+}
+
+void dispatchEvents()
+{
+  const uint32_t now = millis();
+  uint8_t bits;
+  const char *briReason;
+  const char *lampReason;
+  bool settled;
+
+  // A STATE line an earlier flush left to the rate limit goes out here
+  if (flushLiveState())
+    eventLineCount++;
+  portENTER_CRITICAL(&eventMux);
+  bits = pendingBits;
+  if (!bits)
+  {
+    portEXIT_CRITICAL(&eventMux);
+    return;
+  }
+  settled = (now - pendingLastMs) >= Settings::EVENT_SETTLE_MS;
+  const bool discrete = (bits & (EVT_LAMP | EVT_PATTERN)) != 0;
+  const bool overdue = (now - pendingFirstMs) >= Settings::EVENT_MAX_DELAY_MS;
+  if (!discrete && !settled && !overdue)
+  {
+    portEXIT_CRITICAL(&eventMux);
+    return;
+  }
+  briReason = pendingBrightnessReason;
+  lampReason = pendingLampReason;
+  pendingLampReason = nullptr;
+  // A brightness change still in motion keeps its log line pending until it
+  // settles; intermediate flushes only refresh the live STATE line.
+  pendingBits = (!settled && (bits & EVT_BRIGHTNESS)) ? EVT_BRIGHTNESS : 0;
+  pendingFirstMs = now;
+  if (!pendingBits)
+    pendingBrightnessReason = nullptr;
+  portEXIT_CRITICAL(&eventMux);
+
+  // Count only lines that went out: a log nobody reads or an unchanged STATE line is not a line.
+  eventFlushCount++;
+  if ((bits & EVT_LAMP) && emitLampStateLog(lampReason))
+    eventLineCount++;
+  if ((bits & EVT_PATTERN) && emitPatternLog())
+    eventLineCount++;
+  if ((bits & EVT_BRIGHTNESS) && settled && emitBrightnessLog(briReason))
+    eventLineCount++;
+  if (queueLiveState())
+    eventLineCount++;
+}
+
+void eventStatsFeedback()
+{
+  String line = F("[Events] posted=");
+  line += String(eventPostCount);
+  line += F(" updates=");
+  line += String(eventFlushCount);
+  line += F(" lines=");
+  line += String(eventLineCount);
+  line += F(" pending=0x");
+  line += String(pendingBits, HEX);
+  sendFeedback(line);
+}
+
+void resetEventStats()
+{
+  eventPostCount = 0;
+  eventFlushCount = 0;
+  eventLineCount = 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file input_events.cpp
+ * @brief GPIO edge interrupts with timestamp debouncing and a per-input queue.
+ */
+
+#include "lamp_config.h"
+
+#include "input_events.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "settings.h"
+#include "pinout.h"
+#include "inputs.h"
+#include "tokenlog.h"
+
+namespace
+{
+  constexpr uint8_t NO_PIN = 0xFF;
+  constexpr uint8_t QUEUE_LEN = 8; // a tap is two edges; the loop drains every pass
+
+  struct QueuedEdge
+  {
+    bool active;
+    bool polled; // found by inputEventNext(), not by the interrupt
+    uint32_t us;
+  };
+
+  struct Source
+  {
+    uint8_t pin;
+    bool activeLow;
+    bool enabled;
+    bool stable;        // debounced level
+    uint32_t acceptUs;  // stamp of the last accepted edge
+    uint32_t debounceUs;
+    QueuedEdge queue[QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+    // Statistics for `gpio`
+    uint32_t edges;
+    uint32_t bounces;
+    uint32_t polled;
+    uint32_t lost;
+    uint32_t latCount;
+    uint32_t latSumUs;
+    uint32_t latMaxUs;
+  };
+
+  Source sources[INPUT_SRC_COUNT] = {
+#if ENABLE_SWITCH
+      {(uint8_t)PIN_SWITCH, SWITCH_ACTIVE_LEVEL == LOW},
+#else
+      {NO_PIN, false},
+#endif
+#if ENABLE_PUSH_BUTTON
+      {(uint8_t)PIN_PUSHBTN, PUSH_ACTIVE_LEVEL == LOW},
+#else
+      {NO_PIN, false},
+#endif
+#if ENABLE_EXT_INPUT
+      {(uint8_t)Settings::EXT_INPUT_PIN, Settings::EXT_INPUT_ACTIVE_LOW},
+#else
+      {NO_PIN, false},
+#endif
+  };
+
+  portMUX_TYPE inputMux = portMUX_INITIALIZER_UNLOCKED;
+  TaskHandle_t loopTask = nullptr;
+
+  bool IRAM_ATTR readActive(const Source &s)
+  {
+    return (digitalRead(s.pin) == HIGH) != s.activeLow;
+  }
+
+  /** @brief Debounce on the stamp and queue the edge; caller holds inputMux. */
+  bool IRAM_ATTR accept(Source &s, bool active, uint32_t us, bool polled)
+  {
+    if (active == s.stable || us - s.acceptUs < s.debounceUs)
+      return false;
+    s.stable = active;
+    s.acceptUs = us;
+    if (s.count == QUEUE_LEN)
+    {
+      // Keep the newest edges; the consumer skips edges that do not change its state.
+      s.head = (uint8_t)((s.head + 1) % QUEUE_LEN);
+      s.count--;
+      s.lost++;
+    }
+    QueuedEdge &q = s.queue[(s.head + s.count) % QUEUE_LEN];
+    q.active = active;
+    q.polled = polled;
+    q.us = us;
+    s.count++;
+    s.edges++;
+    return true;
+  }
+
+#if ENABLE_INPUT_EVENTS
+  void IRAM_ATTR edgeIsr(void *arg)
+  {
+    Source &s = *static_cast<Source *>(arg);
+    const uint32_t us = (uint32_t)esp_timer_get_time();
+    const bool active = readActive(s);
+    portENTER_CRITICAL_ISR(&inputMux);
+    const bool queued = accept(s, active, us, false);
+    if (!queued)
+      s.bounces++;
+    portEXIT_CRITICAL_ISR(&inputMux);
+    if (queued)
+      inputEventsWakeFromIsr();
+  }
+#endif
+} // namespace
+
+void IRAM_ATTR inputEventsWakeFromIsr()
+{
+#if ENABLE_INPUT_EVENTS
+  if (!loopTask)
+    return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loopTask, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+#endif
+}
+
+void inputEventsEnable(InputSource src, bool on, bool active)
+{
+  if (src >= INPUT_SRC_COUNT || sources[src].pin == NO_PIN)
+    return;
+  Source &s = sources[src];
+  if (!loopTask)
+    loopTask = xTaskGetCurrentTaskHandle();
+#if ENABLE_INPUT_EVENTS
+  if (s.enabled && !on)
+    detachInterrupt(s.pin);
+#endif
+  portENTER_CRITICAL(&inputMux);
+  s.stable = active;
+  s.acceptUs = (uint32_t)esp_timer_get_time() - s.debounceUs;
+  s.head = 0;
+  s.count = 0;
+  portEXIT_CRITICAL(&inputMux);
+#if ENABLE_INPUT_EVENTS
+  if (!s.enabled && on)
+    attachInterruptArg(s.pin, edgeIsr, &s, CHANGE);
+#endif
+  s.enabled = on;
+}
+
+bool inputEventNext(InputSource src, uint32_t debounceMs, InputEdge &e)
+{
+  if (src >= INPUT_SRC_COUNT || !sources[src].enabled)
+    return false;
+  Source &s = sources[src];
+  const uint32_t us = (uint32_t)esp_timer_get_time();
+  const bool active = readActive(s);
+  QueuedEdge q;
+  portENTER_CRITICAL(&inputMux);
+  s.debounceUs = debounceMs * 1000UL;
+  // Edges the interrupt missed: during light sleep, or a change back inside the lockout.
+  if (!s.count && accept(s, active, us, true))
+    s.polled++;
+  const bool got = s.count > 0;
+  if (got)
+  {
+    q = s.queue[s.head];
+    s.head = (uint8_t)((s.head + 1) % QUEUE_LEN);
+    s.count--;
+    if (!q.polled)
+    {
+      const uint32_t lat = us - q.us;
+      s.latCount++;
+      s.latSumUs += lat;
+      if (lat > s.latMaxUs)
+        s.latMaxUs = lat;
+    }
+  }
+  portEXIT_CRITICAL(&inputMux);
+  if (!got)
+    return false;
+  e.active = q.active;
+  e.us = q.us;
+  e.ms = millis() - (us - q.us) / 1000UL;
+  return true;
+}
+
+void inputEventsWait(uint32_t ms)
+{
+#if ENABLE_INPUT_EVENTS
+  if (loopTask == xTaskGetCurrentTaskHandle())
+  {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+    return;
+  }
+#endif
+  delay(ms);
+}
+
+void inputEventsFeedback()
+{
+  static const char *const NAMES[INPUT_SRC_COUNT] = {"switch", "push", "ext"};
+  bool any = false;
+  for (uint8_t i = 0; i < INPUT_SRC_COUNT; ++i)
+  {
+    const Source &s = sources[i];
+    if (s.pin == NO_PIN)
+      continue;
+    any = true;
+    if (!s.enabled)
+    {
+      TLOG("[GPIO] %s GPIO%u off", NAMES[i], (unsigned)s.pin);
+      continue;
+    }
+    portENTER_CRITICAL(&inputMux);
+    const Source snap = s;
+    portEXIT_CRITICAL(&inputMux);
+    TLOG("[GPIO] %s GPIO%u %s, %lu edges, %lu bounces, %lu polled, %lu lost", NAMES[i], (unsigned)snap.pin,
+         snap.stable ? "active" : "idle", (unsigned long)snap.edges, (unsigned long)snap.bounces,
+         (unsigned long)snap.polled, (unsigned long)snap.lost);
+#if ENABLE_INPUT_EVENTS
+    TLOG("[GPIO] %s edge to loop: %lu us avg, %lu us max (%lu edges)", NAMES[i],
+         (unsigned long)(snap.latCount ? snap.latSumUs / snap.latCount : 0), (unsigned long)snap.latMaxUs,
+         (unsigned long)snap.latCount);
+#endif
+  }
+  if (!any)
+    TLOG("[GPIO] No digital inputs configured");
+}
@@ -1,3 +1,5 @@
+#include "lamp_config.h"
+
 #include <Arduino.h>
 
 #include "settings.h"
@@ -10,6 +12,12 @@
 #include "pattern.h"
 #include "utils.h"
 #include "sleepwake.h"
+#include "events.h"
+#include "command.h"
+#include "adc_scanner.h"
+#include "input_events.h"
+#include "touch_sensor.h"
+#include "touch_gesture.h"
 
 // Switch handling
 #if ENABLE_SWITCH
@@ -24,25 +32,6 @@ bool modeTapArmed = false;
 #if ENABLE_POTI
 static const float SECURE_POTI_LOW = 0.2f;  // normalized 0..1
 static const float SECURE_POTI_HIGH = 0.8f; // normalized 0..1
-
-static int readPotiMedian()
-{
-    static_assert(Settings::POTI_MEDIAN_SAMPLES > 0 && (Settings::POTI_MEDIAN_SAMPLES % 2) == 1,
-                  "POTI_MEDIAN_SAMPLES must be a positive odd number");
-
-    int samples[Settings::POTI_MEDIAN_SAMPLES];
-    for (uint8_t i = 0; i < Settings::POTI_MEDIAN_SAMPLES; ++i)
-    {
-        samples[i] = analogRead(PIN_POTI);
-        for (uint8_t j = i; j > 0 && samples[j] < samples[j - 1]; --j)
-        {
-            int tmp = samples[j];
-            samples[j] = samples[j - 1];
-            samples[j - 1] = tmp;
-        }
-    }
-    return samples[Settings::POTI_MEDIAN_SAMPLES / 2];
-}
 #endif
 
 uint32_t bootStartMs = 0;
@@ -78,7 +67,7 @@ uint32_t pushHoldLastStepMs = 0;
 extern const int SWITCH_ACTIVE_LEVEL = LOW;
 extern const uint32_t SWITCH_DEBOUNCE_MS = 35;
 extern const uint32_t MODE_TAP_MAX_MS = 600; // max. Dauer für "kurz Aus" (Mode-Wechsel)
-extern const uint32_t TOUCH_DOUBLE_MS = 500; // Touch-Doppeltipp Erkennung
+extern const uint32_t TOUCH_DOUBLE_MS = 300; // max. Pause zwischen Mehrfach-Tipps
 extern const uint32_t SECURE_BOOT_WINDOW_MS = 1000;
 // Number of switch toggles / poti full-swings within the boot window required to
 // trigger a factory reset. Kept high so adjusting the knob right after power-on
@@ -89,8 +78,7 @@ static const int SECURE_BOOT_TOGGLES_REQUIRED = 5;
 // Touch-Schwellwerte-Defaults
 extern const int TOUCH_DELTA_ON_DEFAULT = 12; // Counts relativ zur Baseline
 extern const int TOUCH_DELTA_OFF_DEFAULT = 8; // Hysterese
-extern const uint32_t TOUCH_SAMPLE_DT_MS = 25;
-extern const uint32_t TOUCH_EVENT_DEBOUNCE_MS = 200;
+extern const uint32_t TOUCH_SAMPLE_DT_MS = 10; // = Settings::TOUCH_FILTER_MS
 extern const float DIM_RAMP_STEP = 0.005f;
 extern const uint32_t DIM_RAMP_DT_MS = 80;
 extern const float DIM_MIN = 0.02f;
@@ -99,11 +87,16 @@ extern const float DIM_MAX = 0.95f;
 // Touch sensing state
 int touchBaseline = 0;
 bool touchActive = false;
+int touchLastDelta = 0;
 uint32_t touchLastSampleMs = 0;
 uint32_t touchStartMs = 0;
 uint32_t touchLastRampMs = 0;
 uint32_t lastTouchReleaseMs = 0;
 uint32_t lastTouchChangeMs = 0;
+String touchCmd1 = F("");
+String touchCmd2 = F("next");
+String touchCmd3 = F("");
+static TouchGesture touchGesture;
 bool dimRampUp = true;
 bool brightnessChangedByTouch = false;
 int touchDeltaOn = TOUCH_DELTA_ON_DEFAULT;
@@ -173,23 +166,23 @@ void initSwitchState()
     lastSwitchOffMs = millis();
     lastSwitchOnMs = lampEnabled ? lastSwitchOffMs : 0;
     modeTapArmed = false;
+    inputEventsEnable(INPUT_SRC_SWITCH, true, switchDebouncedState);
 }
 /**
- * @brief Debounce the toggle switch and handle on/off plus mode tap detection.
+ * @brief Handle debounced switch edges (input_events.h): on/off plus mode tap detection.
  */
 void updateSwitchLogic()
 {
-    uint32_t now = millis();
-    bool raw = readSwitchRaw();
-    if (raw != switchRawState)
+    InputEdge edge;
+    while (inputEventNext(INPUT_SRC_SWITCH, SWITCH_DEBOUNCE_MS, edge))
     {
-        switchRawState = raw;
+        // Edge times, not loop times: a mode tap is measured between the real edges.
+        uint32_t now = edge.ms;
+        switchRawState = edge.active;
         switchLastDebounceMs = now;
-    }
-
-    if ((now - switchLastDebounceMs) >= SWITCH_DEBOUNCE_MS && switchDebouncedState != switchRawState)
-    {
-        switchDebouncedState = switchRawState;
+        if (switchDebouncedState == edge.active)
+            continue;
+        switchDebouncedState = edge.active;
         if (switchDebouncedState)
         {
             uint32_t nowOn = now;
@@ -223,7 +216,7 @@ void updateSwitchLogic()
         }
         // Lamp on/off is not persisted; a mode-tap already saves via applyQuickMode(),
         // so avoid an extra NVS write on every toggle to reduce flash wear.
-        lastActivityMs = now;
+        lastActivityMs = millis();
     }
 }
 #endif
@@ -237,16 +230,14 @@ void processStartupSwitch()
         return;
 #if ENABLE_SWITCH
     {
-        uint32_t now = millis();
-        bool raw = readSwitchRaw();
-        if (raw != switchRawState)
+        InputEdge edge;
+        while (inputEventNext(INPUT_SRC_SWITCH, SWITCH_DEBOUNCE_MS, edge))
         {
-            switchRawState = raw;
-            switchLastDebounceMs = now;
-        }
-        if ((now - switchLastDebounceMs) >= SWITCH_DEBOUNCE_MS && switchDebouncedState != switchRawState)
-        {
-            switchDebouncedState = switchRawState;
+            switchRawState = edge.active;
+            switchLastDebounceMs = edge.ms;
+            if (switchDebouncedState == edge.active)
+                continue;
+            switchDebouncedState = edge.active;
             if (!secureBootLatched && !secureBootWindowClosed)
             {
                 secureBootToggleCount++;
@@ -273,7 +264,9 @@ void processStartupSwitch()
     static int lastZone = -1; // -1=unset, 0=low, 1=high
     static uint32_t lastToggleMs = 0;
     uint32_t now = millis();
-    int raw = analogRead(PIN_POTI);
+    int raw = 0;
+    if (!adcScannerRead(ADC_CH_POTI, raw))
+        return;
     float norm = clamp01((float)raw / 4095.0f);
     int zone = -1;
     if (norm <= SECURE_POTI_LOW)
@@ -315,161 +308,125 @@ void processStartupSwitch()
 
 
 /**
- * @brief Measure and store a fresh baseline value for the touch electrode.
+ * @brief Start measuring a fresh baseline for the touch electrode (finishes in the loop).
  */
 void calibrateTouchBaseline()
 {
 #if !ENABLE_TOUCH_DIM
     sendFeedback(F("Touch disabled in build"));
 #else
-    long acc = 0;
-    const int samples = 32;
-    for (int i = 0; i < samples; ++i)
-    {
-        acc += touchRead(PIN_TOUCH_DIM);
-        delay(5);
-    }
-    touchBaseline = (int)(acc / samples);
+    touchCalibStart(false);
 #endif
 }
 
 /**
- * @brief Guided calibration: measure baseline and touched delta to derive thresholds.
+ * @brief Start the guided calibration: baseline and touched delta to derive thresholds (finishes in the loop).
  */
 void calibrateTouchGuided()
 {
 #if !ENABLE_TOUCH_DIM
     sendFeedback(F("Touch disabled in build"));
 #else
-    sendFeedback(F("[Calib] Release electrode for 2s"));
-    delay(200);
-    uint32_t t0 = millis();
-    long accBase = 0;
-    int nBase = 0;
-    while (millis() - t0 < 2000)
-    {
-        accBase += touchRead(PIN_TOUCH_DIM);
-        nBase++;
-        delay(40);
-    }
-    int baseAvg = (nBase > 0) ? (int)(accBase / nBase) : touchBaseline;
-
-    sendFeedback(F("[Calib] Touch and hold for 2s"));
-    delay(200);
-    t0 = millis();
-    long accTouch = 0;
-    int nTouch = 0;
-    int minTouch = 4095;
-    int maxTouch = 0;
-    while (millis() - t0 < 2000)
+    touchCalibStart(true);
+#endif
+}
+
+/**
+ * @brief Run the command bound to @p count taps (`touch 1|2|3 <cmd>`).
+ */
+void executeTouchCommand(uint8_t count)
+{
+#if ENABLE_TOUCH_DIM
+    String cmd = (count == 1) ? touchCmd1 : (count == 2) ? touchCmd2
+                                                         : touchCmd3;
+    cmd.trim();
+    if (cmd.isEmpty())
     {
-        int raw = touchRead(PIN_TOUCH_DIM);
-        accTouch += raw;
-        nTouch++;
-        if (raw < minTouch)
-            minTouch = raw;
-        if (raw > maxTouch)
-            maxTouch = raw;
-        delay(40);
+        sendFeedback(String(F("[Touch] ")) + count + F("x"));
+        return;
     }
-    int touchAvg = (nTouch > 0) ? (int)(accTouch / nTouch) : baseAvg;
-
-    int delta = touchAvg - baseAvg;
-    if (delta < 3)
-        delta = 3;
-    int newOn = delta * 6 / 10; // ~60% of observed delta
-    if (newOn < 4)
-        newOn = 4;
-    if (newOn > 60)
-        newOn = 60;
-    int newOff = newOn * 6 / 10;
-    if (newOff < 2)
-        newOff = 2;
-    if (newOff >= newOn)
-        newOff = newOn - 1;
-
-    touchBaseline = baseAvg;
-    touchDeltaOn = newOn;
-        touchDeltaOff = newOff;
-    saveSettings();
-    sendFeedback(String(F("[Calib] base=")) + String(baseAvg) + F(" touch=") + String(touchAvg) +
-                 F(" delta=") + String(delta) + F(" thrOn=") + String(newOn) + F(" thrOff=") + String(newOff));
+    sendFeedback(String(F("[Touch] ")) + count + F("x -> ") + cmd);
+    if (cmd.startsWith(F("touch ")))
+        return; // avoid rebinding from a gesture
+    handleCommand(cmd);
 #endif
 }
 
 /**
- * @brief Periodically sample the touch sensor to control long-press dimming.
+ * @brief Sample the touch sensor and run gestures: tap bindings and long-press dimming.
  */
 void updateTouchBrightness()
 {
 #if !ENABLE_TOUCH_DIM
     return;
 #else
-    uint32_t now = millis();
-    if (now - touchLastSampleMs < TOUCH_SAMPLE_DT_MS)
+    if (touchCalibUpdate())
         return;
     if (!touchDimEnabled)
         return;
+    uint32_t now = millis();
+    // The threshold interrupt reports a press right away; releases follow the sample grid.
+    const bool irq = touchSensorTakeIrq();
+    if (!irq && now - touchLastSampleMs < TOUCH_SAMPLE_DT_MS)
+        return;
     touchLastSampleMs = now;
 
-    // Take a small moving average to reduce noise
-    int raw = (touchRead(PIN_TOUCH_DIM) + touchRead(PIN_TOUCH_DIM) + touchRead(PIN_TOUCH_DIM)) / 3;
+    // Hardware-filtered count; the baseline follows drift in the filter callback.
+    int raw = touchSensorValue();
     int delta = touchBaseline - raw;
-    int mag = abs(delta);
-
-    if (!touchActive)
+    touchLastDelta = delta;
+
+    TouchGestureConfig cfg;
+    cfg.onDelta = touchDeltaOn;
+    cfg.offDelta = touchDeltaOff;
+    cfg.holdMs = touchHoldStartMs;
+    cfg.tapGapMs = TOUCH_DOUBLE_MS;
+    cfg.maxTaps = !touchCmd3.isEmpty() ? 3 : !touchCmd2.isEmpty() ? 2 : 1;
+    const uint8_t ev = touchGestureFeed(touchGesture, cfg, delta, irq, now);
+    touchActive = touchGesture.pressed;
+
+    if (ev & TG_PRESS)
     {
-        if (mag < touchDeltaOn)
-            touchBaseline = (touchBaseline * 15 + raw) / 16;
-        if (mag > touchDeltaOn && (now - lastTouchChangeMs) >= TOUCH_EVENT_DEBOUNCE_MS)
+        lastActivityMs = now;
+        if (wakeFadeActive && wakeSoftCancel)
         {
-            if (wakeFadeActive && wakeSoftCancel)
-            {
-                cancelWakeFade(true);
-                setLampEnabled(false, "wake soft touch");
-                touchActive = false;
-                return;
-            }
-            touchActive = true;
-            touchStartMs = now;
-            touchLastRampMs = now;
-            brightnessChangedByTouch = false;
-            dimRampUp = (masterBrightness < 0.5f);
-            lastActivityMs = now;
-            sendFeedback(F("[Touch] detected"));
-            if (lastTouchReleaseMs > 0 && (now - lastTouchReleaseMs) <= TOUCH_DOUBLE_MS)
-            {
-                sendFeedback(F("[Touch] double-tap"));
-            }
-            lastTouchChangeMs = now;
+            cancelWakeFade(true);
+            setLampEnabled(false, "wake soft touch");
+            touchGestureIgnorePress(touchGesture);
+            return;
         }
-        return;
+        touchStartMs = now;
+        lastTouchChangeMs = now;
+        sendFeedback(F("[Touch] detected"));
     }
-
-    if (mag < touchDeltaOff)
+    if (ev & TG_HOLD)
+    {
+        touchLastRampMs = now;
+        brightnessChangedByTouch = false;
+        dimRampUp = (masterBrightness < 0.5f);
+    }
+    if (ev & TG_RELEASE)
     {
-        touchActive = false;
-        touchBaseline = (touchBaseline * 7 + raw) / 8;
+        lastTouchReleaseMs = now;
+        lastTouchChangeMs = now;
         if (brightnessChangedByTouch)
         {
             logBrightnessChange("touch");
             saveSettings();
             brightnessChangedByTouch = false;
         }
-        if ((now - lastTouchChangeMs) >= TOUCH_EVENT_DEBOUNCE_MS)
-        {
-            sendFeedback(F("[Touch] release"));
-            lastTouchReleaseMs = now;
-            lastTouchChangeMs = now;
-        }
-        return;
+        sendFeedback(F("[Touch] release"));
     }
+    if (ev & TG_TAPS)
+        executeTouchCommand(touchGesture.taps);
+    if (!touchGesture.holding)
+        return;
 
     if (!lampEnabled)
         return;
 
     // Long hold: ramp brightness up/down between DIM_MIN..DIM_MAX
-    if ((now - touchStartMs) >= touchHoldStartMs && (now - touchLastRampMs) >= DIM_RAMP_DT_MS)
+    if ((now - touchLastRampMs) >= DIM_RAMP_DT_MS)
     {
         touchLastRampMs = now;
         lastActivityMs = now;
@@ -495,21 +452,27 @@ void updateTouchBrightness()
 #if ENABLE_PUSH_BUTTON
 void updatePushButton()
 {
+    static bool eventsOn = false;
+    if (pushEnabled != eventsOn)
+    {
+        // Edges while disabled must not replay as clicks later.
+        eventsOn = pushEnabled;
+        inputEventsEnable(INPUT_SRC_PUSH, pushEnabled, pushDebouncedState);
+    }
     if (!pushEnabled)
         return;
     uint32_t now = millis();
-    bool raw = digitalRead(PIN_PUSHBTN) == PUSH_ACTIVE_LEVEL;
-    if (raw != pushRawState)
-    {
-        pushRawState = raw;
-        pushLastDebounceMs = now;
-    }
-    if ((now - pushLastDebounceMs) >= pushDebounceMs && pushDebouncedState != pushRawState)
+    InputEdge edge;
+    while (inputEventNext(INPUT_SRC_PUSH, pushDebounceMs, edge))
     {
-        pushDebouncedState = pushRawState;
+        pushRawState = edge.active;
+        pushLastDebounceMs = edge.ms;
+        if (pushDebouncedState == edge.active)
+            continue;
+        pushDebouncedState = edge.active;
         if (pushDebouncedState)
         {
-            pushPressMs = now;
+            pushPressMs = edge.ms;
             pushHoldActive = false;
         }
         else
@@ -520,7 +483,7 @@ void updatePushButton()
             }
             else
             {
-                if (pushAwaitDouble && (now - pushLastReleaseMs) <= pushDoubleMs)
+                if (pushAwaitDouble && (edge.ms - pushLastReleaseMs) <= pushDoubleMs)
                 {
                     pushAwaitDouble = false;
                     size_t from = currentModeIndex;
@@ -532,7 +495,7 @@ void updatePushButton()
                 else
                 {
                     pushAwaitDouble = true;
-                    pushLastReleaseMs = now;
+                    pushLastReleaseMs = edge.ms;
                 }
             }
         }
@@ -581,7 +544,9 @@ void updatePoti()
         return;
     lastPotiSampleMs = now;
 
-    int raw = readPotiMedian();
+    int raw = 0;
+    if (!adcScannerRead(ADC_CH_POTI, raw))
+        return;
     potiLastRaw = raw;
     float levelRaw = (float)raw / 4095.0f;
     float minCal = potiCalibMin;
@@ -622,7 +587,7 @@ void updatePoti()
         setLampEnabled(true, "poti", true);
     potiWasBelowOff = nowBelow;
     potiLastApplied = potiFiltered;
-    queueLiveState();
+    postEvent(EVT_STATE);
     // Fast, non-persisted updates for smooth knob response (no flash wear).
     setBrightnessPercent(target * 100.0f, false, false, true);
 }
@@ -631,6 +596,15 @@ void updatePoti()
 #if ENABLE_EXT_INPUT
 void updateExternalInput()
 {
+    static bool eventsOn = false;
+    const bool digital = extInputEnabled && !extInputAnalog;
+    if (digital != eventsOn)
+    {
+        // No edge interrupts on an analog signal.
+        eventsOn = digital;
+        const bool active = Settings::EXT_INPUT_ACTIVE_LOW ? !extInputLastDigital : extInputLastDigital;
+        inputEventsEnable(INPUT_SRC_EXT, digital, active);
+    }
     if (!extInputEnabled)
         return;
     uint32_t now = millis();
@@ -639,7 +613,9 @@ void updateExternalInput()
         if (now - extInputLastSampleMs < Settings::EXT_INPUT_SAMPLE_MS)
             return;
         extInputLastSampleMs = now;
-        int raw = analogRead(Settings::EXT_INPUT_PIN);
+        int raw = 0;
+        if (!adcScannerRead(ADC_CH_EXT, raw))
+            return;
         float norm = (float)raw / 4095.0f;
         if (norm < 0.0f)
             norm = 0.0f;
@@ -659,11 +635,14 @@ void updateExternalInput()
     }
     else
     {
-        bool level = digitalRead(Settings::EXT_INPUT_PIN) == HIGH;
-        if (level != extInputLastDigital)
+        InputEdge edge;
+        while (inputEventNext(INPUT_SRC_EXT, Settings::EXT_INPUT_DEBOUNCE_MS, edge))
         {
+            bool active = edge.active;
+            bool level = Settings::EXT_INPUT_ACTIVE_LOW ? !active : active;
+            if (level == extInputLastDigital)
+                continue;
             extInputLastDigital = level;
-            bool active = Settings::EXT_INPUT_ACTIVE_LOW ? !level : level;
             setLampEnabled(active, "ext-digital");
             sendFeedback(String(F("[Ext] Digital ")) + (active ? F("ON") : F("OFF")));
         }
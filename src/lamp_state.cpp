@@ -10,7 +10,10 @@
 #include "persistence.h"
 #include "pattern.h"
 #include "inputs.h"
+#include "events.h"
 #include "print.h"
+#include "log_sink.h"
+#include "boot_profile.h"
 #include <string.h>
 
 // ---------- Output driver (PWM or DAC) ----------
@@ -35,6 +38,8 @@ const uint32_t OFF_RAW = PWM_INVERT_OUTPUT ? (uint32_t)PWM_MAX : 0;
 
 static inline void writeOutputRaw(uint32_t value)
 {
+  if (value != OFF_RAW)
+    bootMarkLight();
 #if ENABLE_ANALOG_OUTPUT
   if (value > (uint32_t)PWM_MAX)
     value = (uint32_t)PWM_MAX;
@@ -121,32 +126,57 @@ void applyPwmLevel(float normalized)
 }
 
 /**
- * @brief Log current brightness if changed since last log.
+ * @brief Report a brightness change; the event bus coalesces and logs it.
  */
 void logBrightnessChange(const char *reason)
+{
+  postEvent(EVT_BRIGHTNESS, reason);
+}
+
+/**
+ * @brief Log current brightness if changed since last log (event consumer side).
+ * @return True if a line was emitted.
+ */
+bool emitBrightnessLog(const char *reason)
 {
   if (fabs(masterBrightness - lastLoggedBrightness) < 0.001f)
-    return;
+    return false;
   lastLoggedBrightness = masterBrightness;
-  float perc = clamp01(masterBrightness) * 100.0f;
-  String msg = String(F("[Brightness] ")) + String(perc, 1) + F(" %");
-  if (reason && reason[0] != '\0')
+  const bool wanted = feedbackWanted(FeedbackTopic::Log);
+  if (wanted)
   {
-    msg += F(" (");
-    msg += reason;
-    msg += F(")");
+    float perc = clamp01(masterBrightness) * 100.0f;
+    String msg = String(F("[Brightness] ")) + String(perc, 1) + F(" %");
+    if (reason && reason[0] != '\0')
+    {
+      msg += F(" (");
+      msg += reason;
+      msg += F(")");
+    }
+    sendFeedback(msg);
   }
-  sendFeedback(msg);
-  queueLiveState();
 #if DEBUG_BRIGHTNESS_LOG
-  Serial.print(F("[DBG] masterBrightness="));
-  Serial.println(masterBrightness, 4);
+  LOG_D(String(F("[DBG] masterBrightness=")) + String(masterBrightness, 4));
 #endif
+  return wanted;
 }
 
 void logLampState(const char *reason)
 {
   bool forceSerial = (reason && (strstr(reason, "init") != nullptr || strstr(reason, "startup") != nullptr));
+  if (!forceSerial)
+  {
+    postEvent(EVT_LAMP, reason);
+    return;
+  }
+  emitLampStateLog(reason, true);
+  queueLiveState(true);
+}
+
+bool emitLampStateLog(const char *reason, bool force)
+{
+  if (!feedbackWanted(FeedbackTopic::Log, force))
+    return false;
   String msg = String(F("[Lamp] ")) + (lampOffPending ? F("OFF-PEND") : (lampEnabled ? F("ON") : F("OFF")));
   if (reason && reason[0] != '\0')
   {
@@ -154,8 +184,8 @@ void logLampState(const char *reason)
     msg += reason;
     msg += F(")");
   }
-  sendFeedback(msg, forceSerial);
-  queueLiveState(forceSerial);
+  sendFeedback(msg, force);
+  return true;
 }
 
 static float applyEase(float t, uint8_t type, float power)
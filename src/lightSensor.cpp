@@ -3,20 +3,233 @@
 #include "settings.h"
 #include "utils.h"
 #include "lamp_state.h"
+#include "adc_scanner.h"
+#include "lightSensor.h"
+#include "persistence.h"
+#include "comms.h"
 
 #if ENABLE_LIGHT_SENSOR
 bool lightSensorEnabled = Settings::LIGHT_SENSOR_DEFAULT_ENABLED;
 float lightFiltered = 0.0f;
+uint16_t lightLastRaw = 0;
 uint32_t lastLightSampleMs = 0;
 uint16_t lightMinRaw = 4095;
 uint16_t lightMaxRaw = 0;
 float lightAlpha = Settings::LIGHT_ALPHA;
+float lightSelfGain = 0.0f;
+float lightSelfWeight = 0.0f;
 float rampAmbientFactor = Settings::RAMP_AMBIENT_FACTOR_DEFAULT;
 #endif
 float lightGain = Settings::LIGHT_GAIN_DEFAULT;
 float lightClampMin = Settings::LIGHT_CLAMP_MIN_DEFAULT;
 float lightClampMax = Settings::LIGHT_CLAMP_MAX_DEFAULT;
 
+#if ENABLE_LIGHT_SENSOR
+namespace
+{
+    // Sliding-window min/max over the bucket means of the last LIGHT_RANGE_BUCKETS buckets:
+    // one monotonic deque each, so adding a bucket and reading the extremes is O(1) amortized.
+    struct RangeEntry
+    {
+        uint16_t bucket; // bucket sequence number (wraps; only differences are used)
+        uint16_t value;
+    };
+
+    struct RangeDeque
+    {
+        RangeEntry ring[Settings::LIGHT_RANGE_BUCKETS + 1];
+        uint16_t head;
+        uint16_t count;
+
+        RangeEntry &at(uint16_t i) { return ring[(head + i) % (Settings::LIGHT_RANGE_BUCKETS + 1)]; }
+        RangeEntry &front() { return at(0); }
+        RangeEntry &back() { return at(count - 1); }
+        void popFront()
+        {
+            head = (head + 1) % (Settings::LIGHT_RANGE_BUCKETS + 1);
+            count--;
+        }
+
+        /** @brief Append; drops entries @p dominated by the new value first (never extremes again). */
+        template <typename Dominated>
+        void push(uint16_t bucket, uint16_t value, Dominated dominated)
+        {
+            while (count && dominated(back().value, value))
+                count--;
+            if (count == Settings::LIGHT_RANGE_BUCKETS + 1)
+                popFront();
+            count++;
+            back() = {bucket, value};
+        }
+
+        void expire(uint16_t bucket)
+        {
+            while (count && (uint16_t)(bucket - front().bucket) >= Settings::LIGHT_RANGE_BUCKETS)
+                popFront();
+        }
+    };
+
+    RangeDeque rangeMin;
+    RangeDeque rangeMax;
+    uint16_t bucketSeq = 0;
+    uint32_t bucketStartMs = 0;
+    uint32_t bucketSum = 0;
+    uint16_t bucketCount = 0;
+    bool rangeStarted = false;
+    uint16_t savedMinRaw = 4095;
+    uint16_t savedMaxRaw = 0;
+    float savedSelfGain = 0.0f;
+    uint32_t lastRangeSaveMs = 0;
+
+    // Self-illumination model raw = ambient + lightSelfGain * duty, fitted by least squares on
+    // (duty step, raw step) pairs between two steady outputs. A step is short enough that the
+    // ambient light rarely moves with it; the few that do are averaged out.
+    float selfSxy = 0.0f;
+    float prevDuty = -1.0f;
+    uint32_t dutySinceMs = 0;
+    float anchorDuty = -1.0f;
+    int anchorRaw = 0;
+    uint32_t anchorMs = 0;
+    uint32_t selfObservations = 0;
+
+    /** @brief Share of the period the light is on (0..1), independent of output inversion. */
+    float outputDuty()
+    {
+        const uint32_t on = OFF_RAW ? (uint32_t)PWM_MAX - lastPwmValue : lastPwmValue;
+        return PWM_MAX > 0 ? (float)on / (float)PWM_MAX : 0.0f;
+    }
+
+    void selfLearn(float duty, int raw, uint32_t now)
+    {
+        // Steady = same duty for LIGHT_SELF_SETTLE_MS: one sample is not enough, the ADC
+        // scanner's IIR is only 68-90 % settled 200 ms after a step while audio capture runs.
+        if (prevDuty < 0.0f || fabsf(duty - prevDuty) >= 0.005f)
+        {
+            prevDuty = duty;
+            dutySinceMs = now;
+            return;
+        }
+        if (now - dutySinceMs < Settings::LIGHT_SELF_SETTLE_MS)
+            return;
+        const float dP = duty - anchorDuty;
+        if (anchorDuty >= 0.0f && fabsf(dP) >= Settings::LIGHT_SELF_MIN_STEP &&
+            now - anchorMs <= Settings::LIGHT_SELF_MAX_GAP_MS)
+        {
+            float dR = (float)(raw - anchorRaw);
+            if (lightSelfWeight >= Settings::LIGHT_SELF_MIN_WEIGHT)
+            {
+                // Clip the residual: a room light switched together with the lamp moves the model, but not all the way.
+                const float expect = lightSelfGain * dP;
+                const float tol = 0.5f * fabsf(expect) + 20.0f;
+                dR = constrain(dR, expect - tol, expect + tol);
+            }
+            selfSxy = selfSxy * Settings::LIGHT_SELF_DECAY + dP * dR;
+            lightSelfWeight = lightSelfWeight * Settings::LIGHT_SELF_DECAY + dP * dP;
+            lightSelfGain = selfSxy / lightSelfWeight;
+            selfObservations++;
+        }
+        anchorDuty = duty;
+        anchorRaw = raw;
+        anchorMs = now;
+    }
+
+    void rangePush(uint16_t min, uint16_t max)
+    {
+        rangeMin.push(bucketSeq, min, [](uint16_t old, uint16_t v) { return old >= v; });
+        rangeMax.push(bucketSeq, max, [](uint16_t old, uint16_t v) { return old <= v; });
+    }
+
+    /** @brief Publish the window extremes as lightMinRaw/lightMaxRaw. */
+    void rangePublish()
+    {
+        if (rangeMin.count)
+        {
+            lightMinRaw = rangeMin.front().value;
+            lightMaxRaw = rangeMax.front().value;
+        }
+        else if (bucketCount)
+        {
+            // Nothing learned yet: the running bucket, still short and easily skewed by one spike.
+            lightMinRaw = lightMaxRaw = (uint16_t)(bucketSum / bucketCount);
+        }
+    }
+
+    void rangeAdd(int raw, uint32_t now)
+    {
+        const uint32_t elapsed = now - bucketStartMs;
+        if (elapsed >= Settings::LIGHT_RANGE_BUCKET_MS)
+        {
+            const uint32_t steps = elapsed / Settings::LIGHT_RANGE_BUCKET_MS;
+            if (bucketCount)
+            {
+                const uint16_t mean = (uint16_t)(bucketSum / bucketCount);
+                rangePush(mean, mean);
+            }
+            // Sensor off for longer than the window: everything in it is stale.
+            if (steps >= Settings::LIGHT_RANGE_BUCKETS)
+                rangeMin.count = rangeMax.count = 0;
+            bucketSeq += (uint16_t)(steps < Settings::LIGHT_RANGE_BUCKETS ? steps : Settings::LIGHT_RANGE_BUCKETS);
+            bucketStartMs += steps * Settings::LIGHT_RANGE_BUCKET_MS;
+            bucketSum = 0;
+            bucketCount = 0;
+            rangeMin.expire(bucketSeq);
+            rangeMax.expire(bucketSeq);
+        }
+        bucketSum += (uint32_t)raw;
+        bucketCount++;
+        rangePublish();
+    }
+
+    /** @brief Save the learned range and model when they moved noticeably, at most every LIGHT_RANGE_SAVE_MS. */
+    void rangeMaybeSave(uint32_t now)
+    {
+        if (now - lastRangeSaveMs < Settings::LIGHT_RANGE_SAVE_MS)
+            return;
+        if (abs((int)lightMinRaw - (int)savedMinRaw) < Settings::LIGHT_RANGE_SAVE_DELTA &&
+            abs((int)lightMaxRaw - (int)savedMaxRaw) < Settings::LIGHT_RANGE_SAVE_DELTA &&
+            fabsf(lightSelfGain - savedSelfGain) < (float)Settings::LIGHT_RANGE_SAVE_DELTA)
+            return;
+        lastRangeSaveMs = now;
+        savedMinRaw = lightMinRaw;
+        savedMaxRaw = lightMaxRaw;
+        savedSelfGain = lightSelfGain;
+        saveSettings();
+    }
+} // namespace
+
+void lightRangeRestart()
+{
+    rangeMin.count = rangeMax.count = 0;
+    bucketSum = 0;
+    bucketCount = 0;
+    bucketStartMs = millis();
+    lastRangeSaveMs = bucketStartMs;
+    rangeStarted = true;
+    savedMinRaw = lightMinRaw;
+    savedMaxRaw = lightMaxRaw;
+    savedSelfGain = lightSelfGain;
+    // The seed is one ordinary bucket: it ages out of the window like measured ones.
+    if (lightMinRaw <= lightMaxRaw)
+        rangePush(lightMinRaw, lightMaxRaw);
+}
+
+void lightSelfModelRestore(float gain)
+{
+    // A restored model counts as just trusted: new steps refine it, a moved lamp overrides it soon.
+    lightSelfGain = gain;
+    lightSelfWeight = gain != 0.0f ? Settings::LIGHT_SELF_MIN_WEIGHT : 0.0f;
+    selfSxy = gain * lightSelfWeight;
+    savedSelfGain = gain;
+}
+
+void lightSelfFeedback()
+{
+    sendFeedback(String(F("[Light] self=")) + String(lightSelfGain, 1) + F(" counts/duty weight=") +
+                 String(lightSelfWeight, 2) + (lightSelfWeight >= Settings::LIGHT_SELF_MIN_WEIGHT ? F(" trusted") : F(" learning")) +
+                 F(" steps=") + String(selfObservations) + F(" duty=") + String(outputDuty(), 2));
+}
+#endif
+
 
 void updateLightSensor()
 {
@@ -31,20 +244,29 @@ void updateLightSensor()
     if (now - lastLightSampleMs < Settings::LIGHT_SAMPLE_MS)
         return;
     lastLightSampleMs = now;
-    int raw = analogRead(Settings::LIGHT_PIN);
+    int raw = 0;
+    if (!adcScannerRead(ADC_CH_LIGHT, raw))
+        return;
+    lightLastRaw = (uint16_t)constrain(raw, 0, 4095);
+    // Subtract the lamp's own light so ambientScale does not feed back into the output.
+    const float duty = outputDuty();
+    selfLearn(duty, raw, now);
+    const bool selfTrusted = lightSelfWeight >= Settings::LIGHT_SELF_MIN_WEIGHT;
+    if (selfTrusted)
+        raw = constrain(raw - (int)lroundf(lightSelfGain * duty), 0, 4095);
     float a = clamp01(lightAlpha);
     lightFiltered = (1.0f - a) * lightFiltered + a * (float)raw;
-    if (raw < (int)lightMinRaw)
-        lightMinRaw = raw;
-    if (raw > (int)lightMaxRaw)
-        lightMaxRaw = raw;
+    if (!rangeStarted)
+        lightRangeRestart();
+    rangeAdd(raw, now);
+    rangeMaybeSave(now);
 
     int range = (int)lightMaxRaw - (int)lightMinRaw;
     // Fallback: if we do not yet have a stable min/max span (very little variation),
     // derive a normalized level directly from the raw ADC reading so that
     // rampAmbientFactor still has an effect instead of staying at 1.0.
     float norm = 0.5f;
-    if (range >= 20)
+    if (range >= Settings::LIGHT_RANGE_MIN_SPAN)
     {
         norm = ((float)lightFiltered - (float)lightMinRaw) / (float)range;
         norm = clamp01(norm);
@@ -60,9 +282,10 @@ void updateLightSensor()
     if (target > lightClampMax)
         target = lightClampMax;
     target = clamp01(target);
-    const float blend = 0.02f; // slow IIR for ambience
+    // Without the model the lamp sees its own light: only a slow, step-capped follow keeps that loop from oscillating.
+    const float blend = selfTrusted ? Settings::LIGHT_AMBIENT_BLEND_FAST : Settings::LIGHT_AMBIENT_BLEND;
     float next = ambientScale + (target - ambientScale) * blend;
-    const float maxStep = 0.005f; // cap per update to hide sudden jumps (per sample)
+    const float maxStep = selfTrusted ? Settings::LIGHT_AMBIENT_STEP_FAST : Settings::LIGHT_AMBIENT_STEP;
     float delta = next - ambientScale;
     if (delta > maxStep)
         next = ambientScale + maxStep;
@@ -0,0 +1,244 @@
+/**
+ * @file log_sink.cpp
+ * @brief Byte rings per output sink plus a background drain task.
+ *
+ * Producers (loop task, BLE callback task) only take the ring lock to reserve
+ * space and to publish it; the copy runs outside it. The drain task never
+ * takes that lock and the producers never wait for the UART/SPP.
+ */
+
+#include "log_sink.h"
+
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "lamp_config.h"
+#include "comms.h"
+
+#if ENABLE_BT_SERIAL
+#include <BluetoothSerial.h>
+extern BluetoothSerial serialBt; // owned by comms.cpp
+#endif
+
+uint8_t logRuntimeLevel = LOG_LEVEL;
+
+namespace
+{
+  struct LogRing
+  {
+    uint8_t *buf;
+    uint32_t size; // power of two
+    std::atomic<uint32_t> head{0}; // total bytes published: readable by the drain task
+    std::atomic<uint32_t> tail{0}; // total bytes drained (drain task)
+    uint32_t reserved = 0;         // total bytes handed to producers (under mux)
+    uint8_t writers = 0;           // producers copying into reserved space (under mux)
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t lines = 0;
+    uint32_t dropLines = 0;
+    uint32_t dropBytes = 0;
+    uint32_t highWater = 0;
+  };
+
+  uint8_t usbRingBuf[Settings::LOG_USB_RING_BYTES];
+#if ENABLE_BT_SERIAL
+  uint8_t btRingBuf[Settings::LOG_BT_RING_BYTES];
+#endif
+  LogRing rings[LOG_SINK_COUNT];
+  TaskHandle_t drainTask = nullptr;
+  const char *const SINK_NAMES[LOG_SINK_COUNT] = {"usb", "bt"};
+
+  static_assert((Settings::LOG_USB_RING_BYTES & (Settings::LOG_USB_RING_BYTES - 1)) == 0, "ring size must be a power of two");
+  static_assert((Settings::LOG_BT_RING_BYTES & (Settings::LOG_BT_RING_BYTES - 1)) == 0, "ring size must be a power of two");
+
+  /**
+   * @brief Copy @p len bytes to ring position @p pos (one memcpy, two across the wrap).
+   */
+  void ringCopy(LogRing &r, uint32_t pos, const void *data, size_t len)
+  {
+    const uint32_t offset = pos & (r.size - 1);
+    const size_t first = len < r.size - offset ? len : r.size - offset;
+    memcpy(r.buf + offset, data, first);
+    memcpy(r.buf, (const uint8_t *)data + first, len - first);
+  }
+
+  bool ringPush(LogRing &r, const char *data, size_t len)
+  {
+    const uint32_t need = (uint32_t)len + 2;
+    if (!r.buf)
+      return false;
+    // Reserve under the lock, copy without it, publish under it. head only moves once no producer is mid-copy,
+    // so the drain task never sees a reserved but unwritten byte; nobody spins on another producer.
+    portENTER_CRITICAL(&r.mux);
+    const uint32_t start = r.reserved;
+    const uint32_t used = start - r.tail.load(std::memory_order_acquire);
+    if (need > r.size - used)
+    {
+      r.dropLines++;
+      r.dropBytes += need;
+      portEXIT_CRITICAL(&r.mux);
+      return false;
+    }
+    r.reserved = start + need;
+    r.writers++;
+    r.lines++;
+    if (used + need > r.highWater)
+      r.highWater = used + need;
+    portEXIT_CRITICAL(&r.mux);
+
+    ringCopy(r, start, data, len);
+    ringCopy(r, start + (uint32_t)len, "\r\n", 2);
+
+    portENTER_CRITICAL(&r.mux);
+    if (--r.writers == 0)
+      r.head.store(r.reserved, std::memory_order_release);
+    portEXIT_CRITICAL(&r.mux);
+    return true;
+  }
+
+  /**
+   * @brief Contiguous readable region of the ring (up to the wrap point).
+   */
+  size_t ringPeek(LogRing &r, const uint8_t *&ptr)
+  {
+    const uint32_t tail = r.tail.load(std::memory_order_relaxed);
+    const uint32_t avail = r.head.load(std::memory_order_acquire) - tail;
+    const uint32_t offset = tail & (r.size - 1);
+    ptr = r.buf + offset;
+    const uint32_t toEnd = r.size - offset;
+    return avail < toEnd ? avail : toEnd;
+  }
+
+  void ringConsume(LogRing &r, size_t n)
+  {
+    r.tail.fetch_add((uint32_t)n, std::memory_order_release);
+  }
+
+  /**
+   * @brief Move as much as the UART accepts right now; true if data remains.
+   */
+  bool drainUsb()
+  {
+    LogRing &r = rings[LOG_SINK_USB];
+    const uint8_t *ptr = nullptr;
+    size_t n = ringPeek(r, ptr);
+    if (n == 0)
+      return false;
+    int room = Serial.availableForWrite();
+    if (room <= 0)
+      return true;
+    if (n > (size_t)room)
+      n = (size_t)room;
+    n = Serial.write(ptr, n);
+    ringConsume(r, n);
+    return true;
+  }
+
+#if ENABLE_BT_SERIAL
+  bool drainBt()
+  {
+    LogRing &r = rings[LOG_SINK_BT];
+    const uint8_t *ptr = nullptr;
+    size_t n = ringPeek(r, ptr);
+    if (n == 0)
+      return false;
+    if (!communicationsReady() || !serialBt.hasClient())
+    {
+      // Nobody listening (or BT not started yet): do not replay a stale backlog on the next connect.
+      r.tail.store(r.head.load(std::memory_order_acquire), std::memory_order_release);
+      return false;
+    }
+    if (n > 256)
+      n = 256;
+    n = serialBt.write(ptr, n);
+    ringConsume(r, n);
+    return true;
+  }
+#endif
+
+  void drainAll(bool &pending)
+  {
+    pending = drainUsb();
+#if ENABLE_BT_SERIAL
+    pending = drainBt() || pending;
+#endif
+  }
+
+  void logDrainTask(void *)
+  {
+    for (;;)
+    {
+      bool pending = false;
+      drainAll(pending);
+      // Producers notify on every line; poll quickly while the UART is backed up.
+      ulTaskNotifyTake(pdTRUE, pending ? pdMS_TO_TICKS(2) : pdMS_TO_TICKS(50));
+    }
+  }
+} // namespace
+
+void logSinkBegin()
+{
+  rings[LOG_SINK_USB].buf = usbRingBuf;
+  rings[LOG_SINK_USB].size = Settings::LOG_USB_RING_BYTES;
+#if ENABLE_BT_SERIAL
+  rings[LOG_SINK_BT].buf = btRingBuf;
+  rings[LOG_SINK_BT].size = Settings::LOG_BT_RING_BYTES;
+#endif
+  if (!drainTask)
+    xTaskCreatePinnedToCore(logDrainTask, "logdrain", 3072, nullptr, 1, &drainTask, 0);
+}
+
+bool logSinkWrite(uint8_t sink, const String &line)
+{
+  if (sink >= LOG_SINK_COUNT)
+    return false;
+  if (!drainTask)
+  {
+    // Before logSinkBegin() (or if the task failed): fall back to blocking writes.
+    if (sink == LOG_SINK_USB)
+      Serial.println(line);
+#if ENABLE_BT_SERIAL
+    else if (communicationsReady() && serialBt.hasClient())
+      serialBt.println(line);
+#endif
+    return true;
+  }
+  const bool ok = ringPush(rings[sink], line.c_str(), line.length());
+  if (ok)
+    xTaskNotifyGive(drainTask);
+  return ok;
+}
+
+void logWrite(uint8_t level, const String &line)
+{
+  if (level > logRuntimeLevel)
+    return;
+  logSinkWrite(LOG_SINK_USB, line);
+}
+
+void logSinkStatsFeedback()
+{
+  String line = F("[Log] level=");
+  line += String(logRuntimeLevel);
+  line += '/';
+  line += String(LOG_LEVEL);
+  for (uint8_t s = 0; s < LOG_SINK_COUNT; ++s)
+  {
+    const LogRing &r = rings[s];
+    if (!r.buf)
+      continue;
+    line += ' ';
+    line += SINK_NAMES[s];
+    line += F(" lines=");
+    line += String(r.lines);
+    line += F(" drop=");
+    line += String(r.dropLines);
+    line += '/';
+    line += String(r.dropBytes);
+    line += F("B hi=");
+    line += String(r.highWater);
+    line += '/';
+    line += String(r.size);
+  }
+  sendFeedback(line);
+}
@@ -28,12 +28,18 @@
 #include "lightSensor.h"
 #include "microphone.h"
 #include "inputs.h"
+#include "input_events.h"
 #include "presence.h"
 #include "quickmode.h"
 #include "sleepwake.h"
 #include "notifications.h"
 #include "pattern.h"
 #include "demo.h"
+#include "events.h"
+#include "telemetry.h"
+#include "log_sink.h"
+#include "rtc_state.h"
+#include "boot_profile.h"
 
 #if ENABLE_BLE
 #include <BLEDevice.h>
@@ -108,6 +114,9 @@ void updatePatternEngine()
     if (lastBleAddr.length() == 0)
       lastBleAddr = getLastBleAddr();
   }
+  const bool targetLinked = presenceEnabled && anyClient && lastBleAddr.length() > 0 && presenceIsTarget(lastBleAddr);
+  // Runs (and stops) the background scan; it stays off while a listed device is connected.
+  const bool scanDetected = presenceScanUpdate(targetLinked);
   if (presenceEnabled && presenceHasDevices())
   {
     uint32_t nowMs = millis();
@@ -115,7 +124,7 @@ void updatePatternEngine()
     bool detected = false;
 
     // Connected client counts if it matches one of the targets
-    if (anyClient && lastBleAddr.length() > 0 && presenceIsTarget(lastBleAddr))
+    if (targetLinked)
     {
       detected = true;
       lastPresenceSeenMs = nowMs;
@@ -128,15 +137,11 @@ void updatePatternEngine()
       lastPresenceSeenMs = nowMs;
     }
 
-    // occasionally try to spot the target via scan
-    const uint32_t SCAN_INTERVAL_MS = 25000;
-    if (!detected && nowMs - lastPresenceScanMs >= SCAN_INTERVAL_MS)
+    // advertisements seen by the background scan
+    if (scanDetected)
     {
-      lastPresenceScanMs = nowMs;
-      if (presenceScanOnce())
-      {
-        detected = true;
-      }
+      detected = true;
+      lastPresenceSeenMs = nowMs;
     }
 
     if (lastPresenceSeenMs > 0 && (nowMs - lastPresenceSeenMs) <= presenceGraceMs)
@@ -252,6 +257,7 @@ void updatePatternEngine()
   if (adjusted > 1.0f)
     adjusted = 1.0f;
   relative = adjusted;
+  patternRelativeLevel = relative;
   float combined = lampEnabled ? relative * masterBrightness * ambientScale * outputScale : 0.0f;
 
   // Notifications: ignore pattern; use brightness+ambient only with a floor.
@@ -383,23 +389,46 @@ void maybeLightSleep()
 #endif
 }
 
+#if ENABLE_FAST_BOOT
+/**
+ * @brief Fast boot: radio start-up while the loop already drives the lamp.
+ *
+ * Until it finishes, communicationsReady() is false and feedback goes to USB only.
+ */
+static void bootTask(void *)
+{
+  setupCommunications();
+  bootMark("radios");
+  vTaskDelete(nullptr);
+}
+#endif
+
 // ---------- Setup / Loop ----------
 /**
  * @brief Arduino setup hook: configure IO, restore state, start comms.
  */
 void setup()
 {
-  pinMode(PIN_OUTPUT, OUTPUT);
+  bootMark("setup");
+  // Warm reset (brownout/watchdog/panic): drive the last output before anything else.
+  const bool warmBoot = rtcStateRestoreOutput();
+  if (!warmBoot)
+  {
+    pinMode(PIN_OUTPUT, OUTPUT);
 #if ENABLE_ANALOG_OUTPUT
-  dacWrite(PIN_OUTPUT, OFF_RAW); // explicit off for analog driver
+    dacWrite(PIN_OUTPUT, OFF_RAW); // explicit off for analog driver
 #else
-  digitalWrite(PIN_OUTPUT, LOW); // keep LED off during init
+    digitalWrite(PIN_OUTPUT, LOW); // keep LED off during init
 #endif
+  }
 
   Serial.begin(115200);
-  delay(200);
-  Serial.println();
-  Serial.println(F("Quarzlampe PWM-Demo"));
+  if (!warmBoot && !ENABLE_FAST_BOOT)
+    delay(200);
+  bootMark("serial");
+  logSinkBegin();
+  LOG_I(F(""));
+  LOG_I(F("Quarzlampe PWM-Demo"));
   ensureBaseMac();
   // Allow secure-boot window via switch or poti
 #if ENABLE_SWITCH || ENABLE_POTI
@@ -408,13 +437,20 @@ void setup()
   secureBootLatched = false;
   secureBootWindowClosed = false;
   startupHoldActive = true;
+  if (warmBoot)
+  {
+    // The secure-boot window is for deliberate power cycles only.
+    secureBootWindowClosed = true;
+    startupHoldActive = false;
+  }
 #endif
 
 #if ENABLE_SWITCH
   pinMode(PIN_SWITCH, INPUT_PULLUP);
 #endif
 #if ENABLE_TOUCH_DIM
-  calibrateTouchBaseline();
+  calibrateTouchBaseline(); // only starts the measurement; the loop finishes it, touch waits until then
+  bootMark("touch");
 #endif
 
 #if ENABLE_LIGHT_SENSOR || ENABLE_POTI || ENABLE_MUSIC_MODE || ENABLE_EXT_INPUT
@@ -449,25 +485,45 @@ void setup()
 
   loadSettings();
   trustSetBootMs(millis());
+  bootMark("settings");
 
+  if (!warmBoot)
+  {
 #if !ENABLE_ANALOG_OUTPUT
-  ledcSetup(LEDC_CH, LEDC_FREQ, LEDC_RES);
-  ledcAttachPin(PIN_OUTPUT, LEDC_CH);
-  ledcWrite(LEDC_CH, OFF_RAW); // explicit off at startup
+    ledcSetup(LEDC_CH, LEDC_FREQ, LEDC_RES);
+    ledcAttachPin(PIN_OUTPUT, LEDC_CH);
+    ledcWrite(LEDC_CH, OFF_RAW); // explicit off at startup
 #else
-  dacWrite(PIN_OUTPUT, OFF_RAW);
+    dacWrite(PIN_OUTPUT, OFF_RAW);
 #endif
+  }
   patternStartMs = millis();
+  rtcStateApply();
+  bootMark("output");
 
+#if ENABLE_FAST_BOOT
+  // Start the lamp first; the loop runs the on-ramp while the boot task brings up the radios.
+#if ENABLE_SWITCH
+  initSwitchState();
+#endif
+  updatePatternEngine();
+  xTaskCreatePinnedToCore(bootTask, "boot", Settings::BOOT_TASK_STACK, nullptr, 1, nullptr, 0);
+  announcePattern(true);
+  printStatus(true);
+  bootMark("status");
+#else
   announcePattern(true);
   printHelp(true);
   printStatus(true);
+  bootMark("status");
   setupCommunications();
+  bootMark("radios");
   updatePatternEngine();
 
 #if ENABLE_SWITCH
   initSwitchState();
 #endif
+#endif
 }
 
 /**
@@ -475,12 +531,22 @@ void setup()
  */
 void loop()
 {
+  static bool firstLoop = true;
+  if (firstLoop)
+  {
+    firstLoop = false;
+    bootMark("loop");
+  }
+  bool holdInputs = false; // fast boot: lamp runs, user inputs wait
   if (startupHoldActive)
   {
     uint32_t now = millis();
     processStartupSwitch();
     if ((now - bootStartMs) < SECURE_BOOT_WINDOW_MS)
     {
+#if ENABLE_FAST_BOOT
+      holdInputs = true; // switch/poti only count secure-boot toggles
+#else
       if (lampEnabled)
         setLampEnabled(false, "startup-hold");
 #if ENABLE_ANALOG_OUTPUT
@@ -490,33 +556,50 @@ void loop()
 #endif
       delay(10);
       return;
+#endif
+    }
+    else
+    {
+      startupHoldActive = false;
+      secureBootWindowClosed = true;
+#if ENABLE_FAST_BOOT && ENABLE_SWITCH
+      initSwitchState(); // follow the switch again after the window
+#endif
     }
-    startupHoldActive = false;
-    secureBootWindowClosed = true;
   }
   pollCommunications();
 #if ENABLE_SWITCH
-  updateSwitchLogic();
+  if (!holdInputs)
+    updateSwitchLogic();
 #endif
 #if ENABLE_TOUCH_DIM
-  updateTouchBrightness();
+  if (!holdInputs)
+    updateTouchBrightness();
 #endif
   updateBrightnessRamp();
   updatePatternEngine();
   updateLightSensor();
 #if ENABLE_POTI
-  updatePoti();
+  if (!holdInputs)
+    updatePoti();
 #endif
 #if ENABLE_PUSH_BUTTON
-  updatePushButton();
+  if (!holdInputs)
+    updatePushButton();
 #endif
 #if ENABLE_MUSIC_MODE
   updateMusicSensor();
 #endif
 #if ENABLE_EXT_INPUT
-  updateExternalInput();
+  if (!holdInputs)
+    updateExternalInput();
+#endif
+  dispatchEvents();
+  updateSettingsWriteBehind();
+  rtcStateUpdate();
+#if ENABLE_TELEMETRY
+  updateTelemetry();
 #endif
-  flushLiveState();
   maybeLightSleep();
-  delay(10);
+  inputEventsWait(10); // an input edge ends the pause early
 }
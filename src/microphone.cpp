@@ -6,6 +6,7 @@
 #include "inputs.h"
 #include "lamp_state.h"
 #include "command.h"
+#include "audio_capture.h"
 
 #if ENABLE_MUSIC_MODE
 float patternMusicDirect(uint32_t) { return 1.0f; }
@@ -15,6 +16,14 @@ float musicFiltered = 0.0f;
 float musicDc = 0.5f;
 float musicEnv = 0.0f;
 float musicRawLevel = 0.0f;
+float musicBands[AUDIO_BAND_COUNT] = {0.0f, 0.0f, 0.0f};
+uint8_t musicBand = AUDIO_BAND_BASS;
+float musicBpm = 0.0f;
+float musicBeatConf = 0.0f;
+uint32_t musicBeatRefUs = 0;
+uint32_t musicBeatPeriodUs = 0;
+static uint32_t musicBeatFiredUs = 0;
+static bool musicBeatFired = false;
 uint32_t lastMusicSampleMs = 0;
 float musicGain = Settings::MUSIC_GAIN_DEFAULT;
 float musicSmoothing = 0.4f; // 0..1 low-pass for direct mode
@@ -29,6 +38,9 @@ uint32_t musicLastKickMs = 0;
 float clapPrevEnv = 0.0f;
 bool clapEnabled = Settings::CLAP_DEFAULT_ENABLED;
 float clapThreshold = Settings::CLAP_THRESHOLD_DEFAULT;
+#if ENABLE_AUDIO_DMA
+float clapPeakThreshold = Settings::CLAP_PEAK_DEFAULT;
+#endif
 uint32_t clapCooldownMs = Settings::CLAP_COOLDOWN_MS_DEFAULT;
 uint32_t clapLastMs = 0;
 bool clapAbove = false;
@@ -66,6 +78,33 @@ void executeClapCommand(uint8_t)
 #endif
 
 #if ENABLE_MUSIC_MODE
+bool musicBeatLocked()
+{
+    return musicBeatPeriodUs > 0 && musicBeatConf >= Settings::BEAT_LOCK_CONF;
+}
+
+float musicBeatPhase()
+{
+    if (!musicBeatPeriodUs)
+        return 0.0f;
+    return (float)((micros() - musicBeatRefUs) % musicBeatPeriodUs) / (float)musicBeatPeriodUs;
+}
+
+/**
+ * @brief True once per predicted beat, MUSIC_BEAT_LEAD_MS early to cover the loop period.
+ */
+static bool musicPredictedBeatDue()
+{
+    const uint32_t t = micros() + Settings::MUSIC_BEAT_LEAD_MS * 1000UL;
+    const uint32_t beatUs = t - (t - musicBeatRefUs) % musicBeatPeriodUs; // latest beat at or before t
+    // The reference moves a little with every block; half a period apart is a new beat.
+    if (musicBeatFired && (int32_t)(beatUs - musicBeatFiredUs) < (int32_t)(musicBeatPeriodUs / 2))
+        return false;
+    musicBeatFiredUs = beatUs;
+    musicBeatFired = true;
+    return true;
+}
+
 void updateMusicSensor()
 {
     bool active = musicEnabled || clapEnabled || musicAutoLamp;
@@ -77,33 +116,79 @@ void updateMusicSensor()
         musicBeatIntervalMs = 600.0f;
         musicLastBeatMs = 0;
         musicLastKickMs = 0;
+        musicBpm = 0.0f;
+        musicBeatConf = 0.0f;
+        musicBeatPeriodUs = 0;
+#if ENABLE_AUDIO_DMA
+        audioCaptureStop();
+#endif
         return;
     }
     uint32_t now = millis();
-    if (now - lastMusicSampleMs < Settings::MUSIC_SAMPLE_MS)
-        return;
-    lastMusicSampleMs = now;
-    int raw = analogRead(Settings::MUSIC_PIN);
-    // clamp ADC to valid range (some boards return negative when floating)
-    if (raw < 0)
-        raw = 0;
-    if (raw > 4095)
-        raw = 4095;
-    // envelope with DC removal: track slow baseline, then rectify delta
-    float val = (float)raw / 4095.0f;
-    musicRawLevel = clamp01(val);
-    static bool musicEnvInit = false;
-    if (!musicEnvInit)
+    float dtMs = (float)Settings::MUSIC_SAMPLE_MS;
+#if ENABLE_AUDIO_DMA
+    AudioLevels levels = {};
+    if (audioCaptureStart())
     {
-        musicDc = val;
-        musicEnv = 0.0f;
-        musicEnvInit = true;
+        // Continuous capture: pick up the latest block levels; between blocks only a predicted beat can be due
+        if (!audioCaptureRead(levels))
+        {
+            if (musicEnabled && musicMode == 1 && musicBeatLocked() && musicPredictedBeatDue())
+            {
+                musicLastBeatMs = now;
+                musicLastKickMs = now;
+                musicModScale = 0.8f;
+            }
+            return;
+        }
+        lastMusicSampleMs = now;
+        dtMs = levels.blockMs * (float)levels.blocks;
+        musicDc = levels.dc;
+        musicEnv = levels.env;
+        musicRawLevel = clamp01(levels.dc + levels.peak);
+        for (uint8_t b = 0; b < AUDIO_BAND_COUNT; ++b)
+            musicBands[b] = levels.bands[b];
+        musicBpm = levels.bpm;
+        musicBeatConf = levels.beatConf;
+        musicBeatRefUs = levels.beatUs;
+        musicBeatPeriodUs = levels.beatPeriodUs;
+        if (!musicBeatLocked())
+            musicBeatFired = false;
     }
-    const float dcAlpha = 0.01f; // slow baseline for bias removal
-    musicDc = (1.0f - dcAlpha) * musicDc + dcAlpha * val;
-    float delta = fabsf(val - musicDc);
-    const float envAlpha = Settings::MUSIC_ALPHA; // faster attack/decay for percussive signals
-    musicEnv = (1.0f - envAlpha) * musicEnv + envAlpha * delta;
+    else
+#endif
+    {
+        if (now - lastMusicSampleMs < Settings::MUSIC_SAMPLE_MS)
+            return;
+        lastMusicSampleMs = now;
+        int raw = analogRead(Settings::MUSIC_PIN);
+        // clamp ADC to valid range (some boards return negative when floating)
+        if (raw < 0)
+            raw = 0;
+        if (raw > 4095)
+            raw = 4095;
+        // envelope with DC removal: track slow baseline, then rectify delta
+        float val = (float)raw / 4095.0f;
+        musicRawLevel = clamp01(val);
+        static bool musicEnvInit = false;
+        if (!musicEnvInit)
+        {
+            musicDc = val;
+            musicEnv = 0.0f;
+            musicEnvInit = true;
+        }
+        const float dcAlpha = 0.01f; // slow baseline for bias removal
+        musicDc = (1.0f - dcAlpha) * musicDc + dcAlpha * val;
+        float delta = fabsf(val - musicDc);
+        const float envAlpha = Settings::MUSIC_ALPHA; // faster attack/decay for percussive signals
+        musicEnv = (1.0f - envAlpha) * musicEnv + envAlpha * delta;
+    }
+#if ENABLE_AUDIO_DMA
+    // One AGC-normalized band drives Music Direct/Beat (kick drums by default)
+    if (musicBand < AUDIO_BAND_COUNT && audioCaptureRunning())
+        musicFiltered = clamp01(musicBands[musicBand] * musicGain);
+    else
+#endif
     // Boost envelope a bit for visibility
     musicFiltered = clamp01(musicEnv * musicGain * 1.5f);
     bool kickDetected = false;
@@ -122,17 +207,37 @@ void updateMusicSensor()
         }
         else // beat mode
         {
-            bool rising = (musicFiltered > musicAutoThr) && (musicBeatEnv <= musicAutoThr);
-            musicBeatEnv = musicFiltered;
             uint32_t nowMs = millis();
-            if (rising)
+            bool rising;
+            if (musicBeatLocked())
+            {
+                // Phase-locked tempo: flash when the beat is due instead of after detecting it
+                rising = musicPredictedBeatDue();
+                musicBeatIntervalMs = (float)musicBeatPeriodUs / 1000.0f;
+            }
+            else
             {
-                if (musicLastBeatMs > 0)
+                // Without a tempo lock only a crossing that repeats the previous interval (+-25%) flashes,
+                // so a single door slam or clap in a quiet room is not taken for a beat
+                static uint32_t lastCrossMs = 0;
+                static float lastCrossIntervalMs = 0.0f;
+                rising = false;
+                if ((musicFiltered > musicAutoThr) && (musicBeatEnv <= musicAutoThr))
                 {
-                    float interval = (float)(nowMs - musicLastBeatMs);
-                    if (interval > 200.0f && interval < 2000.0f)
+                    float interval = lastCrossMs ? (float)(nowMs - lastCrossMs) : 0.0f;
+                    bool plausible = interval > 200.0f && interval < 2000.0f;
+                    if (plausible)
+                    {
+                        rising = fabsf(interval - lastCrossIntervalMs) <= 0.25f * interval;
                         musicBeatIntervalMs = 0.8f * musicBeatIntervalMs + 0.2f * interval;
+                    }
+                    lastCrossIntervalMs = plausible ? interval : 0.0f;
+                    lastCrossMs = nowMs;
                 }
+            }
+            musicBeatEnv = musicFiltered;
+            if (rising)
+            {
                 musicLastBeatMs = nowMs;
                 musicModScale = 0.8f; // kick on beat but avoid full current spike
                 kickDetected = true;
@@ -140,7 +245,7 @@ void updateMusicSensor()
             else
             {
                 float decayMs = fmaxf(250.0f, musicBeatIntervalMs * 0.6f);
-                float k = expf(-(Settings::MUSIC_SAMPLE_MS) / decayMs);
+                float k = expf(-dtMs / decayMs);
                 // decay toward a low floor; keep a neutral baseline so patterns remain visible
                 const float floor = 0.15f;
                 musicModScale = floor + (musicModScale - floor) * k;
@@ -165,12 +270,47 @@ void updateMusicSensor()
         lastActivityMs = now;
     }
     musicAutoAbove = above && musicAutoLamp;
-    if (clapTraining && (now - clapTrainLastLog) >= 200)
+#if ENABLE_AUDIO_DMA
+    static uint16_t clapTrainCandidates = 0;
+    if (levels.clapCandidates != clapTrainCandidates)
+    {
+        // One line per classified candidate: the features the decision tree saw
+        clapTrainCandidates = levels.clapCandidates;
+        const ClapFeatures &f = levels.clapLast;
+        if (clapTraining && feedbackWanted(FeedbackTopic::Debug))
+            sendFeedback(FeedbackTopic::Debug, String(F("[ClapTrain] rise=")) + String(f.riseDb10 / 10.0f, 1) + F("dB decay=") +
+                         String(f.decayDb10 / 10.0f, 1) + F("dB centroid=") + String((int)f.centroidHz) + F("Hz crest=") +
+                         String(f.crest10 / 10.0f, 1) + F(" bass=") + String(f.bassPermille / 10) + F("% peak=") +
+                         String(f.peak, 2) + (levels.clapLastWasClap ? F(" -> clap") : F(" -> no")));
+    }
+#endif
+    if (clapTraining && (now - clapTrainLastLog) >= 200 && feedbackWanted(FeedbackTopic::Debug))
     {
         clapTrainLastLog = now;
-        sendFeedback(String(F("[ClapTrain] env=")) + String(musicFiltered, 3) + F(" thr=") + String(clapThreshold, 2) +
+        sendFeedback(FeedbackTopic::Debug, String(F("[ClapTrain] env=")) + String(musicFiltered, 3) + F(" thr=") + String(clapThreshold, 2) +
                      F(" above=") + (musicFiltered >= clapThreshold ? F("1") : F("0")));
     }
+#if ENABLE_AUDIO_DMA
+    if (clapEnabled && audioCaptureRunning())
+    {
+        // Classified claps (clap_detector.h) need no cooldown: count them and close the series once it pauses
+        if (levels.claps && levels.clapPeak >= clapPeakThreshold)
+        {
+            clapLastMs = now;
+            if (clapWindowStartMs == 0)
+                clapWindowStartMs = now;
+            clapCount = (uint8_t)std::min(3, clapCount + levels.claps);
+        }
+        if (clapCount && (clapCount >= 3 || now - clapLastMs >= Settings::CLAP_SERIES_GAP_MS))
+        {
+            executeClapCommand(clapCount);
+            sendFeedback(String(F("[Clap] detected ")) + String(clapCount) + F("x"));
+            clapCount = 0;
+            clapWindowStartMs = 0;
+        }
+    }
+    else
+#endif
     if (clapEnabled)
     {
         float clapDelta = musicEnv - clapPrevEnv;
@@ -3,6 +3,7 @@
 #if ENABLE_BLE && ENABLE_BLE_MIDI
 
 #include "comms.h"
+#include "log_sink.h"
 
 #include <BLEAdvertising.h>
 #include <BLEServer.h>
@@ -91,15 +92,18 @@ namespace
       {
         uint8_t note = b;
         uint8_t vel = (i + 1 < len) ? data[i + 1] : 0;
-        String msg = F("[MIDI] ");
-        msg += (type == 0x90 && vel > 0) ? F("NoteOn ") : F("NoteOff ");
-        msg += F("ch=");
-        msg += String(chan + 1);
-        msg += F(" note=");
-        msg += String(note);
-        msg += F(" vel=");
-        msg += String(vel);
-        sendFeedback(msg);
+        if (feedbackWanted(FeedbackTopic::Midi))
+        {
+          String msg = F("[MIDI] ");
+          msg += (type == 0x90 && vel > 0) ? F("NoteOn ") : F("NoteOff ");
+          msg += F("ch=");
+          msg += String(chan + 1);
+          msg += F(" note=");
+          msg += String(note);
+          msg += F(" vel=");
+          msg += String(vel);
+          sendFeedback(FeedbackTopic::Midi, msg);
+        }
         if (type == 0x90 && vel > 0)
           handleMappedNote(note, vel);
         // consume velocity byte
@@ -109,11 +113,14 @@ namespace
       else if (type == 0xB0 && (b == 0x07 || b == 0x0A)) // CC vol/pan
       {
         uint8_t value = (i + 1 < len) ? data[i + 1] : 0;
-        String msg = F("[MIDI] CC ");
-        msg += String(b);
-        msg += F("=");
-        msg += String(value);
-        sendFeedback(msg);
+        if (feedbackWanted(FeedbackTopic::Midi))
+        {
+          String msg = F("[MIDI] CC ");
+          msg += String(b);
+          msg += F("=");
+          msg += String(value);
+          sendFeedback(FeedbackTopic::Midi, msg);
+        }
         handleMappedCC(b, value);
         ++i;
         status = 0;
@@ -149,7 +156,7 @@ void setupBleMidi(BLEServer *server, BLEAdvertising *advertising)
   svc->start();
   if (advertising)
     advertising->addServiceUUID(MIDI_SERVICE_UUID);
-  Serial.println(F("[BLE-MIDI] Receive-only service aktiv."));
+  LOG_I(F("[BLE-MIDI] Receive-only service aktiv."));
 }
 
 #endif // ENABLE_BLE && ENABLE_BLE_MIDI
@@ -30,6 +30,8 @@ namespace
 
   void emitNote(bool on, uint8_t chan, uint8_t note, uint8_t vel)
   {
+    if (!feedbackWanted(FeedbackTopic::Midi))
+      return;
     String msg = F("[MIDI-BT] ");
     msg += on ? F("NoteOn ") : F("NoteOff ");
     msg += F("ch=");
@@ -38,18 +40,20 @@ namespace
     msg += String(note);
     msg += F(" vel=");
     msg += String(vel);
-    sendFeedback(msg);
+    sendFeedback(FeedbackTopic::Midi, msg);
   }
 
   void emitCC(uint8_t chan, uint8_t cc, uint8_t val)
   {
+    if (!feedbackWanted(FeedbackTopic::Midi))
+      return;
     String msg = F("[MIDI-BT] CC ");
     msg += String(cc);
     msg += F("=");
     msg += String(val);
     msg += F(" ch=");
     msg += String(chan + 1);
-    sendFeedback(msg);
+    sendFeedback(FeedbackTopic::Midi, msg);
   }
 
   void dispatchCommand(const String &cmd)
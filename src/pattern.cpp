@@ -6,7 +6,9 @@
 #include "comms.h"
 #include "microphone.h"
 #include "persistence.h"
+#include "profiles.h"
 #include "print.h"
+#include "events.h"
 
 // Active pattern state (index and start time)
 size_t currentPattern = 0;
@@ -24,6 +26,7 @@ float patternMarginLow = Settings::PATTERN_MARGIN_LOW_DEFAULT;
 float patternMarginHigh = Settings::PATTERN_MARGIN_HIGH_DEFAULT;
 float patternFilteredLevel = 0.0f;
 uint32_t patternFilterLastMs = 0;
+float patternRelativeLevel = 0.0f;
 
 // Custom pattern editor storage
 static const size_t CUSTOM_MAX = 32;
@@ -42,9 +45,25 @@ float patternCustom(uint32_t ms)
 /**
  * @brief Log the currently selected pattern and its index.
  */
-void announcePattern(const bool &force)
+bool emitPatternLog(const bool &force)
 {
+    if (!feedbackWanted(FeedbackTopic::Log, force))
+        return false;
     sendFeedback(String(F("[Mode] ")) + String(currentPattern + 1) + F("/") + String(PATTERN_COUNT) + F(" - ") + PATTERNS[currentPattern].name,force);
+    return true;
+}
+
+/**
+ * @brief Announce the selected pattern (forced: now, otherwise via the event bus).
+ */
+void announcePattern(const bool &force)
+{
+    if (!force)
+    {
+        postEvent(EVT_PATTERN);
+        return;
+    }
+    emitPatternLog(force);
     queueLiveState(force);
 }
 
@@ -123,5 +142,6 @@ void listPatterns()
     }
     // Reserve virtual slots for profiles after patterns
     for (uint8_t p = 1; p <= PROFILE_SLOTS; ++p)
-        sendFeedback(String(PATTERN_COUNT + p) + F(": Profile ") + String(p));
+        if (profileSlotUsed(p))
+            sendFeedback(String(PATTERN_COUNT + p) + F(": Profile ") + String(p));
 }
@@ -5,8 +5,11 @@
 #include "comms.h"
 #include "presence.h"
 
+#include <freertos/FreeRTOS.h>
+
 #if ENABLE_BLE
 #include <BLEDevice.h>
+#include <BLEScan.h>
 #endif
 
 // Presence tracking
@@ -24,7 +27,250 @@ bool presenceLastOffByPresence = false;
 String lastBleAddr;
 String lastBtAddr;
 uint32_t lastPresenceSeenMs = 0;
-uint32_t lastPresenceScanMs = 0;
+
+namespace
+{
+    constexpr uint8_t MAX_DEVICES = 8;
+    constexpr uint8_t TABLE_SIZE = 16; // power of two, at most half full
+
+    struct Target
+    {
+        uint64_t addr;
+        float rssi;           // EMA of the advertisement RSSI (dBm)
+        bool present;         // after enter/leave hysteresis
+        uint32_t lastAdvMs;   // 0 = not heard since the list changed
+        uint32_t firstAdvMs;  // first advertisement while absent, for the detection latency
+        uint32_t advs;
+    };
+
+    // Targets and their open-addressing index; written by the loop, read by the BLE task's scan callback.
+    Target targets[MAX_DEVICES];
+    uint8_t targetCount = 0;
+    int8_t table[TABLE_SIZE]; // target index, -1 = empty
+    portMUX_TYPE presenceMux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Statistics for `presence stats`
+    uint32_t scanStarts = 0;
+    volatile uint32_t advTotal = 0;
+    uint32_t enters = 0;
+    uint32_t leaves = 0;
+    uint32_t detectLastMs = 0;
+    uint32_t detectMaxMs = 0;
+    uint32_t leaveLastMs = 0;
+    uint32_t updateLastUs = 0;
+    uint32_t updateMaxUs = 0;
+    uint64_t radioOnUs = 0;     // scan time weighted with window / interval
+    uint32_t modeMs[4] = {};    // time spent per ScanMode
+    uint32_t lastUpdateMs = 0;
+
+    enum ScanMode : uint8_t
+    {
+        SCAN_OFF,    // presence off, no devices, or a listed device is connected (the link proves presence)
+        SCAN_PAUSE,  // backoff: a present device was heard within PRESENCE_BACKOFF_MS
+        SCAN_SEARCH, // nobody present
+        SCAN_FAST,   // re-check burst after the backoff, or grace time before auto-off
+    };
+
+    struct ScanParams
+    {
+        uint16_t windowMs;
+        uint16_t intervalMs;
+    };
+
+    ScanMode scanMode = SCAN_OFF;
+    ScanParams scanParams = {0, 0};
+#if ENABLE_BLE
+    volatile bool scanRunning = false;
+    bool scanConfigured = false;
+#endif
+
+    inline uint8_t slotOf(uint64_t addr)
+    {
+        return (uint8_t)((addr * 0x9E3779B97F4A7C15ULL) >> 60) & (TABLE_SIZE - 1);
+    }
+
+    /** @brief Target index of @p addr, or -1; caller holds presenceMux (or is the only writer). */
+    int findTarget(uint64_t addr)
+    {
+        for (uint8_t i = 0, slot = slotOf(addr); i < TABLE_SIZE; ++i, slot = (slot + 1) & (TABLE_SIZE - 1))
+        {
+            const int8_t t = table[slot];
+            if (t < 0)
+                return -1;
+            if (targets[t].addr == addr)
+                return t;
+        }
+        return -1;
+    }
+
+    /** @brief Rebuild targets and index from presenceDevices; keeps the state of devices still listed. */
+    void rebuildTargets()
+    {
+        Target next[MAX_DEVICES];
+        uint8_t n = 0;
+        for (const auto &a : presenceDevices)
+        {
+            uint64_t addr;
+            if (n >= MAX_DEVICES || !presenceParseAddr(a, addr))
+                continue;
+            const int old = findTarget(addr);
+            if (old >= 0)
+                next[n] = targets[old];
+            else
+                next[n] = {addr, -127.0f, false, 0, 0, 0};
+            n++;
+        }
+        portENTER_CRITICAL(&presenceMux);
+        memcpy(targets, next, sizeof(Target) * n);
+        targetCount = n;
+        memset(table, -1, sizeof(table));
+        for (uint8_t i = 0; i < n; ++i)
+        {
+            uint8_t slot = slotOf(targets[i].addr);
+            while (table[slot] >= 0)
+                slot = (slot + 1) & (TABLE_SIZE - 1);
+            table[slot] = (int8_t)i;
+        }
+        portEXIT_CRITICAL(&presenceMux);
+    }
+
+    String formatAddr(uint64_t addr)
+    {
+        char buf[18];
+        snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x", (unsigned)(addr >> 40) & 0xFF, (unsigned)(addr >> 32) & 0xFF,
+                 (unsigned)(addr >> 24) & 0xFF, (unsigned)(addr >> 16) & 0xFF, (unsigned)(addr >> 8) & 0xFF, (unsigned)addr & 0xFF);
+        return String(buf);
+    }
+
+#if ENABLE_BLE
+    /** @brief BLE task: every advertisement of the running scan (duplicates included). */
+    class PresenceScanCallbacks : public BLEAdvertisedDeviceCallbacks
+    {
+        void onResult(BLEAdvertisedDevice d) override
+        {
+            BLEAddress bda = d.getAddress();
+            const uint8_t *b = (const uint8_t *)bda.getNative();
+            uint64_t addr = 0;
+            for (int i = 0; i < 6; ++i)
+                addr = (addr << 8) | b[i];
+            const float rssi = (float)d.getRSSI();
+            const uint32_t now = millis();
+            advTotal++;
+            portENTER_CRITICAL(&presenceMux);
+            const int t = findTarget(addr);
+            if (t >= 0)
+            {
+                Target &tg = targets[t];
+                // Restart the average after a long silence: old readings say nothing about the new visit.
+                if (tg.lastAdvMs == 0 || now - tg.lastAdvMs >= Settings::PRESENCE_LEAVE_MS)
+                    tg.rssi = rssi;
+                else
+                    tg.rssi += (rssi - tg.rssi) * Settings::PRESENCE_RSSI_ALPHA;
+                if (!tg.present && tg.firstAdvMs == 0)
+                    tg.firstAdvMs = now;
+                tg.lastAdvMs = now;
+                tg.advs++;
+            }
+            portEXIT_CRITICAL(&presenceMux);
+        }
+    };
+
+    PresenceScanCallbacks scanCallbacks;
+
+    void scanComplete(BLEScanResults)
+    {
+        scanRunning = false;
+    }
+
+    ScanParams paramsFor(ScanMode mode)
+    {
+        if (mode != SCAN_SEARCH && mode != SCAN_FAST)
+            return {0, 0};
+        // Long windows delay a connected client's connection events: keep UI round trips short.
+        // The search scan keeps its radio share, only in shorter windows.
+        const bool conn = bleActive();
+        if (mode == SCAN_SEARCH && conn)
+            return {Settings::PRESENCE_CONN_WINDOW_MS,
+                    (uint16_t)((uint32_t)Settings::PRESENCE_CONN_WINDOW_MS * Settings::PRESENCE_SEARCH_INTERVAL_MS /
+                               Settings::PRESENCE_SEARCH_WINDOW_MS)};
+        if (mode == SCAN_SEARCH)
+            return {Settings::PRESENCE_SEARCH_WINDOW_MS, Settings::PRESENCE_SEARCH_INTERVAL_MS};
+        if (conn)
+            return {Settings::PRESENCE_CONN_WINDOW_MS, Settings::PRESENCE_CONN_INTERVAL_MS};
+        return {Settings::PRESENCE_FAST_WINDOW_MS, Settings::PRESENCE_FAST_INTERVAL_MS};
+    }
+
+    void scanStop(BLEScan *scan)
+    {
+        if (!scanRunning)
+            return;
+        scan->stop(); // no completion callback on stop
+        scan->clearResults();
+        scanRunning = false;
+    }
+
+    void scanControl(ScanMode mode)
+    {
+        BLEScan *scan = BLEDevice::getScan();
+        if (!scan)
+            return;
+        const ScanParams p = paramsFor(mode);
+        if (p.windowMs == 0)
+        {
+            scanStop(scan);
+            scanParams = p;
+            return;
+        }
+        if (scanRunning && p.windowMs == scanParams.windowMs && p.intervalMs == scanParams.intervalMs)
+            return;
+        if (!scanConfigured)
+        {
+            scanConfigured = true;
+            scan->setAdvertisedDeviceCallbacks(&scanCallbacks, true);
+            scan->setActiveScan(false); // RSSI is all we need; no scan requests on air
+        }
+        scanStop(scan); // parameters only apply on start
+        scan->setInterval(p.intervalMs);
+        scan->setWindow(p.windowMs);
+        scanParams = p;
+        // Chunks keep the library's per-address result list from growing; restarting returns at once.
+        scan->clearResults();
+        scanRunning = true;
+        if (scan->start(Settings::PRESENCE_SCAN_CHUNK_S, scanComplete, false))
+            scanStarts++;
+        else
+            scanRunning = false;
+    }
+#endif
+} // namespace
+
+bool presenceParseAddr(const String &text, uint64_t &addr)
+{
+    uint64_t v = 0;
+    uint8_t digits = 0;
+    for (size_t i = 0; i < text.length(); ++i)
+    {
+        const char c = text[i];
+        if (c == ':' || c == '-')
+            continue;
+        int h;
+        if (c >= '0' && c <= '9')
+            h = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            h = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            h = c - 'A' + 10;
+        else
+            return false;
+        if (++digits > 12)
+            return false;
+        v = (v << 4) | (uint64_t)h;
+    }
+    if (digits != 12)
+        return false;
+    addr = v;
+    return true;
+}
 
 String presenceListCsv()
 {
@@ -47,26 +293,27 @@ bool presenceHasDevices()
 
 bool presenceAddDevice(const String &addr)
 {
-    if (addr.length() == 0)
+    uint64_t parsed;
+    if (!presenceParseAddr(addr, parsed) || findTarget(parsed) >= 0)
         return false;
-    for (const auto &a : presenceDevices)
-    {
-        if (a.equalsIgnoreCase(addr))
-            return false;
-    }
-    if (presenceDevices.size() >= 8)
+    if (presenceDevices.size() >= MAX_DEVICES)
         presenceDevices.erase(presenceDevices.begin()); // drop oldest to keep list bounded
     presenceDevices.push_back(addr);
     presenceAddr = presenceDevices.back(); // keep legacy single addr in sync
+    rebuildTargets();
     return true;
 }
 
 bool presenceRemoveDevice(const String &addr)
 {
+    uint64_t parsed;
+    if (!presenceParseAddr(addr, parsed))
+        return false;
     bool removed = false;
     for (auto it = presenceDevices.begin(); it != presenceDevices.end();)
     {
-        if (it->equalsIgnoreCase(addr))
+        uint64_t a;
+        if (presenceParseAddr(*it, a) && a == parsed)
         {
             it = presenceDevices.erase(it);
             removed = true;
@@ -80,6 +327,7 @@ bool presenceRemoveDevice(const String &addr)
         presenceAddr = "";
     else
         presenceAddr = presenceDevices.back();
+    rebuildTargets();
     return removed;
 }
 
@@ -87,51 +335,123 @@ void presenceClearDevices()
 {
     presenceDevices.clear();
     presenceAddr = "";
+    rebuildTargets();
 }
 
 bool presenceIsTarget(const String &addr)
 {
-    for (const auto &a : presenceDevices)
-    {
-        if (a.equalsIgnoreCase(addr))
-            return true;
-    }
-    return false;
+    uint64_t parsed;
+    return presenceParseAddr(addr, parsed) && findTarget(parsed) >= 0;
 }
 
-// Active presence scan for target MAC (returns true if found)
-bool presenceScanOnce()
+bool presenceScanUpdate(bool targetConnected)
 {
+    const uint32_t startUs = micros();
+    const uint32_t now = millis();
+    const bool want = presenceEnabled && targetCount > 0 && communicationsReady();
+
+    // Radio time of the parameters that ran since the last call.
+    const uint32_t dt = lastUpdateMs ? now - lastUpdateMs : 0;
+    lastUpdateMs = now;
+    modeMs[scanMode] += dt;
 #if ENABLE_BLE
-    if (!presenceHasDevices())
-        return false;
-    BLEScan *scan = BLEDevice::getScan();
-    if (!scan)
-        return false;
-    const uint32_t SCAN_TIME_S = 3;
-    scan->setActiveScan(true);
-    scan->setInterval(320);
-    scan->setWindow(80);
-    BLEScanResults res = scan->start(SCAN_TIME_S, false);
-    bool found = false;
-    for (int i = 0; i < res.getCount(); ++i)
-    {
-        BLEAdvertisedDevice d = res.getDevice(i);
-        String addr = d.getAddress().toString().c_str();
-        int rssi = d.getRSSI();
-        if (presenceIsTarget(addr) && rssi >= presenceRssiThreshold)
+    if (scanRunning && scanParams.intervalMs)
+        radioOnUs += (uint64_t)dt * 1000u * scanParams.windowMs / scanParams.intervalMs;
+#endif
+
+    bool any = false;
+    uint32_t newestPresentMs = 0; // age reference for the backoff
+    for (uint8_t i = 0; want && i < targetCount; ++i)
+    {
+        portENTER_CRITICAL(&presenceMux);
+        Target tg = targets[i];
+        portEXIT_CRITICAL(&presenceMux);
+        const bool heard = tg.lastAdvMs != 0 && now - tg.lastAdvMs < Settings::PRESENCE_LEAVE_MS;
+        bool present;
+        if (tg.present)
+            present = heard && tg.rssi >= (float)(presenceRssiThreshold - Settings::PRESENCE_RSSI_HYST_DB);
+        else
+            present = heard && tg.rssi >= (float)presenceRssiThreshold;
+        if (present != tg.present)
         {
-            found = true;
-            lastPresenceSeenMs = millis();
-            presenceDetected = true;
-            presencePrevConnected = true;
-            break;
+            portENTER_CRITICAL(&presenceMux);
+            targets[i].present = present;
+            if (present)
+            {
+                detectLastMs = tg.firstAdvMs ? now - tg.firstAdvMs : 0;
+                if (detectLastMs > detectMaxMs)
+                    detectMaxMs = detectLastMs;
+            }
+            else if (tg.lastAdvMs)
+            {
+                leaveLastMs = now - tg.lastAdvMs;
+            }
+            targets[i].firstAdvMs = 0;
+            portEXIT_CRITICAL(&presenceMux);
+            present ? enters++ : leaves++;
+            if (feedbackWanted(FeedbackTopic::Debug))
+                sendFeedback(FeedbackTopic::Debug, String(F("[Presence] ")) + formatAddr(tg.addr) + (present ? F(" enter") : F(" leave")) +
+                             F(" rssi=") + String(tg.rssi, 1));
+        }
+        if (present)
+        {
+            any = true;
+            if (newestPresentMs == 0 || (int32_t)(tg.lastAdvMs - newestPresentMs) > 0)
+                newestPresentMs = tg.lastAdvMs;
         }
     }
-    sendFeedback(String(F("[Presence] Scan targets=")) + presenceListCsv() + F(" -> ") +
-                 (found ? F("found") : F("not found")) + F(" @rssi>=") + String(presenceRssiThreshold));
-    return found;
-#else
-    return false;
+
+    // Scan only as hard as the situation needs: nothing while the link or a fresh advertisement proves
+    // presence, bursts once that goes stale, full speed while auto-off is pending.
+    ScanMode mode;
+    if (!want || targetConnected)
+        mode = SCAN_OFF;
+    else if (presenceGraceDeadline != 0)
+        mode = SCAN_FAST;
+    else if (any)
+        mode = (now - newestPresentMs < Settings::PRESENCE_BACKOFF_MS) ? SCAN_PAUSE : SCAN_FAST;
+    else
+        mode = SCAN_SEARCH;
+    scanMode = mode;
+#if ENABLE_BLE
+    if (mode != SCAN_OFF || scanRunning)
+        scanControl(mode);
 #endif
+
+    updateLastUs = micros() - startUs;
+    if (updateLastUs > updateMaxUs)
+        updateMaxUs = updateLastUs;
+    return any;
+}
+
+void presenceScanFeedback()
+{
+    const uint32_t now = millis();
+    static const char *const MODE_NAMES[] = {"off", "pause", "search", "fast"};
+    const uint32_t total = modeMs[SCAN_OFF] + modeMs[SCAN_PAUSE] + modeMs[SCAN_SEARCH] + modeMs[SCAN_FAST];
+    String line = String(F("[Presence] scan=")) + MODE_NAMES[scanMode];
+    if (scanParams.intervalMs)
+        line += String(F(" ")) + String(scanParams.windowMs) + F("/") + String(scanParams.intervalMs) + F("ms");
+    line += String(F(" radio=")) + String((uint32_t)(radioOnUs / 1000u)) + F("ms (") +
+            String(total ? (float)(radioOnUs / 1000u) * 100.0f / (float)total : 0.0f, 1) + F("%) starts=") + String(scanStarts) +
+            F(" adv=") + String(advTotal);
+    sendFeedback(line);
+    line = F("[Presence] time");
+    for (uint8_t m = 0; m < 4; ++m)
+        line += String(F(" ")) + MODE_NAMES[m] + F("=") + String(modeMs[m] / 1000u) + F("s");
+    sendFeedback(line);
+    sendFeedback(String(F("[Presence] loop cost last=")) + String(updateLastUs) + F("us max=") + String(updateMaxUs) +
+                 F("us detect last=") + String(detectLastMs) + F("ms max=") + String(detectMaxMs) + F("ms leave last=") +
+                 String(leaveLastMs) + F("ms enter=") + String(enters) + F(" leave=") + String(leaves));
+    for (uint8_t i = 0; i < targetCount; ++i)
+    {
+        portENTER_CRITICAL(&presenceMux);
+        const Target tg = targets[i];
+        portEXIT_CRITICAL(&presenceMux);
+        String line = String(F("[Presence] ")) + formatAddr(tg.addr) + (tg.present ? F(" present") : F(" absent"));
+        if (tg.lastAdvMs)
+            line += String(F(" rssi=")) + String(tg.rssi, 1) + F(" age=") + String(now - tg.lastAdvMs) + F("ms");
+        line += String(F(" adv=")) + String(tg.advs);
+        sendFeedback(line);
+    }
 }
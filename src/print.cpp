@@ -13,12 +13,14 @@
 #include "lightSensor.h"
 #include "microphone.h"
 #include "inputs.h"
+#include "touch_sensor.h"
 #include "presence.h"
 #include "quickmode.h"
 #include "sleepwake.h"
 #include "notifications.h"
 #include "pattern.h"
 #include "demo.h"
+#include "settings_registry.h"
 
 static constexpr uint32_t LIVE_STATE_MIN_INTERVAL_MS = 100;
 static uint32_t liveStateLastMs = 0;
@@ -26,8 +28,15 @@ static bool liveStatePending = false;
 
 static String liveStateLastKey;
 
-static void emitLiveState(const bool &force)
+static bool emitLiveState(const bool &force)
 {
+    if (!feedbackWanted(FeedbackTopic::State, force))
+    {
+        // Nobody subscribed: skip formatting; the next subscriber gets a fresh line.
+        liveStatePending = false;
+        liveStateLastKey = "";
+        return false;
+    }
     const bool lampOn = (lampEnabled && !lampOffPending);
     // Noise-tolerant change key: drops the raw ADC value and rounds the
     // normalized poti to 1%, so jittery sensor reads don't spam identical
@@ -43,7 +52,7 @@ static void emitLiveState(const bool &force)
     if (!force && key == liveStateLastKey)
     {
         liveStatePending = false;
-        return;
+        return false;
     }
     liveStateLastKey = key;
 
@@ -61,47 +70,43 @@ static void emitLiveState(const bool &force)
 #else
     line += F("|poti=N/A");
 #endif
-    sendFeedback(line, force);
+    sendFeedback(FeedbackTopic::State, line, force);
     liveStateLastMs = millis();
     liveStatePending = false;
+    return true;
 }
 
-void queueLiveState(const bool &force)
+bool queueLiveState(const bool &force)
 {
     uint32_t now = millis();
     if (force || liveStateLastMs == 0 || (now - liveStateLastMs) >= LIVE_STATE_MIN_INTERVAL_MS)
-    {
-        emitLiveState(force);
-        return;
-    }
+        return emitLiveState(force);
     liveStatePending = true;
+    return false;
 }
 
-void flushLiveState()
+bool flushLiveState()
 {
     if (liveStatePending && (millis() - liveStateLastMs) >= LIVE_STATE_MIN_INTERVAL_MS)
-        emitLiveState(false);
+        return emitLiveState(false);
+    return false;
 }
 
 /**
- * @brief Print averaged touch sensor data for calibration purposes.
+ * @brief Print the filtered touch count and thresholds for calibration purposes.
  */
 void printTouchDebug(const bool &force)
 {
 #if !ENABLE_TOUCH_DIM
     sendFeedback(F("[Touch] disabled"), force);
 #else
-    long acc = 0;
-    const int samples = 10;
-    for (int i = 0; i < samples; ++i)
-    {
-        acc += touchRead(PIN_TOUCH_DIM);
-        delay(5);
-    }
-    int raw = (int)(acc / samples);
+    int raw = touchSensorValue(); // already IIR-filtered by the touch peripheral driver
     int delta = touchBaseline - raw;
     sendFeedback(String(F("[Touch] raw=")) + String(raw) + F(" baseline=") + String(touchBaseline) +
                  F(" delta=") + String(delta) + F(" thrOn=") + String(touchDeltaOn) + F(" thrOff=") + String(touchDeltaOff),force);
+    sendFeedback(String(F("[Touch] 1x=")) + (touchCmd1.isEmpty() ? String(F("-")) : touchCmd1) + F(" 2x=") +
+                     (touchCmd2.isEmpty() ? String(F("-")) : touchCmd2) + F(" 3x=") + (touchCmd3.isEmpty() ? String(F("-")) : touchCmd3),
+                 force);
 #endif
 }
 
@@ -134,6 +139,10 @@ void printStatus(const bool &force)
 
 #if ENABLE_MUSIC_MODE
     String clapLine = String(F("[Clap] ")) + (clapEnabled ? F("ON") : F("OFF")) + F(" thr=") + String(clapThreshold, 2) + F(" cool=") + String(clapCooldownMs);
+#if ENABLE_AUDIO_DMA
+    clapLine += F(" peak=");
+    clapLine += String(clapPeakThreshold, 2);
+#endif
     sendFeedback(clapLine,force);
 #endif
 
@@ -278,7 +287,7 @@ void printStatus(const bool &force)
 
 #if ENABLE_TOUCH_DIM
     {
-        int raw = touchRead(PIN_TOUCH_DIM);
+        int raw = touchSensorValue();
         int delta = raw - touchBaseline;
         int mag = abs(delta);
         String touchLine = String(F("[Touch] base=")) + String(touchBaseline) + F(" raw=") + String(raw) +
@@ -296,7 +305,7 @@ void printStatus(const bool &force)
     {
         lightLine += String(F("raw=")) + String((int)lightFiltered) + F(" min=") + String((int)lightMinRaw) +
                      F(" max=") + String((int)lightMaxRaw) + F(" alpha=") + String(lightAlpha, 3) +
-                     F(" ambx=") + String(rampAmbientMultiplier, 2) + F(" rampAmb=") + String(rampAmbientFactor, 2);
+                     F(" self=") + String(lightSelfGain, 0) + F(" ambx=") + String(rampAmbientMultiplier, 2) + F(" rampAmb=") + String(rampAmbientFactor, 2);
     }
     else
     {
@@ -344,11 +353,14 @@ void printStatus(const bool &force)
  */
 void printSensorsStructured(const bool &force)
 {
+    const uint8_t route = feedbackRoute(FeedbackTopic::Sensors, force);
+    if (!route)
+        return;
     String line = F("SENSORS|");
 #if ENABLE_TOUCH_DIM
     line += F("touch_base=");
     line += String(touchBaseline);
-    int raw = touchRead(PIN_TOUCH_DIM);
+    int raw = touchSensorValue();
     line += F("|touch_raw=");
     line += String(raw);
     line += F("|touch_delta=");
@@ -387,16 +399,33 @@ void printSensorsStructured(const bool &force)
     line += (musicLastKickMs > 0 ? String(millis() - musicLastKickMs) : F("N/A"));
     line += F("|music_level=");
     line += String(musicRawLevel, 3);
+    line += F("|music_bands=");
+    line += String(musicBands[AUDIO_BAND_BASS], 2) + F(",") + String(musicBands[AUDIO_BAND_MID], 2) + F(",") +
+            String(musicBands[AUDIO_BAND_TREBLE], 2);
+    line += F("|music_bpm=");
+    line += String(musicBpm, 1);
+    line += F("|music_beat_conf=");
+    line += String(musicBeatConf, 2);
+    line += F("|music_beat_phase=");
+    line += String(musicBeatPhase(), 2);
 #else
     line += F("|music_env=N/A");
 #endif
-    sendFeedback(line,force);
+    sendFeedbackRoute(route, line);
 }
 /**
  * @brief Emit a single structured status line for easier parsing (key=value pairs).
+ *
+ * STATUS and STATUS1 mix settings with live readings under the field names and
+ * units (percent, ON/OFF) the app and Home Assistant parse, so they are written
+ * out here; STATUS2 is generated from the filter settings table.
  */
 void printStatusStructured(const bool &force)
 {
+    // Build the lines even when status feedback is routed off: the BLE status
+    // characteristic must still reflect the current state for clients that
+    // only read it (sendFeedbackRoute() with route 0 sends nothing).
+    const uint8_t route = feedbackRoute(FeedbackTopic::Status, force);
     // Core line (keep short for BLE MTU)
     String line = F("STATUS|");
     line += F("pattern=");
@@ -475,7 +504,7 @@ void printStatusStructured(const bool &force)
     line += F("|ble=");
     line += bleActive() ? F("UP") : F("DOWN");
 #endif
-    sendFeedback(line,force);
+    sendFeedbackRoute(route, line);
     updateBleStatus(line);
 
     // Detail line: IO, PWM, light, music, inputs
@@ -565,10 +594,20 @@ void printStatusStructured(const bool &force)
     lineIO += String(musicRawLevel, 3);
     lineIO += F("|music_smooth=");
     lineIO += String(musicSmoothing, 2);
+    lineIO += F("|music_bpm=");
+    lineIO += String(musicBpm, 1);
+    lineIO += F("|music_beat_conf=");
+    lineIO += String(musicBeatConf, 2);
+    lineIO += F("|music_beat_phase=");
+    lineIO += String(musicBeatPhase(), 2);
     lineIO += F("|clap=");
     lineIO += clapEnabled ? F("ON") : F("OFF");
     lineIO += F("|clap_thr=");
     lineIO += String(clapThreshold, 2);
+#if ENABLE_AUDIO_DMA
+    lineIO += F("|clap_peak=");
+    lineIO += String(clapPeakThreshold, 2);
+#endif
     lineIO += F("|clap_cool=");
     lineIO += String(clapCooldownMs);
     lineIO += F("|clap_cmd1=");
@@ -620,66 +659,14 @@ void printStatusStructured(const bool &force)
 #else
     lineIO += F("|push=N/A");
 #endif
-    sendFeedback(lineIO,force);
+    sendFeedbackRoute(route, lineIO);
     updateBleStatus(lineIO);
 
     // Filters/status chunk (separate to stay under BLE MTU)
-    String line2 = F("STATUS2|");
-    {
-        FilterState filt;
-        filtersGetState(filt);
-        line2 += F("filter_iir=");
-        line2 += filt.iirEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_alpha=");
-        line2 += String(filt.iirAlpha, 3);
-        line2 += F("|filter_clip=");
-        line2 += filt.clipEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_clip_amt=");
-        line2 += String(filt.clipAmount, 2);
-        line2 += F("|filter_clip_curve=");
-        line2 += filt.clipCurve;
-        line2 += F("|filter_trem=");
-        line2 += filt.tremEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_trem_rate=");
-        line2 += String(filt.tremRateHz, 2);
-        line2 += F("|filter_trem_depth=");
-        line2 += String(filt.tremDepth, 2);
-        line2 += F("|filter_trem_wave=");
-        line2 += filt.tremWave;
-        line2 += F("|filter_spark=");
-        line2 += filt.sparkEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_spark_dens=");
-        line2 += String(filt.sparkDensity, 2);
-        line2 += F("|filter_spark_int=");
-        line2 += String(filt.sparkIntensity, 2);
-        line2 += F("|filter_spark_decay=");
-        line2 += String(filt.sparkDecayMs);
-        line2 += F("|filter_comp=");
-        line2 += filt.compEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_comp_thr=");
-        line2 += String(filt.compThr, 2);
-        line2 += F("|filter_comp_ratio=");
-        line2 += String(filt.compRatio, 2);
-        line2 += F("|filter_comp_att=");
-        line2 += String(filt.compAttackMs);
-        line2 += F("|filter_comp_rel=");
-        line2 += String(filt.compReleaseMs);
-        line2 += F("|filter_env=");
-        line2 += filt.envEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_env_att=");
-        line2 += String(filt.envAttackMs);
-        line2 += F("|filter_env_rel=");
-        line2 += String(filt.envReleaseMs);
-        line2 += F("|filter_delay=");
-        line2 += filt.delayEnabled ? F("ON") : F("OFF");
-        line2 += F("|filter_delay_ms=");
-        line2 += String(filt.delayMs);
-        line2 += F("|filter_delay_fb=");
-        line2 += String(filt.delayFeedback, 2);
-        line2 += F("|filter_delay_mix=");
-        line2 += String(filt.delayMix, 2);
-    }
-    sendFeedback(line2,force);
+    String line2 = F("STATUS2");
+    filterSettingsCapture();
+    filterSettingsAppend(line2, SETTING_STATUS, '|');
+    sendFeedbackRoute(route, line2);
     updateBleStatus(line2);
 
 #if SEND_STATUS_END
@@ -692,7 +679,7 @@ void printStatusStructured(const bool &force)
     lineEnd += String(masterBrightness * 100.0f, 1);
     lineEnd += F("|pattern=");
     lineEnd += String(currentPattern + 1);
-    sendFeedback(lineEnd, force);
+    sendFeedbackRoute(route, lineEnd);
     updateBleStatus(lineEnd);
 #endif
 }
@@ -703,6 +690,7 @@ void printStatusStructured(const bool &force)
 void printHelp(const bool &force)
 {
 #if ENABLE_HELP_TEXT
+    static_assert(Settings::TELEMETRY_HZ_MAX == 50, "telem help line below states the rate range");
     const char *lines[] = {
         "Serien-Kommandos:",
         "  list              - verfügbare Muster",
@@ -731,8 +719,10 @@ void printHelp(const bool &force)
         "  pwm curve <0.5-4> - PWM-Gamma/Linearität anpassen",
         "  demo [Sek]        - Demo-Modus: Quick-Liste mit fester Verweildauer (Default 6s)",
         "  touch hold <ms>   - Hold-Start 500..5000 ms",
+        "  touch <1|2|3> <cmd>|none - Befehl bei 1/2/3 Tipps (Default 2x = next)",
         "  touchdim on/off   - Touch-Dimmen aktivieren/deaktivieren",
-        "  clap on|off/thr <0..1>/cool <ms>/train [on|off] - Klatschsteuerung (Audio)",
+        "  clap on|off/thr <0..1>/cool <ms>/train [on|off] - Klatschsteuerung (Audio; thr/cool gelten nur ohne I2S-Erfassung)",
+        "  clap peak <0..1> - Mindest-Spitzenpegel klassifizierter Klatscher (I2S-Erfassung, 1 = Vollaussteuerung)",
         "  clap <1|2|3> <cmd> - Befehl bei 1/2/3 Klatschen",
         "  presence on|off   - Presence aktivieren/deaktivieren",
         "  presence add <addr>/del <addr>/clear - Geräte-Liste verwalten",
@@ -740,13 +730,20 @@ void printHelp(const bool &force)
         "  presence thr <-dBm> - RSSI-Schwelle (z.B. -75)",
         "  presence auto on|off <on|off> - Auto-Licht AN/OFF Aktionen",
         "  presence grace <ms> - Verzögerung vor Auto-Off",
+        "  presence stats    - Hintergrund-Scan: Modus, Funkzeit, Loop-Kosten, Erkennungs-/Verlass-Latenz, RSSI je Gerät",
         "  custom v1,v2,...   - Custom-Pattern setzen (0..1)",
         "  custom step <ms>   - Schrittzeit Custom-Pattern",
         "  notify [on1 off1 on2 off2] - Blinksignal (ms)",
         "  music sens <f>/smooth <0-1>/auto on|off/thr <f> - Musik-Parameter (Patterns Music Direct/Beat)",
+        "  music band bass|mid|treble|all - Frequenzband für Music Direct/Beat (Default bass)",
+        "  audio             - Mikrofon-Erfassung (I2S-ADC): Rate, CPU/FFT-Zyklen pro Block, Latenz",
+        "  adc               - ADC-Scanner (Licht/Poti/Ext im Hintergrund): Durchläufe, Dauer, Rohwerte",
+        "  gpio              - Schalter/Taster/Ext-Flanken (Interrupt): Prellen, verlorene Flanken, Latenz",
         "  morse <text>     - Morse-Blink (dot=200ms, dash=600ms)",
-        "  profile save <1-3>/load <1-3> - User-Profile ohne Touch/Presence/Quick",
+        "  profile [save|load|clear <1-32>] [keep] - Szenen-Profile (RAM-Cache, Laden ohne Speichern)",
         "  light gain <f>     - Verstärkung Lichtsensor",
+        "  light calib [min|max] - Lichtsensor-Bereich vorgeben (Auto-Range lernt 24 h weiter)",
+        "  light self [reset] - Eigenlicht-Modell (Sensor-Counts pro PWM-Duty) anzeigen/neu lernen",
         "  poti on|off/alpha <0..1>/delta <0..0.5>/off <0..0.5>/sample <ms>/calib <min> <max>/invert on|off - Poti-Config",
         "  push on|off/debounce <ms>/double <ms>/hold <ms>/step_ms <ms>/step <0..0.5> - Taster-Config",
         "  midi map           - CC7=bri, CC20=mode(1-8), Note59 toggle, Note60 prev, Note62 next, Note70-77 mode 1-8",
@@ -754,6 +751,15 @@ void printHelp(const bool &force)
         "  calibrate         - Touch-Baseline neu messen",
         "  touch             - aktuellen Touch-Rohwert anzeigen",
         "  status            - aktuellen Zustand anzeigen",
+        "  sub [all|none|<topics>|rate <topic> <ms>] - Feedback-Topics dieses Clients",
+        "  telem on|off [Hz] / ble|usb on|off / rate <10-50> - Binär-Telemetrie",
+        "  log [level <0-5>]  - Ausgabe-Puffer/Drops, Log-Level",
+        "  get [key] / set <key> <val> - Einstellung lesen/setzen (Schlüssel wie cfg import)",
+        "  nvs [flush|delay <ms>] - Verzögertes Speichern, NVS-Schreibzähler",
+        "  cfg snap / cfg put <b64> / cfg apply - Binär-Snapshot aller Einstellungen (Backup/Klonen)",
+        "  tok [on|off]       - Tokenisierte Log-Zeilen für diesen Client",
+        "  rtc               - Reset-Grund, Warmstart-Wiederherstellung (µs)",
+        "  boot              - Boot-Phasen mit Zeitstempeln, Zeit bis zum ersten Licht",
         "  factory           - Reset aller Settings",
         "  help              - diese Übersicht",
     };
@@ -0,0 +1,414 @@
+/**
+ * @file profiles.cpp
+ * @brief Binary profile scenes: RAM cache, capture/apply, NVS storage and text-profile migration.
+ */
+
+#include "profiles.h"
+
+#include <string.h>
+
+#include "lamp_config.h"
+#include "persistence.h"
+#include "pattern.h"
+#include "patterns.h"
+#include "lamp_state.h"
+#include "lightSensor.h"
+#include "microphone.h"
+#include "settings_registry.h"
+#include "events.h"
+#include "tokenlog.h"
+#include "utils.h"
+
+const uint8_t PROFILE_SLOTS = Settings::PROFILE_SLOTS;
+
+namespace
+{
+  const char *const SCENE_KEY_BASE = "scene";    // scene<N>: binary ProfileScene
+  const char *const LEGACY_KEY_BASE = "profile"; // profile<N>: old cfg-import text (slots 1..3)
+
+  constexpr uint32_t DEFAULT_FIELDS = SCENE_PATTERN | SCENE_BRI | SCENE_AUTO | SCENE_PAT_SCALE | SCENE_PAT_FADE |
+                                      SCENE_PAT_FADE_AMT | SCENE_PAT_INV | SCENE_PAT_LO | SCENE_PAT_HI |
+                                      SCENE_EASE_ON | SCENE_EASE_OFF | SCENE_POW_ON | SCENE_POW_OFF |
+                                      SCENE_RAMP_ON | SCENE_RAMP_OFF | SCENE_RAMP_AMB | SCENE_BRI_MIN | SCENE_BRI_MAX;
+
+  // Built-in scenes for slots 1..3 (used while the slot is empty).
+  // A: full brightness, B: half brightness, C: half brightness sine; all ease-out ramps.
+  const ProfileScene DEFAULT_SCENES[3] = {
+      {PROFILE_SCENE_VERSION, 0, SCENE_FLAG_PAT_FADE, 3, 3, 0, 1000, DEFAULT_FIELDS, 0, 320, 600, 0,
+       1.0f, 0.01f, 0.0f, 1.0f, 7.0f, 2.0f, 0.05f, 0.95f, 0, 0.0f, 0, 0, 0, 0, 0, 0},
+      {PROFILE_SCENE_VERSION, 0, SCENE_FLAG_PAT_FADE, 3, 3, 0, 500, DEFAULT_FIELDS, 0, 320, 600, 0,
+       1.0f, 0.01f, 0.0f, 1.0f, 7.0f, 2.0f, 0.05f, 0.95f, 0, 0.0f, 0, 0, 0, 0, 0, 0},
+      {PROFILE_SCENE_VERSION, 4, SCENE_FLAG_PAT_FADE, 3, 3, 0, 500, DEFAULT_FIELDS, 0, 320, 600, 0,
+       1.0f, 0.01f, 0.0f, 1.0f, 7.0f, 2.0f, 0.05f, 0.95f, 0, 0.0f, 0, 0, 0, 0, 0, 0},
+  };
+
+  // Float fields by registry key: ranges and targets come from settings_registry.cpp.
+  struct SceneValue
+  {
+    const char *key;
+    uint32_t field;
+    float ProfileScene::*member;
+  };
+  const SceneValue SCENE_VALUES[] = {
+      {"pat_scale", SCENE_PAT_SCALE, &ProfileScene::patScale},
+      {"pat_fade_amt", SCENE_PAT_FADE_AMT, &ProfileScene::patFadeAmt},
+      {"pat_lo", SCENE_PAT_LO, &ProfileScene::patLo},
+      {"pat_hi", SCENE_PAT_HI, &ProfileScene::patHi},
+      {"ramp_on_pow", SCENE_POW_ON, &ProfileScene::powOn},
+      {"ramp_off_pow", SCENE_POW_OFF, &ProfileScene::powOff},
+      {"bri_min", SCENE_BRI_MIN, &ProfileScene::briMin},
+      {"bri_max", SCENE_BRI_MAX, &ProfileScene::briMax},
+      {"pwm_gamma", SCENE_GAMMA, &ProfileScene::gamma},
+      {"ramp_amb", SCENE_RAMP_AMB, &ProfileScene::rampAmb},
+      {"light_gain", SCENE_LIGHT_GAIN, &ProfileScene::lightGain},
+      {"light_min", SCENE_LIGHT_MIN, &ProfileScene::lightMin},
+      {"light_max", SCENE_LIGHT_MAX, &ProfileScene::lightMax},
+      {"light_alpha", SCENE_LIGHT_ALPHA, &ProfileScene::lightAlpha},
+      {"music_gain", SCENE_MUSIC_GAIN, &ProfileScene::musicGain},
+      {"clap_thr", SCENE_CLAP_THR, &ProfileScene::clapThr},
+  };
+
+  // NVS blob: the scene followed by a CRC-32 over it.
+  struct __attribute__((packed)) StoredScene
+  {
+    ProfileScene scene;
+    uint32_t crc;
+  };
+
+  ProfileScene cache[Settings::PROFILE_SLOTS]; // version 0 = empty
+  uint32_t lastRecallUs = 0;
+  uint8_t lastRecallSlot = 0;
+
+  String slotKey(const char *base, uint8_t slot)
+  {
+    return String(base) + String(slot);
+  }
+
+  uint32_t sceneCrc(const ProfileScene &s)
+  {
+    return crc32Update(0, reinterpret_cast<const uint8_t *>(&s), sizeof(s));
+  }
+
+  bool storeScene(uint8_t slot, const ProfileScene &s)
+  {
+    StoredScene rec;
+    rec.scene = s;
+    rec.crc = sceneCrc(s);
+    return prefs.putBytes(slotKey(SCENE_KEY_BASE, slot).c_str(), &rec, sizeof(rec)) == sizeof(rec);
+  }
+
+  /**
+   * @brief Range-check and assign through the settings registry; settings absent from this build are skipped.
+   */
+  void assignSetting(const char *key, float v)
+  {
+    const SettingDef *def = settingFind(key);
+    if (def)
+      settingAssign(*def, v);
+  }
+
+  void setDefaultScene(uint8_t slot)
+  {
+    if (slot >= 1 && slot <= 3)
+      cache[slot - 1] = DEFAULT_SCENES[slot - 1];
+    else
+      memset(&cache[slot - 1], 0, sizeof(ProfileScene));
+  }
+
+  void captureScene(ProfileScene &s)
+  {
+    memset(&s, 0, sizeof(s));
+    s.version = PROFILE_SCENE_VERSION;
+    s.fields = SCENE_PATTERN | SCENE_BRI | SCENE_AUTO | SCENE_PAT_SCALE | SCENE_RAMP | SCENE_RAMP_ON |
+               SCENE_RAMP_OFF | SCENE_PAT_FADE | SCENE_PAT_FADE_AMT | SCENE_PAT_INV | SCENE_PAT_LO | SCENE_PAT_HI |
+               SCENE_EASE_ON | SCENE_EASE_OFF | SCENE_POW_ON | SCENE_POW_OFF | SCENE_BRI_MIN | SCENE_BRI_MAX |
+               SCENE_GAMMA;
+    s.pattern = (uint8_t)currentPattern;
+    s.bri1000 = (uint16_t)(clamp01(masterBrightness) * 1000.0f + 0.5f);
+    s.flags = (autoCycle ? SCENE_FLAG_AUTO : 0) | (patternFadeEnabled ? SCENE_FLAG_PAT_FADE : 0) |
+              (patternInvert ? SCENE_FLAG_PAT_INV : 0);
+    s.rampMs = (uint16_t)rampDurationMs;
+    s.rampOnMs = (uint16_t)rampOnDurationMs;
+    s.rampOffMs = (uint16_t)rampOffDurationMs;
+    s.easeOn = rampEaseOnType;
+    s.easeOff = rampEaseOffType;
+#if ENABLE_LIGHT_SENSOR
+    s.fields |= SCENE_RAMP_AMB | SCENE_LIGHT_GAIN | SCENE_LIGHT_MIN | SCENE_LIGHT_MAX | SCENE_LIGHT_ALPHA | SCENE_LIGHT_EN;
+    if (lightSensorEnabled)
+      s.flags |= SCENE_FLAG_LIGHT_EN;
+#endif
+#if ENABLE_MUSIC_MODE
+    s.fields |= SCENE_MUSIC_EN | SCENE_MUSIC_GAIN | SCENE_CLAP_EN | SCENE_CLAP_THR | SCENE_CLAP_COOL;
+    s.clapCoolMs = (uint16_t)clapCooldownMs;
+    if (musicEnabled)
+      s.flags |= SCENE_FLAG_MUSIC_EN;
+    if (clapEnabled)
+      s.flags |= SCENE_FLAG_CLAP_EN;
+#endif
+    for (const SceneValue &sv : SCENE_VALUES)
+    {
+      const SettingDef *def = settingFind(sv.key);
+      if (def && (s.fields & sv.field))
+        s.*(sv.member) = settingValue(*def);
+      else
+        s.fields &= ~sv.field;
+    }
+  }
+
+  void applyScene(const ProfileScene &s)
+  {
+    // Every value goes through the registry's range check: a bad record cannot push live settings out of range.
+    const uint32_t f = s.fields;
+    if (f & SCENE_BRI)
+      masterBrightness = clamp01(s.bri1000 / 1000.0f);
+    if (f & SCENE_AUTO)
+      autoCycle = (s.flags & SCENE_FLAG_AUTO) != 0;
+    if ((f & SCENE_RAMP) && s.rampMs >= 50 && s.rampMs <= 10000)
+      rampDurationMs = s.rampMs;
+    if (f & SCENE_RAMP_ON)
+      assignSetting("ramp_on_ms", s.rampOnMs);
+    if (f & SCENE_RAMP_OFF)
+      assignSetting("ramp_off_ms", s.rampOffMs);
+    if (f & SCENE_PAT_FADE)
+      patternFadeEnabled = (s.flags & SCENE_FLAG_PAT_FADE) != 0;
+    if (f & SCENE_PAT_INV)
+      patternInvert = (s.flags & SCENE_FLAG_PAT_INV) != 0;
+    if (f & SCENE_EASE_ON)
+      assignSetting("ramp_on_ease", s.easeOn);
+    if (f & SCENE_EASE_OFF)
+      assignSetting("ramp_off_ease", s.easeOff);
+    for (const SceneValue &sv : SCENE_VALUES)
+    {
+      if (f & sv.field)
+        assignSetting(sv.key, s.*(sv.member));
+    }
+#if ENABLE_LIGHT_SENSOR
+    if (f & SCENE_LIGHT_EN)
+      lightSensorEnabled = (s.flags & SCENE_FLAG_LIGHT_EN) != 0;
+#endif
+#if ENABLE_MUSIC_MODE
+    if (f & SCENE_MUSIC_EN)
+      musicEnabled = (s.flags & SCENE_FLAG_MUSIC_EN) != 0;
+    if (f & SCENE_CLAP_EN)
+      clapEnabled = (s.flags & SCENE_FLAG_CLAP_EN) != 0;
+    if (f & SCENE_CLAP_COOL)
+      assignSetting("clap_cool", s.clapCoolMs);
+#endif
+    sanitizeLinkedSettings();
+    // setPattern() last: music patterns override musicEnabled/musicMode
+    if ((f & SCENE_PATTERN) && s.pattern < PATTERN_COUNT)
+      setPattern(s.pattern, false, false);
+  }
+
+  /**
+   * @brief Parse an old text profile (cfg import keys) into a scene; unknown keys are ignored.
+   */
+  void sceneFromText(const String &cfg, ProfileScene &s)
+  {
+    memset(&s, 0, sizeof(s));
+    s.version = PROFILE_SCENE_VERSION;
+    int start = 0;
+    while (start < (int)cfg.length())
+    {
+      int end = cfg.indexOf(' ', start);
+      if (end < 0)
+        end = cfg.length();
+      String tok = cfg.substring(start, end);
+      start = end + 1;
+      int eq = tok.indexOf('=');
+      if (eq <= 0)
+        continue;
+      String key = tok.substring(0, eq);
+      String val = tok.substring(eq + 1);
+      key.toLowerCase();
+      struct BoolKey
+      {
+        const char *key;
+        uint32_t field;
+        uint8_t flag;
+      };
+      static const BoolKey BOOL_KEYS[] = {
+          {"auto", SCENE_AUTO, SCENE_FLAG_AUTO},
+          {"pat_fade", SCENE_PAT_FADE, SCENE_FLAG_PAT_FADE},
+          {"pat_inv", SCENE_PAT_INV, SCENE_FLAG_PAT_INV},
+          {"light", SCENE_LIGHT_EN, SCENE_FLAG_LIGHT_EN},
+          {"music", SCENE_MUSIC_EN, SCENE_FLAG_MUSIC_EN},
+          {"clap", SCENE_CLAP_EN, SCENE_FLAG_CLAP_EN},
+      };
+      bool handled = false;
+      for (const BoolKey &bk : BOOL_KEYS)
+      {
+        bool b;
+        if (key == bk.key)
+        {
+          handled = true;
+          if (parseBool(val, b))
+          {
+            s.fields |= bk.field;
+            if (b)
+              s.flags |= bk.flag;
+          }
+          break;
+        }
+      }
+      if (handled)
+        continue;
+      const float v = val.toFloat();
+      if (key == "mode" && v >= 1 && v <= PATTERN_COUNT)
+      {
+        s.pattern = (uint8_t)(v - 1);
+        s.fields |= SCENE_PATTERN;
+      }
+      else if (key == "bri")
+      {
+        s.bri1000 = (uint16_t)(clamp01(v) * 1000.0f + 0.5f);
+        s.fields |= SCENE_BRI;
+      }
+      else if (key == "ramp" && v >= 50 && v <= 10000)
+      {
+        s.rampMs = s.rampOnMs = s.rampOffMs = (uint16_t)v;
+        s.fields |= SCENE_RAMP | SCENE_RAMP_ON | SCENE_RAMP_OFF;
+      }
+      else if (key == "ramp_on_ms" && v >= 50 && v <= 10000)
+      {
+        s.rampOnMs = (uint16_t)v;
+        s.fields |= SCENE_RAMP_ON;
+      }
+      else if (key == "ramp_off_ms" && v >= 50 && v <= 10000)
+      {
+        s.rampOffMs = (uint16_t)v;
+        s.fields |= SCENE_RAMP_OFF;
+      }
+      else if (key == "ramp_on_ease")
+      {
+        s.easeOn = easeFromString(val);
+        s.fields |= SCENE_EASE_ON;
+      }
+      else if (key == "ramp_off_ease")
+      {
+        s.easeOff = easeFromString(val);
+        s.fields |= SCENE_EASE_OFF;
+      }
+      else if (key == "clap_cool" && v >= 200 && v <= 5000)
+      {
+        s.clapCoolMs = (uint16_t)v;
+        s.fields |= SCENE_CLAP_COOL;
+      }
+      else
+      {
+        // Float fields: range-checked when the scene is applied
+        for (const SceneValue &sv : SCENE_VALUES)
+        {
+          if (key == sv.key)
+          {
+            s.*(sv.member) = v;
+            s.fields |= sv.field;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+void profilesBegin()
+{
+  for (uint8_t slot = 1; slot <= Settings::PROFILE_SLOTS; ++slot)
+  {
+    ProfileScene &s = cache[slot - 1];
+    const String key = slotKey(SCENE_KEY_BASE, slot);
+    if (prefs.isKey(key.c_str()))
+    {
+      StoredScene rec;
+      if (prefs.getBytes(key.c_str(), &rec, sizeof(rec)) == sizeof(rec) && rec.crc == sceneCrc(rec.scene) &&
+          rec.scene.version == PROFILE_SCENE_VERSION)
+      {
+        s = rec.scene;
+        continue;
+      }
+      TLOG("[Profile] Slot %d record invalid, ignored", slot);
+    }
+    setDefaultScene(slot);
+    if (slot > 3)
+      continue;
+    // One-time migration of the old text profiles
+    const String legacy = slotKey(LEGACY_KEY_BASE, slot);
+    if (!prefs.isKey(legacy.c_str()))
+      continue;
+    String cfg = prefs.getString(legacy.c_str(), "");
+    if (cfg.length() > 0)
+    {
+      sceneFromText(cfg, s);
+      storeScene(slot, s);
+    }
+    prefs.remove(legacy.c_str());
+  }
+}
+
+void profilesReset()
+{
+  for (uint8_t slot = 1; slot <= Settings::PROFILE_SLOTS; ++slot)
+    setDefaultScene(slot);
+}
+
+bool profileSlotUsed(uint8_t slot)
+{
+  return slot >= 1 && slot <= Settings::PROFILE_SLOTS && cache[slot - 1].version != 0;
+}
+
+bool saveProfileSlot(uint8_t slot)
+{
+  if (slot < 1 || slot > Settings::PROFILE_SLOTS)
+    return false;
+  ProfileScene &s = cache[slot - 1];
+  captureScene(s);
+  return storeScene(slot, s);
+}
+
+bool clearProfileSlot(uint8_t slot)
+{
+  if (slot < 1 || slot > Settings::PROFILE_SLOTS)
+    return false;
+  const String key = slotKey(SCENE_KEY_BASE, slot);
+  if (prefs.isKey(key.c_str()))
+    prefs.remove(key.c_str());
+  setDefaultScene(slot);
+  return true;
+}
+
+bool loadProfileSlot(uint8_t slot, bool announce, bool persist)
+{
+  if (!profileSlotUsed(slot))
+  {
+    if (announce)
+      TLOG("[Profile] Slot empty");
+    return false;
+  }
+  const uint32_t startUs = micros();
+  applyScene(cache[slot - 1]);
+  currentModeIndex = PATTERN_COUNT + (slot - 1);
+  lastRecallUs = micros() - startUs;
+  lastRecallSlot = slot;
+  postEvent(EVT_BRIGHTNESS | EVT_PATTERN | EVT_STATE, "profile");
+  if (persist)
+    saveSettings();
+  if (announce)
+    TLOG("[Profile] Loaded slot %d (%lu us)", slot, (unsigned long)lastRecallUs);
+  return true;
+}
+
+void profileStatsFeedback()
+{
+  String used;
+  uint8_t count = 0;
+  for (uint8_t slot = 1; slot <= Settings::PROFILE_SLOTS; ++slot)
+  {
+    if (!profileSlotUsed(slot))
+      continue;
+    if (count++)
+      used += ',';
+    used += slot;
+  }
+  TLOG("[Profile] slots=%d/%d used=%s record=%dB ram=%dB last=%d recall=%lu us", count, Settings::PROFILE_SLOTS, used,
+       (int)sizeof(ProfileScene), (int)sizeof(cache), lastRecallSlot, (unsigned long)lastRecallUs);
+}
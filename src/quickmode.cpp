@@ -3,6 +3,7 @@
 #include "pattern.h"
 #include "patterns.h"
 #include "persistence.h"
+#include "profiles.h"
 #include "comms.h"
 
 uint64_t quickMask = 0; // bitmask of modes used for quick switch tap cycling (supports up to 64 entries)
@@ -0,0 +1,174 @@
+/**
+ * @file rtc_state.cpp
+ * @brief RTC slow-memory mirror of the live lamp state and early warm-reset restore.
+ */
+
+#include "rtc_state.h"
+
+#if ENABLE_RTC_RESTORE
+
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "settings.h"
+#include "pinout.h"
+#include "lamp_state.h"
+#include "pattern.h"
+#include "patterns.h"
+#include "events.h"
+#include "boot_profile.h"
+#include "tokenlog.h"
+#include "utils.h"
+
+namespace
+{
+  constexpr uint32_t RTC_MAGIC = 0x31524C51; // "QLR1"
+
+  struct RtcLampState
+  {
+    uint32_t magic;
+    uint8_t lampOn;
+    uint8_t quickResets; // warm resets before reaching RTC_STABLE_MS uptime
+    uint16_t pattern;
+    float brightness;
+    float lastOnBrightness;
+    uint32_t pwmRaw;  // last value written to the output
+    uint32_t phaseMs; // time into the current pattern
+    uint32_t crc;     // over all fields above
+  };
+
+  RTC_NOINIT_ATTR RtcLampState rtcRecord;
+
+  RtcLampState restored = {};
+  bool restoredValid = false;
+  bool bootStable = false;
+  uint8_t quickResets = 0; // this boot included; carried over refused restores as well
+  esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+  uint32_t restoreUs = 0; // micros() since boot when the output was driven again
+
+  uint32_t recordCrc(const RtcLampState &r)
+  {
+    return crc32Update(0, reinterpret_cast<const uint8_t *>(&r), offsetof(RtcLampState, crc));
+  }
+
+  bool warmReason(esp_reset_reason_t reason)
+  {
+    switch (reason)
+    {
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  const char *reasonName(esp_reset_reason_t reason)
+  {
+    switch (reason)
+    {
+    case ESP_RST_POWERON:
+      return "poweron";
+    case ESP_RST_EXT:
+      return "ext";
+    case ESP_RST_SW:
+      return "sw";
+    case ESP_RST_PANIC:
+      return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+      return "wdt";
+    case ESP_RST_BROWNOUT:
+      return "brownout";
+    case ESP_RST_DEEPSLEEP:
+      return "deepsleep";
+    default:
+      return "other";
+    }
+  }
+} // namespace
+
+bool rtcStateRestoreOutput()
+{
+  resetReason = esp_reset_reason();
+  RtcLampState r = rtcRecord;
+  const bool valid = r.magic == RTC_MAGIC && r.crc == recordCrc(r);
+  rtcRecord.magic = 0; // rewritten by rtcStateUpdate() once the loop runs
+  if (!valid || !warmReason(resetReason))
+    return false;
+  // Count every warm reset before stable uptime, restored or not: a refused
+  // restore must not re-arm the guard for the next crash.
+  quickResets = r.quickResets < 255 ? r.quickResets + 1 : 255;
+  if (r.quickResets >= Settings::RTC_MAX_QUICK_RESETS)
+    return false;
+
+  restored = r;
+  restoredValid = true;
+  uint32_t raw = r.lampOn ? r.pwmRaw : OFF_RAW;
+  if (raw > (uint32_t)PWM_MAX)
+    raw = OFF_RAW;
+#if ENABLE_ANALOG_OUTPUT
+  dacWrite(PIN_OUTPUT, (uint8_t)raw);
+#else
+  ledcSetup(LEDC_CH, LEDC_FREQ, LEDC_RES);
+  ledcAttachPin(PIN_OUTPUT, LEDC_CH);
+  ledcWrite(LEDC_CH, raw);
+#endif
+  lastPwmValue = raw;
+  if (raw != OFF_RAW)
+    bootMarkLight();
+  restoreUs = micros();
+  return true;
+}
+
+void rtcStateApply()
+{
+  if (!restoredValid)
+    return;
+  masterBrightness = clamp01(restored.brightness);
+  lastLoggedBrightness = masterBrightness;
+  if (restored.lastOnBrightness > 0.0f)
+    lastOnBrightness = clamp01(restored.lastOnBrightness);
+  if (restored.pattern < PATTERN_COUNT)
+    setPattern(restored.pattern, false, false);
+  patternStartMs = millis() - restored.phaseMs;
+  rampActive = false;
+  lampOffPending = false;
+  lampEnabled = restored.lampOn != 0;
+  outputScale = lampEnabled ? 1.0f : 0.0f;
+  postEvent(EVT_LAMP | EVT_BRIGHTNESS | EVT_PATTERN, "rtc restore");
+  TLOG("[RTC] Warm reset (%s): light restored after %lu us", reasonName(resetReason), (unsigned long)restoreUs);
+}
+
+void rtcStateUpdate()
+{
+  RtcLampState r;
+  memset(&r, 0, sizeof(r));
+  r.magic = RTC_MAGIC;
+  r.lampOn = lampEnabled ? 1 : 0;
+  if (!bootStable && millis() >= Settings::RTC_STABLE_MS)
+    bootStable = true;
+  r.quickResets = bootStable ? 0 : quickResets;
+  r.pattern = (uint16_t)currentPattern;
+  r.brightness = masterBrightness;
+  r.lastOnBrightness = lastOnBrightness;
+  r.pwmRaw = lastPwmValue;
+  r.phaseMs = millis() - patternStartMs;
+  r.crc = recordCrc(r);
+  rtcRecord = r;
+}
+
+void rtcStateFeedback()
+{
+  TLOG("[RTC] reset=%s warm=%s restore=%lu us quick=%d", reasonName(resetReason), restoredValid ? "yes" : "no",
+       (unsigned long)restoreUs, (int)quickResets);
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file settings_blob.cpp
+ * @brief A/B slot settings record: load/validate, lookup and alternate-slot commit.
+ */
+
+#include "settings_blob.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "utils.h"
+
+namespace
+{
+  constexpr uint32_t BLOB_MAGIC = 0x31534C51; // "QLS1"
+  constexpr uint16_t BLOB_VERSION = 1;
+  const char *const SLOT_KEYS[2] = {"cfg_a", "cfg_b"};
+
+  struct __attribute__((packed)) BlobHeader
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t records;
+    uint32_t seq;
+    uint32_t payloadLen;
+    uint32_t crc; // over header (crc = 0) and payload
+  };
+
+  struct IndexEntry
+  {
+    uint32_t hash;
+    uint32_t offset; // value bytes in loaded
+    uint16_t len;
+  };
+
+  std::vector<uint8_t> loaded;      // newest valid record (boot only)
+  std::vector<IndexEntry> keyIndex; // loaded's records sorted by key hash (boot only)
+  std::vector<uint8_t> pending;     // record under construction
+  uint16_t pendingRecords = 0;
+  uint32_t activePayloadCrc = 0; // newest slot, for skipping identical saves
+  uint32_t activePayloadLen = 0;
+  SettingsBlobInfo info = {};
+
+  uint32_t keyHash(const char *key)
+  {
+    uint32_t h = 2166136261u;
+    for (const char *c = key; *c; ++c)
+      h = (h ^ (uint8_t)*c) * 16777619u;
+    return h;
+  }
+
+  uint32_t blobCrc(const uint8_t *buf, size_t len)
+  {
+    BlobHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    hdr.crc = 0;
+    uint32_t crc = crc32Update(0, reinterpret_cast<const uint8_t *>(&hdr), sizeof(hdr));
+    return crc32Update(crc, buf + sizeof(hdr), len - sizeof(hdr));
+  }
+
+  /**
+   * @brief Read one slot into @p out; true if magic, version, length and CRC check out.
+   */
+  bool readSlot(Preferences &prefs, uint8_t slot, std::vector<uint8_t> &out)
+  {
+    const size_t len = prefs.getBytesLength(SLOT_KEYS[slot]);
+    if (len < sizeof(BlobHeader))
+      return false;
+    out.resize(len);
+    if (prefs.getBytes(SLOT_KEYS[slot], out.data(), len) != len)
+      return false;
+    BlobHeader hdr;
+    memcpy(&hdr, out.data(), sizeof(hdr));
+    if (hdr.magic != BLOB_MAGIC || hdr.version != BLOB_VERSION || hdr.payloadLen != len - sizeof(hdr))
+      return false;
+    return hdr.crc == blobCrc(out.data(), len);
+  }
+
+  /**
+   * @brief One pass over the loaded record into a hash-sorted index (stops at a record running past the end).
+   */
+  void buildIndex()
+  {
+    keyIndex.clear();
+    size_t pos = sizeof(BlobHeader);
+    while (pos + 6 <= loaded.size())
+    {
+      IndexEntry e;
+      memcpy(&e.hash, &loaded[pos], 4);
+      memcpy(&e.len, &loaded[pos + 4], 2);
+      pos += 6;
+      if (pos + e.len > loaded.size())
+        break;
+      e.offset = (uint32_t)pos;
+      keyIndex.push_back(e);
+      pos += e.len;
+    }
+    // Stable: on a hash collision the first record wins, as with a linear scan
+    std::stable_sort(keyIndex.begin(), keyIndex.end(), [](const IndexEntry &a, const IndexEntry &b) { return a.hash < b.hash; });
+  }
+
+  size_t nvsBlobFlashBytes(size_t len)
+  {
+    // blob index entry + data header entry + 32-byte data entries
+    return 32 * (2 + (len + 31) / 32);
+  }
+} // namespace
+
+bool settingsBlobLoad(Preferences &prefs)
+{
+  std::vector<uint8_t> slotBuf[2];
+  bool ok[2];
+  uint32_t seq[2] = {0, 0};
+  for (uint8_t s = 0; s < 2; ++s)
+  {
+    ok[s] = readSlot(prefs, s, slotBuf[s]);
+    if (ok[s])
+    {
+      BlobHeader hdr;
+      memcpy(&hdr, slotBuf[s].data(), sizeof(hdr));
+      seq[s] = hdr.seq;
+    }
+  }
+  info = SettingsBlobInfo();
+  loaded.clear();
+  keyIndex.clear();
+  if (!ok[0] && !ok[1])
+    return false;
+  // Newest by wrap-safe sequence compare
+  const uint8_t pick = (ok[0] && ok[1]) ? ((int32_t)(seq[1] - seq[0]) > 0 ? 1 : 0) : (ok[1] ? 1 : 0);
+  loaded.swap(slotBuf[pick]);
+  BlobHeader hdr;
+  memcpy(&hdr, loaded.data(), sizeof(hdr));
+  info.valid = true;
+  info.slot = pick;
+  info.seq = hdr.seq;
+  info.records = hdr.records;
+  info.bytes = loaded.size();
+  activePayloadLen = hdr.payloadLen;
+  activePayloadCrc = crc32Update(0, loaded.data() + sizeof(hdr), hdr.payloadLen);
+  keyIndex.reserve(hdr.records);
+  buildIndex();
+  return true;
+}
+
+bool settingsBlobFind(const char *key, const uint8_t *&data, uint16_t &len)
+{
+  const uint32_t kh = keyHash(key);
+  const auto it = std::lower_bound(keyIndex.begin(), keyIndex.end(), kh,
+                                   [](const IndexEntry &e, uint32_t h) { return e.hash < h; });
+  if (it == keyIndex.end() || it->hash != kh)
+    return false;
+  data = &loaded[it->offset];
+  len = it->len;
+  return true;
+}
+
+void settingsBlobRelease()
+{
+  std::vector<uint8_t>().swap(loaded);
+  std::vector<IndexEntry>().swap(keyIndex);
+}
+
+void settingsBlobBegin()
+{
+  pending.clear();
+  pending.reserve(info.bytes ? info.bytes + 64 : 1024);
+  pending.resize(sizeof(BlobHeader));
+  pendingRecords = 0;
+}
+
+void settingsBlobAppend(const char *key, const void *data, uint16_t len)
+{
+  const uint32_t kh = keyHash(key);
+  const size_t pos = pending.size();
+  pending.resize(pos + 6 + len);
+  memcpy(&pending[pos], &kh, 4);
+  memcpy(&pending[pos + 4], &len, 2);
+  if (len)
+    memcpy(&pending[pos + 6], data, len);
+  pendingRecords++;
+}
+
+size_t settingsBlobCommit(Preferences &prefs, bool &failed)
+{
+  failed = false;
+  const uint8_t *payload = pending.data() + sizeof(BlobHeader);
+  const size_t payloadLen = pending.size() - sizeof(BlobHeader);
+  const uint32_t payloadCrc = crc32Update(0, payload, payloadLen);
+  if (info.valid && payloadLen == activePayloadLen && payloadCrc == activePayloadCrc)
+  {
+    // Same content as the newest slot: nothing to write.
+    std::vector<uint8_t>().swap(pending);
+    return 0;
+  }
+  BlobHeader hdr;
+  hdr.magic = BLOB_MAGIC;
+  hdr.version = BLOB_VERSION;
+  hdr.records = pendingRecords;
+  hdr.seq = info.seq + 1;
+  hdr.payloadLen = payloadLen;
+  hdr.crc = 0;
+  memcpy(pending.data(), &hdr, sizeof(hdr));
+  hdr.crc = blobCrc(pending.data(), pending.size());
+  memcpy(pending.data(), &hdr, sizeof(hdr));
+  const uint8_t slot = info.valid ? (uint8_t)(info.slot ^ 1) : 0;
+  const bool ok = prefs.putBytes(SLOT_KEYS[slot], pending.data(), pending.size()) == pending.size();
+  const size_t total = pending.size();
+  std::vector<uint8_t>().swap(pending);
+  if (!ok)
+  {
+    failed = true;
+    return 0;
+  }
+  info.valid = true;
+  info.slot = slot;
+  info.seq = hdr.seq;
+  info.records = hdr.records;
+  info.bytes = total;
+  activePayloadCrc = payloadCrc;
+  activePayloadLen = payloadLen;
+  return nvsBlobFlashBytes(total);
+}
+
+void settingsBlobReset()
+{
+  info = SettingsBlobInfo();
+  activePayloadCrc = 0;
+  activePayloadLen = 0;
+}
+
+const SettingsBlobInfo &settingsBlobInfo()
+{
+  return info;
+}
@@ -0,0 +1,363 @@
+/**
+ * @file settings_registry.cpp
+ * @brief Settings table, hashed key index and typed get/set/format helpers.
+ */
+
+#include "settings_registry.h"
+
+#include <string.h>
+
+#include "settings.h"
+#include "lamp_state.h"
+#include "pattern.h"
+#include "inputs.h"
+#include "lightSensor.h"
+#include "microphone.h"
+#include "notifications.h"
+#include "presence.h"
+#include "filters.h"
+#include "tokenlog.h"
+#include "utils.h"
+
+namespace
+{
+  constexpr uint8_t STD = SETTING_PERSIST | SETTING_EXPORT | SETTING_STATUS;
+  constexpr uint8_t CLAMP = STD | SETTING_CLAMP;
+
+  constexpr SettingDef S(const char *key, const char *prefKey, SettingType type, void *ptr,
+                         float minVal, float maxVal, float defVal, uint8_t decimals, uint8_t flags)
+  {
+    return SettingDef{key, prefKey, tokenFnv1a(key), type, ptr, minVal, maxVal, defVal, decimals, flags};
+  }
+
+  constexpr SettingDef TABLE[] = {
+      S("auto", "auto", SettingType::Bool, &autoCycle, 0, 1, Settings::DEFAULT_AUTOCYCLE, 0, STD),
+      S("pat_scale", "pat_scale", SettingType::Float, &patternSpeedScale, 0.1f, 5.0f, 1.0f, 2, STD),
+      S("pat_fade", "pat_fade", SettingType::Bool, &patternFadeEnabled, 0, 1, 0, 0, STD),
+      S("pat_fade_amt", "pat_fade_amt", SettingType::Float, &patternFadeStrength, 0.01f, 10.0f, 1.0f, 2, STD),
+      S("pat_inv", "pat_inv", SettingType::Bool, &patternInvert, 0, 1, Settings::PATTERN_INVERT_DEFAULT, 0, STD),
+      S("pat_lo", "pat_lo", SettingType::Float, &patternMarginLow, 0.0f, 1.0f, Settings::PATTERN_MARGIN_LOW_DEFAULT, 3, CLAMP),
+      S("pat_hi", "pat_hi", SettingType::Float, &patternMarginHigh, 0.0f, 1.0f, Settings::PATTERN_MARGIN_HIGH_DEFAULT, 3, CLAMP),
+      S("custom_ms", "cust_ms", SettingType::U32, &customStepMs, 20, 5000, Settings::CUSTOM_STEP_MS_DEFAULT, 0, STD),
+      S("ramp_on_ms", "ramp_on_ms", SettingType::U32, &rampOnDurationMs, 50, 10000, Settings::DEFAULT_RAMP_ON_MS, 0, STD),
+      S("ramp_off_ms", "ramp_off_ms", SettingType::U32, &rampOffDurationMs, 50, 10000, Settings::DEFAULT_RAMP_OFF_MS, 0, STD),
+      S("ramp_on_ease", "ramp_e_on", SettingType::Ease, &rampEaseOnType, 0, 7, Settings::DEFAULT_RAMP_EASE_ON, 0, STD),
+      S("ramp_off_ease", "ramp_e_off", SettingType::Ease, &rampEaseOffType, 0, 7, Settings::DEFAULT_RAMP_EASE_OFF, 0, STD),
+      S("ramp_on_pow", "ramp_p_on", SettingType::Float, &rampEaseOnPower, 0.01f, 10.0f, Settings::DEFAULT_RAMP_POW_ON, 2, STD),
+      S("ramp_off_pow", "ramp_p_off", SettingType::Float, &rampEaseOffPower, 0.01f, 10.0f, Settings::DEFAULT_RAMP_POW_OFF, 2, STD),
+      S("pwm_gamma", "pwm_g", SettingType::Float, &outputGamma, 0.5f, 4.0f, Settings::PWM_GAMMA_DEFAULT, 2, STD),
+      S("bri_min", "bri_min", SettingType::Float, &briMinUser, 0.0f, 1.0f, Settings::BRI_MIN_DEFAULT, 3, CLAMP),
+      S("bri_max", "bri_max", SettingType::Float, &briMaxUser, 0.0f, 1.0f, Settings::BRI_MAX_DEFAULT, 3, CLAMP),
+      S("notif_min", "notif_min", SettingType::Float, &notifyMinBrightness, 0.0f, 1.0f, Settings::NOTIFY_MIN_BRI_DEFAULT, 2, CLAMP),
+      S("presence_en", "pres_en", SettingType::Bool, &presenceEnabled, 0, 1, Settings::PRESENCE_DEFAULT_ENABLED, 0, STD),
+      S("presence_thr", "pres_rssi", SettingType::Int, &presenceRssiThreshold, -120, -5, Settings::PRESENCE_RSSI_THRESHOLD_DEFAULT, 0, CLAMP),
+      S("presence_on", "pres_auto_on", SettingType::Bool, &presenceAutoOn, 0, 1, Settings::PRESENCE_AUTO_ON_DEFAULT, 0, STD),
+      S("presence_off", "pres_auto_off", SettingType::Bool, &presenceAutoOff, 0, 1, Settings::PRESENCE_AUTO_OFF_DEFAULT, 0, STD),
+      S("pres_grace", "pres_grace", SettingType::U32, &presenceGraceMs, 0, 3600000, Settings::PRESENCE_GRACE_MS_DEFAULT, 0, CLAMP),
+      S("light_gain", "light_gain", SettingType::Float, &lightGain, 0.1f, 5.0f, Settings::LIGHT_GAIN_DEFAULT, 2, CLAMP),
+      S("light_min", "lcl_min", SettingType::Float, &lightClampMin, 0.0f, 1.0f, Settings::LIGHT_CLAMP_MIN_DEFAULT, 2, STD),
+      S("light_max", "lcl_max", SettingType::Float, &lightClampMax, 0.0f, 1.5f, Settings::LIGHT_CLAMP_MAX_DEFAULT, 2, STD),
+#if ENABLE_LIGHT_SENSOR
+      S("light_en", "ls_en", SettingType::Bool, &lightSensorEnabled, 0, 1, Settings::LIGHT_SENSOR_DEFAULT_ENABLED, 0, STD),
+      S("light_alpha", "light_a", SettingType::Float, &lightAlpha, 0.001f, 0.8f, Settings::LIGHT_ALPHA, 3, CLAMP),
+      S("ramp_amb", "ramp_amb", SettingType::Float, &rampAmbientFactor, 0.0f, 5.0f, Settings::RAMP_AMBIENT_FACTOR_DEFAULT, 2, CLAMP),
+#endif
+#if ENABLE_TOUCH_DIM
+      S("touch_dim", "touch_dim", SettingType::Bool, &touchDimEnabled, 0, 1, Settings::TOUCH_DIM_DEFAULT_ENABLED, 0, STD),
+      S("touch_hold", "touch_hold", SettingType::U32, &touchHoldStartMs, 500, 5000, Settings::TOUCH_HOLD_MS_DEFAULT, 0, STD),
+      S("touch_dim_step", "touch_dim_step", SettingType::Float, &touchDimStep, 0.001f, 0.05f, Settings::TOUCH_DIM_STEP_DEFAULT, 3, CLAMP),
+#endif
+#if ENABLE_MUSIC_MODE
+      S("music_en", "music_en", SettingType::Bool, &musicEnabled, 0, 1, Settings::MUSIC_DEFAULT_ENABLED, 0, STD),
+      S("music_gain", "mus_gain", SettingType::Float, &musicGain, 0.1f, 12.0f, Settings::MUSIC_GAIN_DEFAULT, 2, CLAMP),
+      S("music_smooth", "mus_sm", SettingType::Float, &musicSmoothing, 0.0f, 1.0f, 0.4f, 2, CLAMP),
+      S("music_auto", "mus_auto", SettingType::Bool, &musicAutoLamp, 0, 1, 0, 0, STD),
+      S("music_auto_thr", "mus_thr", SettingType::Float, &musicAutoThr, 0.05f, 1.5f, 0.4f, 2, CLAMP),
+      S("music_mode", "mus_mode", SettingType::U8, &musicMode, 0, 1, 0, 0, STD),
+      S("music_band", "mus_band", SettingType::U8, &musicBand, 0, AUDIO_BAND_COUNT, AUDIO_BAND_BASS, 0, STD),
+      S("clap", "clap_en", SettingType::Bool, &clapEnabled, 0, 1, Settings::CLAP_DEFAULT_ENABLED, 0, STD),
+      S("clap_thr", "clap_thr", SettingType::Float, &clapThreshold, 0.05f, 1.5f, Settings::CLAP_THRESHOLD_DEFAULT, 2, STD),
+#if ENABLE_AUDIO_DMA
+      S("clap_peak", "clap_pk", SettingType::Float, &clapPeakThreshold, 0.02f, 1.0f, Settings::CLAP_PEAK_DEFAULT, 2, STD),
+#endif
+      S("clap_cool", "clap_cl", SettingType::U32, &clapCooldownMs, 200, 5000, Settings::CLAP_COOLDOWN_MS_DEFAULT, 0, STD),
+#endif
+#if ENABLE_EXT_INPUT
+      S("ext_en", "ext_en", SettingType::Bool, &extInputEnabled, 0, 1, 0, 0, STD),
+      S("ext_analog", "ext_mode", SettingType::Bool, &extInputAnalog, 0, 1, Settings::EXT_INPUT_ANALOG_DEFAULT, 0, STD),
+      S("ext_alpha", "ext_alpha", SettingType::Float, &extInputAlpha, 0.0f, 1.0f, Settings::EXT_INPUT_ALPHA, 3, CLAMP),
+      S("ext_delta", "ext_delta", SettingType::Float, &extInputDelta, 0.0f, 1.0f, Settings::EXT_INPUT_DELTA, 3, CLAMP),
+#endif
+#if ENABLE_POTI
+      S("poti_en", "poti_en", SettingType::Bool, &potiEnabled, 0, 1, 1, 0, STD),
+      S("poti_alpha", "poti_a", SettingType::Float, &potiAlpha, 0.01f, 1.0f, Settings::POTI_ALPHA, 2, CLAMP),
+      S("poti_delta", "poti_d", SettingType::Float, &potiDeltaMin, 0.001f, 0.5f, Settings::POTI_DELTA_MIN, 3, CLAMP),
+      S("poti_off", "poti_off", SettingType::Float, &potiOffThreshold, 0.0f, 0.5f, Settings::POTI_OFF_THRESHOLD, 3, CLAMP),
+      S("poti_sample", "poti_s", SettingType::U32, &potiSampleMs, 10, 2000, Settings::POTI_SAMPLE_MS, 0, CLAMP),
+      // Calibration is per device: persisted, but not part of cfg export
+      S("poti_min", "poti_min", SettingType::Float, &potiCalibMin, 0.0f, 1.0f, Settings::POTI_MIN_DEFAULT, 3, SETTING_PERSIST | SETTING_STATUS),
+      S("poti_max", "poti_max", SettingType::Float, &potiCalibMax, 0.0f, 1.0f, Settings::POTI_MAX_DEFAULT, 3, SETTING_PERSIST | SETTING_STATUS),
+      S("poti_inv", "poti_inv", SettingType::Bool, &potiInvert, 0, 1, Settings::POTI_INVERT_DEFAULT, 0, STD),
+#endif
+#if ENABLE_PUSH_BUTTON
+      S("push_en", "push_en", SettingType::Bool, &pushEnabled, 0, 1, 1, 0, STD),
+      S("push_db", "push_db", SettingType::U32, &pushDebounceMs, 5, 500, Settings::PUSH_DEBOUNCE_MS, 0, CLAMP),
+      S("push_dbl", "push_dbl", SettingType::U32, &pushDoubleMs, 100, 5000, Settings::PUSH_DOUBLE_MS, 0, CLAMP),
+      S("push_hold", "push_hold", SettingType::U32, &pushHoldMs, 200, 6000, Settings::PUSH_HOLD_MS, 0, CLAMP),
+      S("push_step_ms", "push_s_ms", SettingType::U32, &pushStepMs, 50, 2000, Settings::PUSH_BRI_STEP_MS, 0, CLAMP),
+      S("push_step", "push_step", SettingType::Float, &pushStep, 0.005f, 0.5f, Settings::PUSH_BRI_STEP, 3, CLAMP),
+#endif
+  };
+  constexpr size_t TABLE_COUNT = sizeof(TABLE) / sizeof(TABLE[0]);
+
+  // Filter parameters are owned by filters.cpp and set per stage through
+  // filtersSet*(), so their entries point into this copy instead.
+  FilterState filterEdit;
+  constexpr uint8_t FIL = SETTING_PERSIST | SETTING_EXPORT | SETTING_STATUS;
+  constexpr uint8_t FIL_CLAMP = FIL | SETTING_CLAMP;
+
+  constexpr SettingDef FILTER_TABLE[] = {
+      S("filter_iir", "fil_iir_en", SettingType::Bool, &filterEdit.iirEnabled, 0, 1, Settings::FILTER_IIR_DEFAULT, 0, FIL),
+      S("filter_iir_a", "fil_iir_a", SettingType::Float, &filterEdit.iirAlpha, 0.0f, 1.0f, Settings::FILTER_IIR_ALPHA_DEFAULT, 3, FIL_CLAMP),
+      S("filter_clip", "fil_cl_en", SettingType::Bool, &filterEdit.clipEnabled, 0, 1, Settings::FILTER_CLIP_DEFAULT, 0, FIL),
+      S("filter_clip_amt", "fil_cl_amt", SettingType::Float, &filterEdit.clipAmount, 0.0f, 1.0f, Settings::FILTER_CLIP_AMT_DEFAULT, 2, FIL_CLAMP),
+      S("filter_clip_curve", "fil_cl_cv", SettingType::U8, &filterEdit.clipCurve, 0, 1, Settings::FILTER_CLIP_CURVE_DEFAULT, 0, FIL),
+      S("filter_trem", "fil_tr_en", SettingType::Bool, &filterEdit.tremEnabled, 0, 1, Settings::FILTER_TREM_DEFAULT, 0, FIL),
+      S("filter_trem_rate", "fil_tr_rt", SettingType::Float, &filterEdit.tremRateHz, 0.05f, 20.0f, Settings::FILTER_TREM_RATE_DEFAULT, 2, FIL_CLAMP),
+      S("filter_trem_depth", "fil_tr_dp", SettingType::Float, &filterEdit.tremDepth, 0.0f, 1.0f, Settings::FILTER_TREM_DEPTH_DEFAULT, 2, FIL_CLAMP),
+      S("filter_trem_wave", "fil_tr_wv", SettingType::U8, &filterEdit.tremWave, 0, 1, Settings::FILTER_TREM_WAVE_DEFAULT, 0, FIL),
+      S("filter_spark", "fil_sp_en", SettingType::Bool, &filterEdit.sparkEnabled, 0, 1, Settings::FILTER_SPARK_DEFAULT, 0, FIL),
+      S("filter_spark_dens", "fil_sp_dn", SettingType::Float, &filterEdit.sparkDensity, 0.0f, 20.0f, Settings::FILTER_SPARK_DENS_DEFAULT, 2, FIL_CLAMP),
+      S("filter_spark_int", "fil_sp_in", SettingType::Float, &filterEdit.sparkIntensity, 0.0f, 1.0f, Settings::FILTER_SPARK_INT_DEFAULT, 2, FIL_CLAMP),
+      S("filter_spark_decay", "fil_sp_dc", SettingType::U32, &filterEdit.sparkDecayMs, 10, 5000, Settings::FILTER_SPARK_DECAY_DEFAULT, 0, FIL_CLAMP),
+      S("filter_comp", "fil_cp_en", SettingType::Bool, &filterEdit.compEnabled, 0, 1, Settings::FILTER_COMP_DEFAULT, 0, FIL),
+      S("filter_comp_thr", "fil_cp_th", SettingType::Float, &filterEdit.compThr, 0.0f, 1.2f, Settings::FILTER_COMP_THR_DEFAULT, 2, FIL_CLAMP),
+      S("filter_comp_ratio", "fil_cp_rt", SettingType::Float, &filterEdit.compRatio, 1.0f, 10.0f, Settings::FILTER_COMP_RATIO_DEFAULT, 2, FIL_CLAMP),
+      S("filter_comp_att", "fil_cp_at", SettingType::U32, &filterEdit.compAttackMs, 1, 2000, Settings::FILTER_COMP_ATTACK_DEFAULT, 0, FIL_CLAMP),
+      S("filter_comp_rel", "fil_cp_rl", SettingType::U32, &filterEdit.compReleaseMs, 1, 4000, Settings::FILTER_COMP_RELEASE_DEFAULT, 0, FIL_CLAMP),
+      S("filter_env", "fil_ev_en", SettingType::Bool, &filterEdit.envEnabled, 0, 1, Settings::FILTER_ENV_DEFAULT, 0, FIL),
+      S("filter_env_att", "fil_ev_at", SettingType::U32, &filterEdit.envAttackMs, 1, 4000, Settings::FILTER_ENV_ATTACK_DEFAULT, 0, FIL_CLAMP),
+      S("filter_env_rel", "fil_ev_rl", SettingType::U32, &filterEdit.envReleaseMs, 1, 6000, Settings::FILTER_ENV_RELEASE_DEFAULT, 0, FIL_CLAMP),
+      S("filter_delay", "fil_dl_en", SettingType::Bool, &filterEdit.delayEnabled, 0, 1, Settings::FILTER_DELAY_DEFAULT, 0, FIL),
+      S("filter_delay_ms", "fil_dl_ms", SettingType::U32, &filterEdit.delayMs, 10, 5000, Settings::FILTER_DELAY_MS_DEFAULT, 0, FIL_CLAMP),
+      S("filter_delay_fb", "fil_dl_fb", SettingType::Float, &filterEdit.delayFeedback, 0.0f, 0.95f, Settings::FILTER_DELAY_FB_DEFAULT, 2, FIL_CLAMP),
+      S("filter_delay_mix", "fil_dl_mx", SettingType::Float, &filterEdit.delayMix, 0.0f, 1.0f, Settings::FILTER_DELAY_MIX_DEFAULT, 2, FIL_CLAMP),
+  };
+  constexpr size_t FILTER_COUNT = sizeof(FILTER_TABLE) / sizeof(FILTER_TABLE[0]);
+
+  void appendDefs(String &out, const SettingDef *defs, size_t count, uint8_t flag, char sep)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (!(defs[i].flags & flag))
+        continue;
+      out += sep;
+      out += defs[i].key;
+      out += '=';
+      out += settingFormat(defs[i]);
+    }
+  }
+  static_assert(TABLE_COUNT * 2 <= Settings::SETTINGS_INDEX_SLOTS, "settings index too small");
+  static_assert(TABLE_COUNT < 255, "settings index holds uint8_t entries");
+
+  // Open addressing over the precomputed key hashes; entry = table index + 1.
+  uint8_t indexSlots[Settings::SETTINGS_INDEX_SLOTS];
+  bool indexBuilt = false;
+
+  void buildIndex()
+  {
+    constexpr size_t mask = Settings::SETTINGS_INDEX_SLOTS - 1;
+    for (size_t i = 0; i < TABLE_COUNT; ++i)
+    {
+      size_t slot = TABLE[i].hash & mask;
+      while (indexSlots[slot] != 0)
+        slot = (slot + 1) & mask;
+      indexSlots[slot] = (uint8_t)(i + 1);
+    }
+    indexBuilt = true;
+  }
+
+  uint32_t fnv1a(const char *s)
+  {
+    uint32_t h = 2166136261u;
+    while (*s)
+      h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+  }
+}
+
+size_t settingCount()
+{
+  return TABLE_COUNT;
+}
+
+const SettingDef &settingAt(size_t i)
+{
+  return TABLE[i];
+}
+
+const SettingDef *settingFind(const char *key)
+{
+  if (!indexBuilt)
+    buildIndex();
+  constexpr size_t mask = Settings::SETTINGS_INDEX_SLOTS - 1;
+  const uint32_t h = fnv1a(key);
+  for (size_t slot = h & mask;; slot = (slot + 1) & mask)
+  {
+    const uint8_t e = indexSlots[slot];
+    if (e == 0)
+      return nullptr;
+    const SettingDef &def = TABLE[e - 1];
+    if (def.hash == h && strcmp(def.key, key) == 0)
+      return &def;
+  }
+}
+
+const SettingDef *settingFindHash(uint32_t hash)
+{
+  if (!indexBuilt)
+    buildIndex();
+  constexpr size_t mask = Settings::SETTINGS_INDEX_SLOTS - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+  {
+    const uint8_t e = indexSlots[slot];
+    if (e == 0)
+      return nullptr;
+    if (TABLE[e - 1].hash == hash)
+      return &TABLE[e - 1];
+  }
+}
+
+float settingValue(const SettingDef &def)
+{
+  switch (def.type)
+  {
+  case SettingType::Bool:
+    return *static_cast<bool *>(def.ptr) ? 1.0f : 0.0f;
+  case SettingType::U8:
+  case SettingType::Ease:
+    return *static_cast<uint8_t *>(def.ptr);
+  case SettingType::Int:
+    return (float)*static_cast<int *>(def.ptr);
+  case SettingType::U32:
+    return (float)*static_cast<uint32_t *>(def.ptr);
+  case SettingType::Float:
+    return *static_cast<float *>(def.ptr);
+  }
+  return 0.0f;
+}
+
+bool settingAssign(const SettingDef &def, float v)
+{
+  if (isnan(v))
+    return false;
+  if (v < def.minVal || v > def.maxVal)
+  {
+    if (!(def.flags & SETTING_CLAMP))
+      return false;
+    v = v < def.minVal ? def.minVal : def.maxVal;
+  }
+  switch (def.type)
+  {
+  case SettingType::Bool:
+    *static_cast<bool *>(def.ptr) = v != 0.0f;
+    break;
+  case SettingType::U8:
+  case SettingType::Ease:
+    *static_cast<uint8_t *>(def.ptr) = (uint8_t)v;
+    break;
+  case SettingType::Int:
+    *static_cast<int *>(def.ptr) = (int)v;
+    break;
+  case SettingType::U32:
+    *static_cast<uint32_t *>(def.ptr) = (uint32_t)v;
+    break;
+  case SettingType::Float:
+    *static_cast<float *>(def.ptr) = v;
+    break;
+  }
+  return true;
+}
+
+bool settingParse(const SettingDef &def, const String &val)
+{
+  switch (def.type)
+  {
+  case SettingType::Bool:
+  {
+    bool b;
+    return parseBool(val, b) && settingAssign(def, b ? 1.0f : 0.0f);
+  }
+  case SettingType::Ease:
+    return settingAssign(def, easeFromString(val));
+  case SettingType::Float:
+    return settingAssign(def, val.toFloat());
+  default:
+    return settingAssign(def, (float)val.toInt());
+  }
+}
+
+String settingFormat(const SettingDef &def)
+{
+  switch (def.type)
+  {
+  case SettingType::Bool:
+    return *static_cast<bool *>(def.ptr) ? F("on") : F("off");
+  case SettingType::Ease:
+    return easeToString(*static_cast<uint8_t *>(def.ptr));
+  case SettingType::Int:
+    return String(*static_cast<int *>(def.ptr));
+  case SettingType::Float:
+    return String(*static_cast<float *>(def.ptr), (unsigned int)def.decimals);
+  default:
+    return String((unsigned long)settingValue(def));
+  }
+}
+
+void settingsAppend(String &out, uint8_t flag)
+{
+  appendDefs(out, TABLE, TABLE_COUNT, flag, ' ');
+}
+
+size_t filterSettingCount()
+{
+  return FILTER_COUNT;
+}
+
+const SettingDef &filterSettingAt(size_t i)
+{
+  return FILTER_TABLE[i];
+}
+
+const SettingDef *filterSettingFind(const char *key)
+{
+  const uint32_t h = fnv1a(key);
+  for (size_t i = 0; i < FILTER_COUNT; ++i)
+  {
+    if (FILTER_TABLE[i].hash == h && strcmp(FILTER_TABLE[i].key, key) == 0)
+      return &FILTER_TABLE[i];
+  }
+  return nullptr;
+}
+
+void filterSettingsCapture()
+{
+  filtersGetState(filterEdit);
+}
+
+void filterSettingsApply()
+{
+  const FilterState &f = filterEdit;
+  filtersSetIir(f.iirEnabled, f.iirAlpha);
+  filtersSetClip(f.clipEnabled, f.clipAmount, f.clipCurve);
+  filtersSetTrem(f.tremEnabled, f.tremRateHz, f.tremDepth, f.tremWave);
+  filtersSetSpark(f.sparkEnabled, f.sparkDensity, f.sparkIntensity, f.sparkDecayMs);
+  filtersSetComp(f.compEnabled, f.compThr, f.compRatio, f.compAttackMs, f.compReleaseMs);
+  filtersSetEnv(f.envEnabled, f.envAttackMs, f.envReleaseMs);
+  filtersSetDelay(f.delayEnabled, f.delayMs, f.delayFeedback, f.delayMix);
+}
+
+void filterSettingsAppend(String &out, uint8_t flag, char sep)
+{
+  appendDefs(out, FILTER_TABLE, FILTER_COUNT, flag, sep);
+}
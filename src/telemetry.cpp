@@ -0,0 +1,208 @@
+/**
+ * @file telemetry.cpp
+ * @brief Fixed-layout binary telemetry records, batched per BLE notification / USB line.
+ */
+
+#include "telemetry.h"
+
+#if ENABLE_TELEMETRY
+
+#include "comms.h"
+#include "inputs.h"
+#include "lamp_state.h"
+#include "lightSensor.h"
+#include "log_sink.h"
+#include "microphone.h"
+#include "pattern.h"
+#include "settings.h"
+#include "utils.h"
+
+bool telemetryBle = false;
+bool telemetryUsb = false;
+uint16_t telemetryHz = Settings::TELEMETRY_HZ_DEFAULT;
+
+static constexpr size_t TELEMETRY_RECORDS_MAX = 24;    // 6 + 24*20 = 486 B, fits a 512 B MTU
+static constexpr size_t TELEMETRY_USB_RECORDS = 10;    // ~300 B per TLM| line
+static TelemetryRecord telemetryBatch[TELEMETRY_RECORDS_MAX];
+static size_t telemetryCount = 0;
+static uint16_t telemetrySeq = 0;       // sequence number of the next record
+static uint32_t telemetryBatchStartMs = 0;
+static uint32_t telemetryNextSampleUs = 0;
+static uint32_t telemetryBatchesSent = 0;
+static uint32_t telemetryRecordsSent = 0;
+static uint32_t telemetryRecordsDropped = 0;
+
+static uint16_t toQ16(float v)
+{
+  return (uint16_t)(clamp01(v) * 65535.0f + 0.5f);
+}
+
+/**
+ * @brief Records per batch for the active sinks (BLE bound by the negotiated MTU).
+ */
+static size_t telemetryBatchTarget()
+{
+  size_t target = TELEMETRY_RECORDS_MAX;
+  if (telemetryUsb)
+    target = TELEMETRY_USB_RECORDS;
+#if ENABLE_BLE
+  if (telemetryBle)
+  {
+    size_t payload = bleTelemetryPayloadMax();
+    size_t fit = payload > sizeof(TelemetryBatchHeader) ? (payload - sizeof(TelemetryBatchHeader)) / sizeof(TelemetryRecord) : 0;
+    if (fit == 0)
+      fit = 1;
+    if (fit < target)
+      target = fit;
+  }
+#endif
+  return target;
+}
+
+static void sampleTelemetry(uint32_t nowMs)
+{
+  TelemetryRecord &r = telemetryBatch[telemetryCount];
+  r.ms = nowMs;
+  r.pwm = (uint16_t)(lastPwmValue > 0xFFFF ? 0xFFFF : lastPwmValue);
+  r.pattern = toQ16(patternRelativeLevel);
+  r.master = toQ16(masterBrightness);
+  r.ambient = toQ16(ambientScale * 0.5f);
+  r.output = toQ16(outputScale);
+#if ENABLE_MUSIC_MODE
+  r.music = toQ16(musicFiltered);
+#else
+  r.music = 0;
+#endif
+#if ENABLE_TOUCH_DIM
+  r.touchDelta = (int16_t)constrain(touchLastDelta, -32768, 32767);
+#else
+  r.touchDelta = 0;
+#endif
+#if ENABLE_LIGHT_SENSOR
+  r.lightRaw = lightLastRaw;
+#else
+  r.lightRaw = 0;
+#endif
+  if (telemetryCount == 0)
+    telemetryBatchStartMs = nowMs;
+  telemetryCount++;
+}
+
+static void flushTelemetry()
+{
+  if (telemetryCount == 0)
+    return;
+  uint8_t frame[sizeof(TelemetryBatchHeader) + sizeof(telemetryBatch)];
+  TelemetryBatchHeader hdr;
+  hdr.magic = TELEMETRY_MAGIC;
+  hdr.version = TELEMETRY_VERSION;
+  hdr.seq = (uint16_t)(telemetrySeq - telemetryCount);
+  hdr.count = (uint8_t)telemetryCount;
+  hdr.recordSize = sizeof(TelemetryRecord);
+  const size_t len = sizeof(hdr) + telemetryCount * sizeof(TelemetryRecord);
+  memcpy(frame, &hdr, sizeof(hdr));
+  memcpy(frame + sizeof(hdr), telemetryBatch, telemetryCount * sizeof(TelemetryRecord));
+
+  bool sent = false;
+#if ENABLE_BLE
+  if (telemetryBle && len <= bleTelemetryPayloadMax())
+    sent = bleNotifyTelemetry(frame, len) || sent;
+#endif
+  if (telemetryUsb)
+  {
+    String line = F("TLM|");
+    base64Append(line, frame, len);
+    sent = logSinkWrite(LOG_SINK_USB, line) || sent;
+  }
+  if (sent)
+  {
+    telemetryBatchesSent++;
+    telemetryRecordsSent += telemetryCount;
+  }
+  else
+  {
+    telemetryRecordsDropped += telemetryCount;
+  }
+  telemetryCount = 0;
+}
+
+bool setTelemetryRate(uint16_t hz)
+{
+  if (hz < 10 || hz > Settings::TELEMETRY_HZ_MAX)
+  {
+    sendFeedback(String(F("Usage: telem rate <10-")) + String(Settings::TELEMETRY_HZ_MAX) + F(">"));
+    return false;
+  }
+  telemetryHz = hz;
+  telemetryCount = 0;
+  telemetryNextSampleUs = 0;
+  return true;
+}
+
+bool setTelemetryBle(bool enabled)
+{
+  telemetryBle = false;
+  if (!enabled)
+    return true;
+#if ENABLE_BLE
+  const size_t payload = bleTelemetryPayloadMax();
+  if (payload >= sizeof(TelemetryBatchHeader) + sizeof(TelemetryRecord))
+  {
+    telemetryBle = true;
+    return true;
+  }
+  sendFeedback(String(F("[Telemetry] BLE refused: notify payload ")) + String((unsigned)payload) + F(" B, need ") +
+               String((unsigned)(sizeof(TelemetryBatchHeader) + sizeof(TelemetryRecord))) +
+               F(" B (connect with a larger MTU)"));
+#else
+  sendFeedback(F("[Telemetry] BLE disabled in build"));
+#endif
+  return false;
+}
+
+void updateTelemetry()
+{
+  if (!telemetryBle && !telemetryUsb)
+  {
+    telemetryCount = 0;
+    return;
+  }
+  const uint32_t nowUs = micros();
+  const uint32_t periodUs = 1000000UL / telemetryHz;
+  if (telemetryNextSampleUs != 0 && (int32_t)(nowUs - telemetryNextSampleUs) < 0)
+    return;
+  // Fixed grid: a late loop skips samples instead of drifting the rate.
+  telemetryNextSampleUs = (telemetryNextSampleUs == 0 || (nowUs - telemetryNextSampleUs) > periodUs)
+                              ? nowUs + periodUs
+                              : telemetryNextSampleUs + periodUs;
+  const uint32_t nowMs = millis();
+  sampleTelemetry(nowMs);
+  telemetrySeq++;
+  const size_t target = telemetryBatchTarget();
+  if (telemetryCount >= target || telemetryCount >= TELEMETRY_RECORDS_MAX ||
+      (nowMs - telemetryBatchStartMs) >= Settings::TELEMETRY_BATCH_MAX_MS)
+    flushTelemetry();
+}
+
+void telemetryStatusFeedback()
+{
+  String line = F("[Telemetry] ble=");
+  line += telemetryBle ? F("ON") : F("OFF");
+  line += F(" usb=");
+  line += telemetryUsb ? F("ON") : F("OFF");
+  line += F(" hz=");
+  line += String(telemetryHz);
+  line += F(" batch=");
+  line += String(telemetryBatchTarget());
+  line += F(" seq=");
+  line += String(telemetrySeq);
+  line += F(" batches=");
+  line += String(telemetryBatchesSent);
+  line += F(" records=");
+  line += String(telemetryRecordsSent);
+  line += F(" dropped=");
+  line += String(telemetryRecordsDropped);
+  sendFeedback(line);
+}
+
+#endif // ENABLE_TELEMETRY
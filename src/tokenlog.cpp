@@ -0,0 +1,224 @@
+/**
+ * @file tokenlog.cpp
+ * @brief Argument encoding, `~<base64>` framing and on-device expansion for TLOG().
+ */
+
+#include "tokenlog.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+static uint32_t tokenLinesSent = 0;
+static uint32_t tokenBytesSent = 0;
+static uint32_t textLinesSent = 0;
+static uint32_t textBytesSent = 0;
+static uint32_t tokenArgOverflows = 0;
+
+static void tokenPutByte(TokenArgs &a, uint8_t b)
+{
+  if (a.len < sizeof(a.buf))
+    a.buf[a.len++] = b;
+  else
+    tokenArgOverflows++;
+}
+
+static void tokenPutVarint(TokenArgs &a, uint32_t v)
+{
+  while (v >= 0x80)
+  {
+    tokenPutByte(a, (uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  tokenPutByte(a, (uint8_t)v);
+}
+
+static void tokenPutString(TokenArgs &a, const char *s, size_t n)
+{
+  if (!s)
+    n = 0;
+  const size_t room = sizeof(a.buf) > (size_t)a.len + 1 ? sizeof(a.buf) - a.len - 1 : 0;
+  if (n > room)
+  {
+    n = room;
+    tokenArgOverflows++;
+  }
+  if (n > 255)
+    n = 255;
+  tokenPutByte(a, (uint8_t)n);
+  memcpy(a.buf + a.len, s, n);
+  a.len += n;
+}
+
+void tokenEncode(TokenArgs &a, int v) { tokenPutVarint(a, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+void tokenEncode(TokenArgs &a, long v) { tokenEncode(a, (int)v); }
+void tokenEncode(TokenArgs &a, unsigned int v) { tokenPutVarint(a, v); }
+void tokenEncode(TokenArgs &a, unsigned long v) { tokenPutVarint(a, (uint32_t)v); }
+void tokenEncode(TokenArgs &a, const char *v) { tokenPutString(a, v, v ? strlen(v) : 0); }
+void tokenEncode(TokenArgs &a, const String &v) { tokenPutString(a, v.c_str(), v.length()); }
+void tokenEncode(TokenArgs &a, const __FlashStringHelper *v) { tokenEncode(a, reinterpret_cast<const char *>(v)); }
+
+void tokenEncode(TokenArgs &a, double v)
+{
+  const float f = (float)v;
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  for (uint8_t i = 0; i < 4; ++i)
+    tokenPutByte(a, (uint8_t)(bits >> (8 * i)));
+}
+
+namespace
+{
+  struct ArgReader
+  {
+    const uint8_t *p;
+    const uint8_t *end;
+
+    uint32_t varint()
+    {
+      uint32_t v = 0;
+      uint8_t shift = 0;
+      while (p < end && shift < 35)
+      {
+        const uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+          break;
+        shift += 7;
+      }
+      return v;
+    }
+
+    float f32()
+    {
+      uint32_t bits = 0;
+      for (uint8_t i = 0; i < 4 && p < end; ++i)
+        bits |= (uint32_t)(*p++) << (8 * i);
+      float f;
+      memcpy(&f, &bits, sizeof(f));
+      return f;
+    }
+  };
+} // namespace
+
+void tokenFormat(String &out, const char *fmt, const uint8_t *args, size_t len)
+{
+  ArgReader rd{args, args + len};
+  char spec[16];
+  char num[32];
+  for (const char *c = fmt; *c; ++c)
+  {
+    if (*c != '%')
+    {
+      out += *c;
+      continue;
+    }
+    if (c[1] == '%')
+    {
+      out += '%';
+      ++c;
+      continue;
+    }
+    // Copy flags/width/precision, drop length modifiers, re-add 'l' for integers.
+    size_t n = 0;
+    spec[n++] = '%';
+    ++c;
+    while (*c && strchr("-+ #0123456789.", *c) && n < sizeof(spec) - 3)
+      spec[n++] = *c++;
+    while (*c && strchr("hlLzjt", *c))
+      ++c;
+    const char conv = *c;
+    if (!conv)
+      break;
+    switch (conv)
+    {
+    case 'd':
+    case 'i':
+    {
+      const uint32_t z = rd.varint();
+      spec[n++] = 'l';
+      spec[n++] = 'd';
+      spec[n] = 0;
+      snprintf(num, sizeof(num), spec, (long)(int32_t)((z >> 1) ^ (0u - (z & 1u))));
+      out += num;
+      break;
+    }
+    case 'u':
+    case 'x':
+    case 'X':
+      spec[n++] = 'l';
+      spec[n++] = conv;
+      spec[n] = 0;
+      snprintf(num, sizeof(num), spec, (unsigned long)rd.varint());
+      out += num;
+      break;
+    case 'c':
+      out += (char)rd.varint();
+      break;
+    case 'f':
+    case 'e':
+    case 'g':
+      spec[n++] = conv;
+      spec[n] = 0;
+      snprintf(num, sizeof(num), spec, (double)rd.f32());
+      out += num;
+      break;
+    case 's':
+    {
+      const uint8_t sl = rd.p < rd.end ? *rd.p++ : 0;
+      for (uint8_t i = 0; i < sl && rd.p < rd.end; ++i)
+        out += (char)*rd.p++;
+      break;
+    }
+    default:
+      out += conv;
+      break;
+    }
+  }
+}
+
+void tokenLogEmit(uint8_t route, uint16_t token, const char *fmt, const TokenArgs &args)
+{
+  const uint8_t tokenClients = fmt ? feedbackTokenClients(route) : route;
+  if (tokenClients)
+  {
+    uint8_t frame[2 + Settings::TOKEN_ARGS_MAX];
+    frame[0] = (uint8_t)(token & 0xFF);
+    frame[1] = (uint8_t)(token >> 8);
+    memcpy(frame + 2, args.buf, args.len);
+    String line = F("~");
+    base64Append(line, frame, 2 + args.len);
+    sendFeedbackRoute(tokenClients, line);
+    tokenLinesSent++;
+    tokenBytesSent += line.length();
+  }
+  const uint8_t textClients = route & ~tokenClients;
+  if (textClients)
+  {
+    String line;
+    tokenFormat(line, fmt, args.buf, args.len);
+    sendFeedbackRoute(textClients, line);
+    textLinesSent++;
+    textBytesSent += line.length();
+  }
+}
+
+void tokenStatsFeedback()
+{
+  String line = F("[Tok] client=");
+  line += feedbackGetTokens() ? F("on") : F("off");
+  line += F(" tok=");
+  line += String(tokenLinesSent);
+  line += '/';
+  line += String(tokenBytesSent);
+  line += F("B text=");
+  line += String(textLinesSent);
+  line += '/';
+  line += String(textBytesSent);
+  line += F("B overflow=");
+  line += String(tokenArgOverflows);
+#if !TOKEN_LOG_TEXT
+  line += F(" (text stripped)");
+#endif
+  sendFeedbackRoute(feedbackCommandRoute(), line);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file touch_gesture.cpp
+ * @brief Tap / multi-tap / hold state machine over the touch delta.
+ */
+
+#include "touch_gesture.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+namespace
+{
+  // An interrupt press runs ahead of the filtered delta; this long it may take to catch up.
+  constexpr uint32_t CONFIRM_MS = 60;
+}
+
+void touchGestureReset(TouchGesture &g)
+{
+  memset(&g, 0, sizeof(g));
+}
+
+void touchGestureIgnorePress(TouchGesture &g)
+{
+  g.ignore = g.pressed;
+  g.holding = false;
+  g.pending = 0;
+}
+
+uint8_t touchGestureFeed(TouchGesture &g, const TouchGestureConfig &cfg, int delta, bool irq, uint32_t nowMs)
+{
+  const int mag = abs(delta);
+  const uint8_t maxTaps = cfg.maxTaps ? cfg.maxTaps : 1;
+  uint8_t ev = 0;
+  if (!g.pressed)
+  {
+    if (irq || mag > cfg.onDelta)
+    {
+      g.pressed = true;
+      g.confirmed = mag >= cfg.offDelta;
+      g.pressMs = nowMs;
+      ev |= TG_PRESS;
+    }
+    else if (g.pending && nowMs - g.releaseMs >= cfg.tapGapMs)
+    {
+      g.taps = g.pending;
+      g.pending = 0;
+      ev |= TG_TAPS;
+    }
+    return ev;
+  }
+
+  // The interrupt only says "below threshold now"; releases follow the filtered delta
+  // once it has risen past the off threshold. A press it never confirms was a spike.
+  if (mag >= cfg.offDelta)
+    g.confirmed = true;
+  if (mag < cfg.offDelta && (g.confirmed || nowMs - g.pressMs >= CONFIRM_MS))
+  {
+    g.pressed = false;
+    g.releaseMs = nowMs;
+    ev |= TG_RELEASE;
+    if (g.ignore || !g.confirmed)
+    {
+      g.ignore = false;
+    }
+    else if (g.holding)
+    {
+      g.holding = false;
+      ev |= TG_HOLD_END;
+    }
+    else if (++g.pending >= maxTaps)
+    {
+      g.taps = g.pending;
+      g.pending = 0;
+      ev |= TG_TAPS;
+    }
+    return ev;
+  }
+
+  if (!g.holding && !g.ignore && nowMs - g.pressMs >= cfg.holdMs)
+  {
+    // Taps before the hold belong to no gesture.
+    g.holding = true;
+    g.pending = 0;
+    ev |= TG_HOLD;
+  }
+  return ev;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file touch_sensor.cpp
+ * @brief Touch pad via the hardware FSM: filtered counts, threshold interrupt, baseline and calibration.
+ */
+
+#include "lamp_config.h"
+
+#include "touch_sensor.h"
+
+#if ENABLE_TOUCH_DIM
+
+#include <driver/touch_pad.h>
+#include <freertos/FreeRTOS.h>
+
+#include "settings.h"
+#include "pinout.h"
+#include "inputs.h"
+#include "input_events.h"
+#include "comms.h"
+#include "persistence.h"
+
+namespace
+{
+  enum CalibPhase : uint8_t
+  {
+    CALIB_IDLE,
+    CALIB_BASE,    // baseline only
+    CALIB_RELEASE, // guided: untouched
+    CALIB_TOUCH,   // guided: touched
+  };
+
+  constexpr int32_t BASELINE_DIV = (int32_t)(Settings::TOUCH_BASELINE_TAU_MS / Settings::TOUCH_FILTER_MS);
+  constexpr uint32_t PROGRESS_MS = 500;
+
+  portMUX_TYPE touchMux = portMUX_INITIALIZER_UNLOCKED;
+  bool started = false;
+  touch_pad_t pad;
+  volatile uint16_t filteredValue = 0;
+  volatile bool irqPending = false;
+  int32_t baselineQ8 = 0; // touchBaseline << 8; 0 = not calibrated yet
+  uint16_t armedThreshold = 0;
+
+  // Phases and prompts run in the loop; the filter callback only sums samples.
+  CalibPhase phase = CALIB_IDLE;
+  uint32_t phaseStartMs = 0;
+  uint32_t lastProgressMs = 0;
+  bool collecting = false;
+  uint32_t calSum = 0;
+  uint32_t calCount = 0;
+  int calBase = 0;
+
+  void IRAM_ATTR touchIsr()
+  {
+    // Fires every measurement while the pad stays below the threshold; one wake is enough.
+    if (irqPending)
+      return;
+    irqPending = true;
+    inputEventsWakeFromIsr();
+  }
+
+  /** @brief esp_timer task, every Settings::TOUCH_FILTER_MS. */
+  void filterCb(uint16_t *, uint16_t *filtered)
+  {
+    const uint16_t v = filtered[pad];
+    uint16_t thr = 0;
+    portENTER_CRITICAL(&touchMux);
+    filteredValue = v;
+    if (collecting)
+    {
+      calSum += v;
+      calCount++;
+    }
+    else if (baselineQ8 && !touchActive)
+    {
+      // Follow slow drift (temperature, humidity) only while clearly untouched.
+      const int32_t mag = abs((baselineQ8 >> 8) - (int32_t)v);
+      if (mag < touchDeltaOn)
+      {
+        baselineQ8 += (((int32_t)v << 8) - baselineQ8) / BASELINE_DIV;
+        touchBaseline = (int)(baselineQ8 >> 8);
+      }
+    }
+    if (baselineQ8 && touchBaseline > touchDeltaOn)
+      thr = (uint16_t)(touchBaseline - touchDeltaOn);
+    portEXIT_CRITICAL(&touchMux);
+    if (thr != armedThreshold)
+    {
+      armedThreshold = thr;
+      touch_pad_set_thresh(pad, thr);
+    }
+  }
+
+  void setBaseline(int base)
+  {
+    portENTER_CRITICAL(&touchMux);
+    touchBaseline = base;
+    baselineQ8 = (int32_t)base << 8;
+    portEXIT_CRITICAL(&touchMux);
+  }
+
+  void startCollecting(CalibPhase next, uint32_t now)
+  {
+    portENTER_CRITICAL(&touchMux);
+    calSum = 0;
+    calCount = 0;
+    collecting = false;
+    portEXIT_CRITICAL(&touchMux);
+    phase = next;
+    phaseStartMs = now;
+    lastProgressMs = now;
+  }
+
+  /** @brief Mean of the phase so far, or @p fallback without samples. */
+  int collectedMean(int fallback)
+  {
+    portENTER_CRITICAL(&touchMux);
+    const uint32_t sum = calSum;
+    const uint32_t n = calCount;
+    collecting = false;
+    portEXIT_CRITICAL(&touchMux);
+    return n ? (int)((sum + n / 2) / n) : fallback;
+  }
+
+  void finishGuided(int touchAvg)
+  {
+    // Touch lowers the count on the ESP32.
+    int delta = abs(calBase - touchAvg);
+    if (delta < 3)
+      delta = 3;
+    int newOn = delta * 6 / 10; // ~60% of observed delta
+    if (newOn < 4)
+      newOn = 4;
+    if (newOn > 60)
+      newOn = 60;
+    int newOff = newOn * 6 / 10;
+    if (newOff < 2)
+      newOff = 2;
+    if (newOff >= newOn)
+      newOff = newOn - 1;
+
+    setBaseline(calBase);
+    touchDeltaOn = newOn;
+    touchDeltaOff = newOff;
+    saveSettings();
+    sendFeedback(String(F("[Calib] base=")) + String(calBase) + F(" touch=") + String(touchAvg) +
+                 F(" delta=") + String(delta) + F(" thrOn=") + String(newOn) + F(" thrOff=") + String(newOff));
+  }
+} // namespace
+
+void touchSensorBegin()
+{
+  if (started)
+    return;
+  started = true;
+  pad = (touch_pad_t)digitalPinToTouchChannel(PIN_TOUCH_DIM);
+  // Measure every ~5 ms instead of the core's 27 ms so the filter keeps up with short taps.
+  touchSetCycles(Settings::TOUCH_MEASURE_CYCLES, Settings::TOUCH_SLEEP_CYCLES);
+  // touchRead() brings the peripheral up in FSM timer mode and configures the pad.
+  filteredValue = (uint16_t)touchRead(PIN_TOUCH_DIM);
+  touch_pad_filter_start(Settings::TOUCH_FILTER_MS);
+  touch_pad_set_filter_read_cb(filterCb);
+  // Threshold 0 never triggers; the filter callback arms it once a baseline exists.
+  touchAttachInterrupt(PIN_TOUCH_DIM, touchIsr, 0);
+}
+
+int touchSensorValue()
+{
+  touchSensorBegin();
+  return filteredValue;
+}
+
+bool touchSensorTakeIrq()
+{
+  if (!irqPending)
+    return false;
+  irqPending = false;
+  return true;
+}
+
+void touchCalibStart(bool guided)
+{
+  touchSensorBegin();
+  touchActive = false;
+  startCollecting(guided ? CALIB_RELEASE : CALIB_BASE, millis());
+  if (guided)
+    sendFeedback(F("[Calib] Release electrode for 2s"));
+}
+
+bool touchCalibUpdate()
+{
+  if (phase == CALIB_IDLE)
+    return false;
+  const uint32_t now = millis();
+  const uint32_t settleMs = phase == CALIB_BASE ? 0 : Settings::TOUCH_CALIB_SETTLE_MS;
+  const uint32_t sampleMs = phase == CALIB_BASE ? Settings::TOUCH_CALIB_BASE_MS : Settings::TOUCH_CALIB_PHASE_MS;
+  const uint32_t elapsed = now - phaseStartMs;
+  if (elapsed < settleMs)
+    return true;
+  if (!collecting && elapsed < settleMs + sampleMs)
+  {
+    portENTER_CRITICAL(&touchMux);
+    collecting = true;
+    portEXIT_CRITICAL(&touchMux);
+  }
+  if (elapsed < settleMs + sampleMs)
+  {
+    if (phase != CALIB_BASE && now - lastProgressMs >= PROGRESS_MS)
+    {
+      lastProgressMs = now;
+      sendFeedback(String(F("[Calib] ")) + (phase == CALIB_RELEASE ? F("release ") : F("touch ")) +
+                   String((elapsed - settleMs) * 100 / sampleMs) + F("%"));
+    }
+    return true;
+  }
+
+  switch (phase)
+  {
+  case CALIB_BASE:
+    setBaseline(collectedMean(touchSensorValue()));
+    sendFeedback(String(F("[Touch] baseline=")) + String(touchBaseline));
+    phase = CALIB_IDLE;
+    return false;
+  case CALIB_RELEASE:
+    calBase = collectedMean(touchBaseline);
+    startCollecting(CALIB_TOUCH, now);
+    sendFeedback(F("[Calib] Touch and hold for 2s"));
+    return true;
+  default:
+    finishGuided(collectedMean(calBase));
+    phase = CALIB_IDLE;
+    return false;
+  }
+}
+
+#endif
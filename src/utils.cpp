@@ -76,3 +76,89 @@ String easeToString(uint8_t t)
         return F("ease");
     }
 }
+
+/**
+ * @brief Append the standard (padded) base64 encoding of @p data to @p out.
+ */
+void base64Append(String &out, const uint8_t *data, size_t len)
+{
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    out.reserve(out.length() + ((len + 2) / 3) * 4);
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len)
+            v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        out += ALPHABET[(v >> 18) & 0x3F];
+        out += ALPHABET[(v >> 12) & 0x3F];
+        out += (i + 1 < len) ? ALPHABET[(v >> 6) & 0x3F] : '=';
+        out += (i + 2 < len) ? ALPHABET[v & 0x3F] : '=';
+    }
+}
+
+/**
+ * @brief Decode padded base64 from @p in into @p out.
+ * @return Decoded byte count, -1 on invalid input or if @p maxLen is too small.
+ */
+int base64Decode(const String &in, uint8_t *out, size_t maxLen)
+{
+    if (in.length() % 4 != 0)
+        return -1;
+    size_t n = 0;
+    for (size_t i = 0; i < in.length(); i += 4)
+    {
+        uint32_t v = 0;
+        uint8_t pad = 0;
+        for (uint8_t k = 0; k < 4; ++k)
+        {
+            const char c = in[i + k];
+            uint32_t d;
+            if (c >= 'A' && c <= 'Z')
+                d = c - 'A';
+            else if (c >= 'a' && c <= 'z')
+                d = c - 'a' + 26;
+            else if (c >= '0' && c <= '9')
+                d = c - '0' + 52;
+            else if (c == '+')
+                d = 62;
+            else if (c == '/')
+                d = 63;
+            else if (c == '=' && k >= 2 && i + 4 == in.length())
+            {
+                d = 0;
+                pad++;
+            }
+            else
+                return -1;
+            if (pad && c != '=')
+                return -1;
+            v = (v << 6) | d;
+        }
+        const size_t bytes = 3 - pad;
+        if (n + bytes > maxLen)
+            return -1;
+        out[n++] = (uint8_t)(v >> 16);
+        if (bytes > 1)
+            out[n++] = (uint8_t)(v >> 8);
+        if (bytes > 2)
+            out[n++] = (uint8_t)v;
+    }
+    return (int)n;
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    // Nibble table: same result as the usual reflected 0xEDB88320 CRC-32.
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
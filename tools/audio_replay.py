@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+"""Offline replay of recorded audio through the firmware's music, beat and clap code.
+
+  audio_replay.py run <wav> [--claps F] [--beats F] [options]   replay one file and score it
+  audio_replay.py suite [manifest] [--update]                   regression suite (default tools/audio_replay/suite.json)
+  audio_replay.py synth <out.wav> [--bpm N] [--seconds S] [--claps T,..] [--doors T,..] [--speech T,..] [--seed N]
+                  [--clap-shape short|long]
+                                                                 labeled test signal (+ .beats.txt/.claps.txt)
+
+The harness (tools/audio_replay/replay.cpp) is compiled with g++ against the
+unmodified src/ files and the build flags of [env:quarzlampe], so it always
+tests the current tree. Options:
+  --legacy        build with -DENABLE_AUDIO_DMA=0 (40 Hz analogRead path)
+  --loop-ms N     virtual loop() period (default 10, as in main.cpp)
+  --scan-pause-us N  I2S-ADC pause of each ADC scanner pass, every 50 ms; the samples in it are lost
+                  (default 200, 0 = gapless; suite cases: "scan_pause_us")
+  --level X       ADC swing of a full-scale WAV sample (default 1.0 = the whole 12-bit range)
+  --set key=val   clap_thr, clap_peak (DMA), clap_cool, music_thr, music_gain, music_band, music_mode
+  --tol S         clap match window in seconds (default 0.1)
+  --trace F.csv   write musicEnv, musicFiltered and musicModScale of every loop pass (threshold tuning)
+  --verbose       pass the firmware's feedback lines through (stderr)
+
+Label files hold one time in seconds per line (first column, so Audacity label
+exports work). Claps are scored per clap and per command (claps grouped like the
+900 ms counting window); beats by precision/recall within +-70 ms after a warm-up,
+mean offset (negative = early) and the final tempo; without beat labels every
+beat after the warm-up is a false positive. CPU is host thread time per
+second of audio for the capture task and for updateMusicSensor().
+
+Suite cases hold minimum scores under "expect" (recorded by --update) and
+hand-set ceilings under "expect_max", e.g. "beats": 0 for audio without a beat.
+Scores named in "report" are printed only: --update does not record them.
+"""
+
+from __future__ import annotations
+
+import configparser
+import json
+import math
+import random
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import wave
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+HARNESS = ROOT / "tools" / "audio_replay"
+BUILD = HARNESS / "build"
+SUITE = HARNESS / "suite.json"
+FIRMWARE_SOURCES = ["microphone.cpp", "audio_capture.cpp", "audio_bands.cpp", "beat_tracker.cpp", "clap_detector.cpp",
+                    "tokenlog.cpp", "utils.cpp"]
+PIO_ENV = "env:quarzlampe"
+
+BEAT_TOL = 0.07
+BEAT_WARMUP = 6.0    # seconds before the tracker is expected to lock
+CLAP_WINDOW = 0.9    # CLAP_WINDOW_MS in microphone.cpp
+SUITE_MARGIN = 0.02  # allowed drop of a suite score before it counts as a regression
+
+
+def setting(name: str) -> int:
+    text = (ROOT / "include" / "settings.h").read_text(encoding="utf-8")
+    return int(re.search(rf"\b{name}\s*=\s*(\d+)", text).group(1))
+
+
+def pio_flags() -> list[str]:
+    ini = configparser.ConfigParser()
+    ini.read(ROOT / "platformio.ini")
+    return [f for f in ini[PIO_ENV].get("build_flags", "").split() if f.startswith("-D")]
+
+
+def build(legacy: bool) -> Path:
+    out = BUILD / ("replay-legacy" if legacy else "replay")
+    inputs = [HARNESS / "replay.cpp", ROOT / "platformio.ini"] + [ROOT / "src" / s for s in FIRMWARE_SOURCES]
+    inputs += list((ROOT / "include").glob("*.h")) + list((HARNESS / "host").rglob("*.h"))
+    if out.exists() and all(p.stat().st_mtime <= out.stat().st_mtime for p in inputs):
+        return out
+    BUILD.mkdir(exist_ok=True)
+    cmd = ["g++", "-std=gnu++17", "-O2", "-pthread", "-Wall", "-Wextra", f"-I{HARNESS / 'host'}", f"-I{ROOT / 'include'}"]
+    cmd += pio_flags() + (["-DENABLE_AUDIO_DMA=0"] if legacy else [])
+    cmd += [str(HARNESS / "replay.cpp")] + [str(ROOT / "src" / s) for s in FIRMWARE_SOURCES] + ["-o", str(out)]
+    subprocess.run(cmd, check=True)
+    return out
+
+
+def read_wav(path: Path) -> tuple[list[float], int]:
+    with wave.open(str(path), "rb") as w:
+        ch, width, rate, n = w.getnchannels(), w.getsampwidth(), w.getframerate(), w.getnframes()
+        raw = w.readframes(n)
+    if width == 1:
+        vals = [(b - 128) / 128.0 for b in raw]
+    elif width == 2:
+        vals = [v / 32768.0 for v in struct.unpack(f"<{len(raw) // 2}h", raw)]
+    elif width in (3, 4):
+        vals = [int.from_bytes(raw[i:i + width], "little", signed=True) / float(1 << (8 * width - 1))
+                for i in range(0, len(raw), width)]
+    else:
+        raise SystemExit(f"{path}: unsupported sample width {width}")
+    mono = [sum(vals[i:i + ch]) / ch for i in range(0, len(vals), ch)]
+    return mono, rate
+
+
+def to_adc(samples: list[float], rate: int, level: float) -> bytes:
+    """Resample (linear) to the capture rate and map to 12-bit words around mid-scale."""
+    target = setting("AUDIO_SAMPLE_RATE")
+    n = int(len(samples) * target / rate)
+    words = []
+    for i in range(n):
+        pos = i * rate / target
+        j = int(pos)
+        frac = pos - j
+        a = samples[j]
+        b = samples[j + 1] if j + 1 < len(samples) else a
+        v = 2048 + round((a + (b - a) * frac) * 2047 * level)
+        words.append(min(4095, max(0, v)))
+    return struct.pack(f"<{len(words)}H", *words)
+
+
+def read_labels(path: Path | None) -> list[float] | None:
+    if not path:
+        return None
+    times = []
+    for line in path.read_text(encoding="utf-8").splitlines():
+        cols = line.split()
+        if cols and not cols[0].startswith("#"):
+            times.append(float(cols[0]))
+    return sorted(times)
+
+
+def replay(wav: Path, legacy: bool, loop_ms: int, level: float, sets: list[str], verbose: bool,
+           trace: Path | None = None, scan_pause_us: int | None = None) -> dict:
+    binary = build(legacy)
+    samples, rate = read_wav(wav)
+    with tempfile.NamedTemporaryFile(suffix=".raw") as raw:
+        raw.write(to_adc(samples, rate, level))
+        raw.flush()
+        cmd = [str(binary), raw.name, "--loop-ms", str(loop_ms)]
+        if scan_pause_us is not None:
+            cmd += ["--scan-pause-us", str(scan_pause_us)]
+        for s in sets:
+            cmd += ["--set", s]
+        if verbose:
+            cmd.append("--verbose")
+        if trace:
+            cmd.append("--trace")
+        out = subprocess.run(cmd, check=True, stdout=subprocess.PIPE, text=True).stdout
+    ev = {"clap": [], "clapcmd": [], "beat": [], "bpm": 0.0, "conf": 0.0}
+    rows = ["t,music_env,music_filtered,music_mod_scale"]
+    for line in out.splitlines():
+        f = line.split()
+        if f[0] == "trace":
+            rows.append(",".join(f[1:]))
+        elif f[0] in ("clap", "beat"):
+            ev[f[0]].append(float(f[1]))
+        elif f[0] == "clapcmd":
+            ev["clapcmd"].append((float(f[1]), int(f[2])))
+        elif f[0] == "bpm":
+            ev["bpm"], ev["conf"] = float(f[1]), float(f[2])
+        elif f[0] == "cpu":
+            audio_s = float(f[1])
+            ev["seconds"] = audio_s
+            ev["capture_us_per_s"] = int(f[2]) / audio_s
+            ev["loop_us_per_s"] = int(f[3]) / audio_s
+    if trace:
+        trace.write_text("\n".join(rows) + "\n", encoding="utf-8")
+    return ev
+
+
+def match(detected: list[float], labels: list[float], tol: float) -> dict:
+    """Greedy one-to-one matching in time order; offsets are detected - label."""
+    offsets = []
+    used = set()
+    for t in labels:
+        best = None
+        for i, d in enumerate(detected):
+            if i not in used and abs(d - t) <= tol and (best is None or abs(d - t) < abs(detected[best] - t)):
+                best = i
+        if best is not None:
+            used.add(best)
+            offsets.append(detected[best] - t)
+    hits = len(offsets)
+    precision = hits / len(detected) if detected else (1.0 if not labels else 0.0)
+    recall = hits / len(labels) if labels else 1.0
+    f1 = 2 * precision * recall / (precision + recall) if precision + recall else 0.0
+    mean = 1000.0 * sum(offsets) / hits if hits else 0.0
+    return {"precision": precision, "recall": recall, "f1": f1, "offset_ms": mean}
+
+
+def clap_groups(labels: list[float]) -> list[tuple[float, int]]:
+    groups = []
+    for t in labels:
+        if groups and t - groups[-1][0] < CLAP_WINDOW:
+            groups[-1] = (groups[-1][0], groups[-1][1] + 1)
+        else:
+            groups.append((t, 1))
+    return [(t, min(n, 3)) for t, n in groups]
+
+
+def score(ev: dict, claps: list[float] | None, beats: list[float] | None, tol: float) -> dict:
+    res = {"capture_us_per_s": ev.get("capture_us_per_s", 0.0), "loop_us_per_s": ev.get("loop_us_per_s", 0.0),
+           "bpm": ev["bpm"], "beat_conf": ev["conf"], "claps": len(ev["clap"]), "beats": len(ev["beat"])}
+    if claps is not None:
+        m = match(ev["clap"], claps, tol)
+        res.update({f"clap_{k}": v for k, v in m.items()})
+        groups = clap_groups(claps)
+        # A command fires once the counting window after its first clap has closed.
+        ok = sum(1 for t, n in groups
+                 if any(c == n and t < ct <= t + CLAP_WINDOW + tol + 0.05 for ct, c in ev["clapcmd"]))
+        res["clap_cmd_accuracy"] = ok / len(groups) if groups else (1.0 if not ev["clapcmd"] else 0.0)
+        res["clap_cmd_extra"] = max(0, len(ev["clapcmd"]) - ok)
+    if beats is not None:
+        late = [t for t in beats if t >= BEAT_WARMUP]
+        # Without labels every beat after the warm-up is a false positive (precision 0), none fired scores 1.0.
+        end = late[-1] + BEAT_TOL if late else ev.get("seconds", 0.0)
+        m = match([t for t in ev["beat"] if BEAT_WARMUP - BEAT_TOL <= t <= end], late, BEAT_TOL)
+        res.update({f"beat_{k}": v for k, v in m.items()})
+        if len(beats) > 1:
+            gaps = sorted(b - a for a, b in zip(beats, beats[1:]))
+            res["bpm_label"] = 60.0 / gaps[len(gaps) // 2]
+    return res
+
+
+def print_result(name: str, res: dict) -> None:
+    print(f"== {name}")
+    if "clap_f1" in res:
+        print(f"claps:  {res['claps']} detected, precision {res['clap_precision']:.2f}, recall {res['clap_recall']:.2f}, "
+              f"F1 {res['clap_f1']:.2f}, offset {res['clap_offset_ms']:+.0f} ms")
+        print(f"        commands {100 * res['clap_cmd_accuracy']:.0f}% right, {res['clap_cmd_extra']} extra")
+    if "beat_f1" in res:
+        print(f"beats:  {res['beats']} fired, precision {res['beat_precision']:.2f}, recall {res['beat_recall']:.2f}, "
+              f"F1 {res['beat_f1']:.2f}, offset {res['beat_offset_ms']:+.0f} ms (after {BEAT_WARMUP:.0f} s)")
+        print(f"        tempo {res['bpm']:.1f} BPM (labels {res.get('bpm_label', 0.0):.1f}), confidence {res['beat_conf']:.2f}")
+    print(f"cpu:    capture {res['capture_us_per_s']:.0f} us/s, updateMusicSensor {res['loop_us_per_s']:.0f} us/s (host)")
+
+
+CLAP_SHAPES = {"short": (0.08, 1.2, 0.012), "long": (0.06, 3.0, 0.03)}  # length s, amplitude, decay s
+
+
+def synth(out: Path, bpm: float, seconds: float, claps: list[float], seed: int, doors: list[float] = (),
+          speech: list[float] = (), clap_shape: str = "short", rate: int = 16000) -> None:
+    """Kick drum on every beat (bpm 0: none), hi-hat on the off-beats, hand claps at @p claps.
+    @p doors (low thumps) and @p speech (voiced syllables) are distractors that must not count as claps.
+    @p clap_shape "long" gives the louder, slower decaying claps the 40 Hz analogRead() path can see."""
+    rng = random.Random(seed)
+    n = int(seconds * rate)
+    x = [rng.gauss(0.0, 0.01) for _ in range(n)]
+    period = 60.0 / bpm if bpm > 0 else seconds
+    beats = [i * period for i in range(int(seconds / period) + 1) if i * period < seconds - 0.2] if bpm > 0 else []
+    for t in beats:
+        s = int(t * rate)
+        phase = 0.0
+        for i in range(min(int(0.15 * rate), n - s)):
+            phase += 2 * math.pi * (50.0 + 80.0 * math.exp(-i / (0.02 * rate))) / rate
+            x[s + i] += 0.4 * math.exp(-i / (0.05 * rate)) * math.sin(phase)
+        h = int((t + period / 2) * rate)
+        for i in range(min(int(0.03 * rate), max(0, n - h))):
+            x[h + i] += 0.08 * math.exp(-i / (0.008 * rate)) * rng.uniform(-1.0, 1.0)
+    clap_len, clap_amp, clap_decay = CLAP_SHAPES[clap_shape]
+    for t in claps:
+        s = int(t * rate)
+        prev = 0.0
+        for i in range(min(int(clap_len * rate), n - s)):
+            v = rng.uniform(-1.0, 1.0)
+            hp = v - prev  # first difference: bright, like a clap
+            prev = v
+            x[s + i] += clap_amp * math.exp(-i / (clap_decay * rate)) * hp
+    for t in doors:
+        s = int(t * rate)
+        lp = 0.0
+        for i in range(min(int(0.4 * rate), n - s)):
+            lp += 0.1 * (rng.uniform(-1.0, 1.0) - lp)  # rumble below ~300 Hz
+            x[s + i] += 0.8 * math.exp(-i / (0.12 * rate)) * math.sin(2 * math.pi * 60.0 * i / rate)
+            x[s + i] += 2.0 * math.exp(-i / (0.04 * rate)) * lp
+    for t in speech:
+        # Voiced syllable: 120 Hz pulses through two formant resonators (700 / 1200 Hz).
+        s = int(t * rate)
+        length = int(0.22 * rate)
+        y = [[0.0, 0.0], [0.0, 0.0]]
+        for i in range(min(length, n - s)):
+            pulse = 1.0 if i % (rate // 120) == 0 else 0.0
+            v = 0.0
+            for k, f in enumerate((700.0, 1200.0)):
+                r, w = 0.97, 2 * math.pi * f / rate
+                o = pulse + 2 * r * math.cos(w) * y[k][0] - r * r * y[k][1]
+                y[k] = [o, y[k][0]]
+                v += o
+            env = min(1.0, i / (0.015 * rate), (length - i) / (0.04 * rate))
+            x[s + i] += 0.04 * env * v
+    pcm = struct.pack(f"<{n}h", *(max(-32767, min(32767, int(v * 32767))) for v in x))
+    with wave.open(str(out), "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(pcm)
+    out.with_suffix(".beats.txt").write_text("".join(f"{t:.3f}\n" for t in beats), encoding="utf-8")
+    out.with_suffix(".claps.txt").write_text("".join(f"{t:.3f}\n" for t in claps), encoding="utf-8")
+
+
+def run_suite(manifest: Path, update: bool, verbose: bool) -> int:
+    cases = json.loads(manifest.read_text(encoding="utf-8"))
+    failed = 0
+    for case in cases:
+        if "synth" in case:
+            sy = case["synth"]
+            BUILD.mkdir(exist_ok=True)
+            wav = BUILD / f"{case['name']}.wav"
+            synth(wav, sy.get("bpm", 120.0), sy.get("seconds", 20.0), sy.get("claps", []), sy.get("seed", 1),
+                  sy.get("doors", []), sy.get("speech", []), sy.get("clap_shape", "short"))
+            claps, beats = wav.with_suffix(".claps.txt"), wav.with_suffix(".beats.txt")
+        else:
+            wav = manifest.parent / case["wav"]
+            claps = manifest.parent / case["claps"] if "claps" in case else None
+            beats = manifest.parent / case["beats"] if "beats" in case else None
+        ev = replay(wav, case.get("legacy", False), case.get("loop_ms", 10), case.get("level", 1.0),
+                    case.get("set", []), verbose, scan_pause_us=case.get("scan_pause_us"))
+        res = score(ev, read_labels(claps), read_labels(beats), case.get("tol", 0.1))
+        print_result(case["name"], res)
+        expect = case.setdefault("expect", {})
+        if update:
+            for k in [k for k in res if k.endswith(("_f1", "_accuracy")) and k not in case.get("report", [])]:
+                expect[k] = round(res[k], 3)
+            continue
+        for k, v in expect.items():
+            if res.get(k, 0.0) < v - SUITE_MARGIN:
+                print(f"REGRESSION {case['name']}: {k} {res.get(k, 0.0):.3f} < {v:.3f}")
+                failed += 1
+        for k, v in case.get("expect_max", {}).items():
+            if res.get(k, 0.0) > v:
+                print(f"REGRESSION {case['name']}: {k} {res.get(k, 0.0):.3f} > {v:.3f}")
+                failed += 1
+    if update:
+        manifest.write_text(json.dumps(cases, indent=2) + "\n", encoding="utf-8")
+    print(f"{len(cases)} cases, {failed} regressions")
+    return 1 if failed else 0
+
+
+def option(argv: list[str], name: str, default: str | None = None) -> str | None:
+    return argv[argv.index(name) + 1] if name in argv[:-1] else default
+
+
+def main(argv: list[str]) -> int:
+    cmd = argv[1] if len(argv) > 1 else ""
+    verbose = "--verbose" in argv
+    if cmd == "run" and len(argv) > 2:
+        sets = [argv[i + 1] for i, a in enumerate(argv[:-1]) if a == "--set"]
+        claps, beats, trace = option(argv, "--claps"), option(argv, "--beats"), option(argv, "--trace")
+        pause = option(argv, "--scan-pause-us")
+        ev = replay(Path(argv[2]), "--legacy" in argv, int(option(argv, "--loop-ms", "10")),
+                    float(option(argv, "--level", "1.0")), sets, verbose, Path(trace) if trace else None,
+                    int(pause) if pause else None)
+        res = score(ev, read_labels(Path(claps) if claps else None), read_labels(Path(beats) if beats else None),
+                    float(option(argv, "--tol", "0.1")))
+        print_result(argv[2], res)
+        return 0
+    if cmd == "suite":
+        manifest = Path(argv[2]) if len(argv) > 2 and not argv[2].startswith("--") else SUITE
+        return run_suite(manifest, "--update" in argv, verbose)
+    if cmd == "synth" and len(argv) > 2:
+        def times(name: str) -> list[float]:
+            return [float(t) for t in option(argv, name, "").split(",") if t]
+
+        synth(Path(argv[2]), float(option(argv, "--bpm", "120")), float(option(argv, "--seconds", "20")),
+              times("--claps"), int(option(argv, "--seed", "1")), times("--doors"), times("--speech"),
+              option(argv, "--clap-shape", "short"))
+        return 0
+    print(__doc__, file=sys.stderr)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core, just enough for the music/clap sources.
+ *
+ * Time comes from the replay's virtual clock (replay.cpp), analogRead() from the
+ * WAV stream; everything else the audio path touches is a plain host type.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t byte;
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_TIMEOUT 0x107
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define PI 3.1415926535897932384626433832795
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class String
+{
+public:
+  String() {}
+  String(const char *c) : s_(c ? c : "") {}
+  String(const __FlashStringHelper *c) : s_(reinterpret_cast<const char *>(c)) {}
+  String(const std::string &c) : s_(c) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(unsigned char v) : s_(std::to_string(v)) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned int v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+  explicit String(float v, unsigned int decimals = 2) { fmt(v, decimals); }
+  explicit String(double v, unsigned int decimals = 2) { fmt(v, decimals); }
+
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  const char *c_str() const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  bool reserve(unsigned int n)
+  {
+    s_.reserve(n);
+    return true;
+  }
+
+  String &operator+=(const String &o) { return append(o.s_); }
+  String &operator+=(const char *o) { return append(o); }
+  String &operator+=(const __FlashStringHelper *o) { return append(reinterpret_cast<const char *>(o)); }
+  String &operator+=(char c) { return append(std::string(1, c)); }
+  String &operator+=(unsigned char v) { return append(std::to_string(v)); }
+  String &operator+=(int v) { return append(std::to_string(v)); }
+  String &operator+=(unsigned int v) { return append(std::to_string(v)); }
+  String &operator+=(long v) { return append(std::to_string(v)); }
+  String &operator+=(unsigned long v) { return append(std::to_string(v)); }
+  String &operator+=(float v) { return append(String(v).s_); }
+  String &operator+=(double v) { return append(String(v).s_); }
+
+  bool operator==(const String &o) const { return s_ == o.s_; }
+  bool operator==(const char *o) const { return s_ == o; }
+  bool operator!=(const String &o) const { return s_ != o.s_; }
+  bool operator!=(const char *o) const { return s_ != o; }
+  bool equalsIgnoreCase(const String &o) const
+  {
+    if (s_.size() != o.s_.size())
+      return false;
+    for (size_t i = 0; i < s_.size(); ++i)
+      if (tolower((unsigned char)s_[i]) != tolower((unsigned char)o.s_[i]))
+        return false;
+    return true;
+  }
+  bool startsWith(const String &p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String &p) const
+  {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const
+  {
+    const size_t r = s_.find(c, from);
+    return r == std::string::npos ? -1 : (int)r;
+  }
+  String substring(unsigned int from, unsigned int to = 0xFFFFFFFFu) const
+  {
+    if (from >= s_.size() || to <= from)
+      return String();
+    return String(s_.substr(from, to - from));
+  }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+  void trim()
+  {
+    const size_t a = s_.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos)
+    {
+      s_.clear();
+      return;
+    }
+    s_ = s_.substr(a, s_.find_last_not_of(" \t\r\n") - a + 1);
+  }
+  void toLowerCase()
+  {
+    for (char &c : s_)
+      c = (char)tolower((unsigned char)c);
+  }
+
+private:
+  std::string s_;
+  String &append(const std::string &t)
+  {
+    s_ += t;
+    return *this;
+  }
+  void fmt(double v, unsigned int decimals)
+  {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", (int)decimals, v);
+    s_ = b;
+  }
+};
+
+template <typename T>
+String operator+(const String &a, const T &b)
+{
+  String r(a);
+  r += b;
+  return r;
+}
+inline String operator+(const char *a, const String &b) { return String(a) + b; }
+inline String operator+(const __FlashStringHelper *a, const String &b) { return String(a) + b; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+int analogRead(uint8_t pin);
+
+struct EspClass
+{
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+extern EspClass ESP;
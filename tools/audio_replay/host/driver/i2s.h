@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file i2s.h
+ * @brief Host stand-in for the ESP-IDF I2S driver in built-in ADC mode.
+ *
+ * i2s_read() hands out the WAV blocks the replay delivers on its virtual clock.
+ */
+
+#include <Arduino.h>
+#include "driver/adc.h"
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 } i2s_port_t;
+typedef enum { I2S_MODE_MASTER = 1, I2S_MODE_RX = 8, I2S_MODE_ADC_BUILT_IN = 32 } i2s_mode_t;
+typedef enum { I2S_BITS_PER_SAMPLE_16BIT = 16 } i2s_bits_per_sample_t;
+typedef enum { I2S_CHANNEL_FMT_ONLY_LEFT = 4 } i2s_channel_fmt_t;
+typedef enum { I2S_COMM_FORMAT_STAND_I2S = 1 } i2s_comm_format_t;
+
+typedef struct
+{
+  i2s_mode_t mode;
+  uint32_t sample_rate;
+  i2s_bits_per_sample_t bits_per_sample;
+  i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format;
+  int intr_alloc_flags;
+  int dma_buf_count;
+  int dma_buf_len;
+  bool use_apll;
+} i2s_config_t;
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *cfg, int queueSize, void *queue);
+inline esp_err_t i2s_driver_uninstall(i2s_port_t) { return ESP_OK; }
+inline esp_err_t i2s_set_adc_mode(adc_unit_t, adc1_channel_t) { return ESP_OK; }
+inline esp_err_t i2s_adc_enable(i2s_port_t) { return ESP_OK; }
+inline esp_err_t i2s_adc_disable(i2s_port_t) { return ESP_OK; }
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytesRead, uint32_t ticksToWait);
@@ -0,0 +1,23 @@
+#pragma once
+
+/** @file FreeRTOS.h @brief Host stand-in for the FreeRTOS types and critical sections the capture task uses. */
+
+#include <stdint.h>
+
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdFAIL 0
+#define pdMS_TO_TICKS(ms) (ms)
+
+// One lock for all muxes: the replay only needs the hand-off to be ordered.
+typedef struct
+{
+  int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void replayCritical(bool enter);
+#define portENTER_CRITICAL(mux) ((void)(mux), replayCritical(true))
+#define portEXIT_CRITICAL(mux) ((void)(mux), replayCritical(false))
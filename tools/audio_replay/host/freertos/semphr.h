@@ -0,0 +1,16 @@
+#pragma once
+
+/** @file semphr.h @brief Host stand-in for the static mutex guarding ADC1 (one host mutex, see replay.cpp). */
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+typedef struct
+{
+  int unused;
+} StaticSemaphore_t;
+#define portMAX_DELAY 0xFFFFFFFFu
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
@@ -0,0 +1,412 @@
+/**
+ * @file replay.cpp
+ * @brief Feed recorded audio through the firmware's music, beat and clap code on a virtual clock.
+ *
+ * Built on the host by tools/audio_replay.py together with the unmodified
+ * src/microphone.cpp, audio_capture.cpp, audio_bands.cpp, beat_tracker.cpp,
+ * tokenlog.cpp and utils.cpp. Input is a file of little-endian 12-bit ADC
+ * words at Settings::AUDIO_SAMPLE_RATE. The main loop calls
+ * updateMusicSensor() every --loop-ms of virtual time like loop() does; with
+ * ENABLE_AUDIO_DMA the capture task runs in its own thread and i2s_read()
+ * hands it one block at the virtual time its last sample was taken, waiting
+ * until the task is back in i2s_read() before time moves on. Results are
+ * the same on every run and independent of host speed.
+ *
+ * The ADC scanner pauses the I2S-ADC every Settings::ADC_SCAN_AUDIO_MS while
+ * the capture runs (a light sensor or poti channel is always wanted on a
+ * real lamp). The samples taken during a pause never reach the DMA, so the
+ * blocks are cut from the recording minus --scan-pause-us at the end of
+ * every scanner period. The timestamps stay on the recording's clock, and
+ * audioAdcBegin()/audioAdcEnd() run at each pause as the scanner would call
+ * them. --scan-pause-us 0 gives a gapless stream.
+ *
+ * Output, one event per line (times in seconds of audio):
+ *   clap <t>            a single clap passed the threshold (clapLastMs moved)
+ *   clapcmd <t> <n>     executeClapCommand(n) ran its command
+ *   beat <t>            Music Beat fired (musicLastBeatMs moved)
+ *   trace <t> <musicEnv> <musicFiltered> <musicModScale>   every loop pass with --trace
+ *   bpm <bpm> <conf>    tempo at the end of the file
+ *   cpu <audio_s> <capture_us> <loop_us>   thread CPU time of the capture task between two i2s_read() calls
+ *                       (block processing, hand-off excluded) / of updateMusicSensor()
+ */
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <time.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lamp_config.h"
+#include "settings.h"
+#include "comms.h"
+#include "inputs.h"
+#include "lamp_state.h"
+#include "microphone.h"
+#include "audio_capture.h"
+
+namespace
+{
+  std::vector<uint16_t> adc;         // the whole recording as ADC words
+  // i2s_adc_disable/enable plus two channels x ADC_SCAN_OVERSAMPLE conversions of ~12 us;
+  // compare with the busy time the `adc` command reports on the lamp.
+  constexpr uint32_t SCAN_PAUSE_US_DEFAULT = 200;
+  uint32_t scanPauseUs = SCAN_PAUSE_US_DEFAULT;
+  std::atomic<uint64_t> clockUs{0};  // virtual time
+  bool verbose = false;
+  bool trace = false;
+
+  // Block hand-off between the loop and the capture task.
+  std::mutex handoffMutex;
+  std::condition_variable handoff;
+  const uint16_t *pendingBlock = nullptr;
+  bool taskWaiting = false;
+  bool draining = false;
+  uint64_t taskCpuUs = 0;
+  uint64_t taskRunStartUs = 0;
+  std::thread taskThread;
+  std::recursive_mutex criticalMutex;
+  std::mutex adcMutex; // audioAdcBegin()/End(), capture start/stop
+
+  struct TaskExit
+  {
+  };
+
+  uint64_t threadCpuUs()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+  }
+
+  double seconds(uint64_t us) { return (double)us / 1e6; }
+
+#if ENABLE_AUDIO_DMA
+  constexpr uint64_t SCAN_PERIOD_US = Settings::ADC_SCAN_AUDIO_MS * 1000ULL;
+  std::vector<uint16_t> captured;    // what the DMA sees: adc minus the samples lost in scanner pauses
+  std::vector<uint32_t> capturedIdx; // recording index of each captured sample
+
+  uint64_t sampleUs(size_t i) { return (uint64_t)i * 1000000ULL / Settings::AUDIO_SAMPLE_RATE; }
+
+  /** Drop the samples taken in the last scanPauseUs of every scanner period. */
+  void buildCapture()
+  {
+    captured.reserve(adc.size());
+    capturedIdx.reserve(adc.size());
+    for (size_t i = 0; i < adc.size(); ++i)
+    {
+      if (sampleUs(i) % SCAN_PERIOD_US >= SCAN_PERIOD_US - scanPauseUs)
+        continue;
+      captured.push_back(adc[i]);
+      capturedIdx.push_back((uint32_t)i);
+    }
+  }
+
+  /** Virtual time just after the last sample of block @p k. */
+  uint64_t blockEndUs(size_t k)
+  {
+    return sampleUs(capturedIdx[(k + 1) * Settings::AUDIO_BLOCK_SAMPLES - 1] + 1);
+  }
+
+  /** Give block @p k to the capture task and wait until it has been processed. */
+  void deliverBlock(size_t k)
+  {
+    std::unique_lock<std::mutex> lk(handoffMutex);
+    handoff.wait(lk, [] { return taskWaiting; });
+    pendingBlock = &captured[k * Settings::AUDIO_BLOCK_SAMPLES];
+    handoff.notify_all();
+    handoff.wait(lk, [] { return !pendingBlock && taskWaiting; });
+  }
+#endif
+
+  bool setParam(const char *arg)
+  {
+    const char *eq = strchr(arg, '=');
+    if (!eq)
+      return false;
+    const std::string key(arg, eq - arg);
+    const float v = (float)atof(eq + 1);
+    if (key == "clap_thr")
+      clapThreshold = v;
+#if ENABLE_AUDIO_DMA
+    else if (key == "clap_peak")
+      clapPeakThreshold = v;
+#endif
+    else if (key == "clap_cool")
+      clapCooldownMs = (uint32_t)v;
+    else if (key == "music_thr")
+      musicAutoThr = v;
+    else if (key == "music_gain")
+      musicGain = v;
+    else if (key == "music_band")
+      musicBand = (uint8_t)v;
+    else if (key == "music_mode")
+      musicMode = (uint8_t)v;
+    else
+      return false;
+    return true;
+  }
+} // namespace
+
+// ---------- Host side of the Arduino core and ESP-IDF ----------
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount()
+{
+  // Host CPU time scaled to the ESP32 clock; only used for the `audio` cycle statistics.
+  return (uint32_t)(threadCpuUs() * getCpuFreqMHz());
+}
+
+unsigned long millis() { return (unsigned long)(clockUs.load() / 1000ULL); }
+unsigned long micros() { return (unsigned long)(uint32_t)clockUs.load(); }
+
+void delay(unsigned long ms)
+{
+  clockUs += (uint64_t)ms * 1000ULL;
+  std::this_thread::yield();
+}
+
+int analogRead(uint8_t)
+{
+  const size_t i = (size_t)(clockUs.load() * Settings::AUDIO_SAMPLE_RATE / 1000000ULL);
+  return i < adc.size() ? adc[i] : 2048;
+}
+
+void replayCritical(bool enter)
+{
+  if (enter)
+    criticalMutex.lock();
+  else
+    criticalMutex.unlock();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf)
+{
+  return buf;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t)
+{
+  adcMutex.lock();
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t)
+{
+  adcMutex.unlock();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *, uint32_t, void *arg, UBaseType_t,
+                                   TaskHandle_t *handle, BaseType_t)
+{
+  taskThread = std::thread([fn, arg] {
+    try
+    {
+      fn(arg);
+    }
+    catch (const TaskExit &)
+    {
+    }
+  });
+  *handle = (TaskHandle_t)&taskThread;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t)
+{
+  throw TaskExit();
+}
+
+esp_err_t i2s_driver_install(i2s_port_t, const i2s_config_t *cfg, int, void *)
+{
+  return cfg->dma_buf_len == Settings::AUDIO_BLOCK_SAMPLES ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2s_read(i2s_port_t, void *dest, size_t size, size_t *bytesRead, uint32_t)
+{
+  // Capture CPU is the task's own work between two reads; the clock is taken outside the hand-off lock and
+  // wait, which cost the host scheduler far more than the block itself.
+  if (taskRunStartUs)
+    taskCpuUs += threadCpuUs() - taskRunStartUs;
+  taskRunStartUs = 0;
+  std::unique_lock<std::mutex> lk(handoffMutex);
+  taskWaiting = true;
+  handoff.notify_all();
+  handoff.wait(lk, [] { return pendingBlock || draining; });
+  taskWaiting = false;
+  *bytesRead = 0;
+  if (!pendingBlock)
+    return ESP_ERR_TIMEOUT;
+  memcpy(dest, pendingBlock, size);
+  *bytesRead = size;
+  pendingBlock = nullptr;
+  lk.unlock();
+  taskRunStartUs = threadCpuUs();
+  return ESP_OK;
+}
+
+// ---------- Firmware glue outside the audio path ----------
+
+bool switchDebouncedState = true;
+uint32_t lastActivityMs = 0;
+
+void setLampEnabled(bool, const char *, bool) {}
+
+void handleCommand(String line)
+{
+  // clapCmd1..3 are set to "replay <n>"
+  if (line.startsWith(F("replay ")))
+    printf("clapcmd %.3f %ld\n", seconds(clockUs.load()), line.substring(7).toInt());
+}
+
+uint8_t feedbackRoute(FeedbackTopic, const bool &) { return verbose ? 1 : 0; }
+bool feedbackWanted(FeedbackTopic, const bool &) { return verbose; }
+uint8_t feedbackTokenClients(uint8_t) { return 0; }
+bool feedbackGetTokens() { return false; }
+uint8_t feedbackCommandRoute() { return 1; }
+
+void sendFeedbackRoute(uint8_t, const String &line)
+{
+  fprintf(stderr, "%10.3f %s\n", seconds(clockUs.load()), line.c_str());
+}
+
+void sendFeedback(const String &line, const bool &)
+{
+  if (verbose)
+    sendFeedbackRoute(1, line);
+}
+
+void sendFeedback(FeedbackTopic, const String &line, const bool &force)
+{
+  sendFeedback(line, force);
+}
+
+int main(int argc, char **argv)
+{
+  const char *path = nullptr;
+  uint32_t loopMs = 10;
+  std::vector<const char *> params;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (!strcmp(argv[i], "--loop-ms") && i + 1 < argc)
+      loopMs = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--verbose"))
+      verbose = true;
+    else if (!strcmp(argv[i], "--trace"))
+      trace = true;
+    else if (!strcmp(argv[i], "--set") && i + 1 < argc)
+      params.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "--scan-pause-us") && i + 1 < argc)
+      scanPauseUs = (uint32_t)atoi(argv[++i]);
+    else
+      path = argv[i];
+  }
+  if (!path || !loopMs || scanPauseUs >= Settings::ADC_SCAN_AUDIO_MS * 1000UL)
+  {
+    fprintf(stderr, "usage: replay <adc.raw> [--loop-ms N] [--scan-pause-us N] [--set key=value]... [--verbose] "
+                    "[--trace]\n");
+    return 2;
+  }
+  FILE *f = fopen(path, "rb");
+  if (!f)
+  {
+    perror(path);
+    return 1;
+  }
+  uint8_t le[2];
+  while (fread(le, 1, 2, f) == 2)
+    adc.push_back((uint16_t)(le[0] | (le[1] << 8)));
+  fclose(f);
+
+  // Everything the firmware can do with audio at once: beat mode plus clap counting.
+  musicEnabled = true;
+  clapEnabled = true;
+  clapTraining = verbose;
+  clapCmd1 = F("replay 1");
+  clapCmd2 = F("replay 2");
+  clapCmd3 = F("replay 3");
+  musicMode = 1;
+  for (const char *p : params)
+  {
+    if (!setParam(p))
+    {
+      fprintf(stderr, "unknown parameter: %s\n", p);
+      return 2;
+    }
+  }
+
+  const uint64_t endUs = (uint64_t)adc.size() * 1000000ULL / Settings::AUDIO_SAMPLE_RATE;
+#if ENABLE_AUDIO_DMA
+  buildCapture();
+  const size_t blocks = captured.size() / Settings::AUDIO_BLOCK_SAMPLES;
+  size_t nextBlock = 0;
+  uint64_t nextPauseUs = SCAN_PERIOD_US - scanPauseUs;
+#endif
+  uint64_t nextLoopUs = 0;
+  uint64_t loopCpuUs = 0;
+  uint32_t seenClapMs = clapLastMs;
+  uint32_t seenBeatMs = musicLastBeatMs;
+  while (nextLoopUs <= endUs)
+  {
+#if ENABLE_AUDIO_DMA
+    const bool blockDue = audioCaptureRunning() && nextBlock < blocks;
+    if (scanPauseUs && nextPauseUs <= nextLoopUs && (!blockDue || nextPauseUs < blockEndUs(nextBlock)))
+    {
+      if (audioCaptureRunning())
+      {
+        clockUs = nextPauseUs;
+        audioAdcBegin();
+        audioAdcEnd();
+      }
+      nextPauseUs += SCAN_PERIOD_US;
+      continue;
+    }
+    if (blockDue && blockEndUs(nextBlock) <= nextLoopUs)
+    {
+      clockUs = blockEndUs(nextBlock);
+      deliverBlock(nextBlock++);
+      continue;
+    }
+#endif
+    clockUs = nextLoopUs;
+    const uint64_t c0 = threadCpuUs();
+    updateMusicSensor();
+    loopCpuUs += threadCpuUs() - c0;
+    if (trace)
+      printf("trace %.3f %.4f %.4f %.4f\n", seconds(nextLoopUs), musicEnv, musicFiltered, musicModScale);
+    if (clapLastMs != seenClapMs)
+    {
+      seenClapMs = clapLastMs;
+      printf("clap %.3f\n", clapLastMs / 1000.0);
+    }
+    if (musicLastBeatMs != seenBeatMs)
+    {
+      seenBeatMs = musicLastBeatMs;
+      printf("beat %.3f\n", musicLastBeatMs / 1000.0);
+    }
+    nextLoopUs += (uint64_t)loopMs * 1000ULL;
+  }
+  printf("bpm %.2f %.3f\n", musicBpm, musicBeatConf);
+
+#if ENABLE_AUDIO_DMA
+  if (verbose)
+    audioCaptureFeedback();
+  {
+    std::lock_guard<std::mutex> lk(handoffMutex);
+    draining = true;
+  }
+  handoff.notify_all();
+  audioCaptureStop();
+  if (taskThread.joinable())
+    taskThread.join();
+#endif
+  printf("cpu %.3f %llu %llu\n", seconds(endUs), (unsigned long long)taskCpuUs, (unsigned long long)loopCpuUs);
+  return 0;
+}
@@ -0,0 +1,7 @@
+"""PlatformIO pre-build hook: refresh the TLOG() token database."""
+
+import subprocess
+
+Import("env")  # noqa: F821  (provided by SCons)
+
+subprocess.check_call([env.subst("$PYTHONEXE"), env.subst("$PROJECT_DIR/tools/tokens.py"), "db"])  # noqa: F821
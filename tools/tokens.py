@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""Token database and decoder for the firmware's TLOG() lines.
+
+  tokens.py db [--check]   scan src/ for TLOG("...") and (re)write the token DBs
+  tokens.py decode         expand `~<base64>` lines from stdin (e.g. a serial log)
+  tokens.py report         flash and per-message byte comparison vs. text logging
+
+The hash must match tokenHash() in include/tokenlog.h (FNV-1a 32, folded to 16 bit).
+"""
+
+from __future__ import annotations
+
+import base64
+import json
+import re
+import struct
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+SRC_DIRS = [ROOT / "src"]
+DB_PATHS = [
+    ROOT / "frontend" / "src" / "lib" / "tokens.json",
+    ROOT / "custom_components" / "quarzlampe" / "tokens.json",
+]
+
+TLOG_RE = re.compile(r'\bTLOG\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)')
+LIT_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?[hlLzjt]*([diuxXcfegs%])")
+C_ESCAPES = {"n": "\n", "t": "\t", "r": "\r", '"': '"', "\\": "\\", "'": "'"}
+
+
+def token_hash(fmt: str) -> int:
+    h = 2166136261
+    for b in fmt.encode("utf-8"):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return ((h >> 16) ^ (h & 0xFFFF)) & 0xFFFF
+
+
+def _unescape(lit: str) -> str:
+    return re.sub(r"\\(.)", lambda m: C_ESCAPES.get(m.group(1), m.group(1)), lit)
+
+
+def scan() -> dict[int, str]:
+    tokens: dict[int, str] = {}
+    clashes = []
+    for src_dir in SRC_DIRS:
+        for path in sorted(src_dir.rglob("*.cpp")) + sorted(src_dir.rglob("*.h")):
+            text = path.read_text(encoding="utf-8")
+            for m in TLOG_RE.finditer(text):
+                fmt = "".join(_unescape(x) for x in LIT_RE.findall(m.group(1)))
+                tok = token_hash(fmt)
+                if tok in tokens and tokens[tok] != fmt:
+                    clashes.append((tok, tokens[tok], fmt))
+                tokens[tok] = fmt
+    if clashes:
+        for tok, a, b in clashes:
+            print(f"token clash 0x{tok:04x}: {a!r} vs {b!r}", file=sys.stderr)
+        raise SystemExit(1)
+    return tokens
+
+
+def db_json(tokens: dict[int, str]) -> str:
+    body = {"hash": "fnv1a16", "tokens": {f"{k:04x}": tokens[k] for k in sorted(tokens)}}
+    return json.dumps(body, ensure_ascii=False, indent=1) + "\n"
+
+
+def load_db(path: Path = DB_PATHS[0]) -> dict[int, str]:
+    data = json.loads(path.read_text(encoding="utf-8"))
+    return {int(k, 16): v for k, v in data["tokens"].items()}
+
+
+def _varint(buf: bytes, pos: int) -> tuple[int, int]:
+    val = shift = 0
+    while pos < len(buf):
+        b = buf[pos]
+        pos += 1
+        val |= (b & 0x7F) << shift
+        if not b & 0x80:
+            break
+        shift += 7
+    return val, pos
+
+
+def expand(fmt: str, args: bytes) -> str:
+    pos = 0
+    out = []
+    last = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last : m.start()])
+        last = m.end()
+        flags, width, prec, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        spec = "%" + flags + width + (f".{prec}" if prec is not None else "")
+        if conv in "di":
+            z, pos = _varint(args, pos)
+            out.append((spec + "d") % ((z >> 1) ^ -(z & 1)))
+        elif conv in "uxX":
+            v, pos = _varint(args, pos)
+            out.append((spec + ("d" if conv == "u" else conv)) % v)
+        elif conv == "c":
+            v, pos = _varint(args, pos)
+            out.append(chr(v))
+        elif conv in "feg":
+            (v,) = struct.unpack_from("<f", args, pos) if pos + 4 <= len(args) else (0.0,)
+            pos += 4
+            out.append((spec + conv) % v)
+        else:
+            n = args[pos] if pos < len(args) else 0
+            out.append(args[pos + 1 : pos + 1 + n].decode("utf-8", errors="replace"))
+            pos += 1 + n
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_line(line: str, tokens: dict[int, str]) -> str:
+    if not line.startswith("~"):
+        return line
+    try:
+        raw = base64.b64decode(line[1:])
+    except ValueError:
+        return line
+    if len(raw) < 2:
+        return line
+    tok = raw[0] | (raw[1] << 8)
+    fmt = tokens.get(tok)
+    if fmt is None:
+        return f"[tok 0x{tok:04x}] {raw[2:].hex()}"
+    return expand(fmt, raw[2:])
+
+
+def _typical_arg(conv: str, prec: str | None) -> tuple[int, int]:
+    """(text chars, encoded bytes) for a typical argument of this conversion."""
+    if conv in "di":
+        return 3, 2
+    if conv in "uxX":
+        return 4, 2
+    if conv == "c":
+        return 1, 1
+    if conv in "feg":
+        return 2 + int(prec if prec is not None else 6), 4
+    if conv == "s":
+        return 12, 13
+    return 1, 0
+
+
+def report(tokens: dict[int, str]) -> None:
+    flash = text_total = tok_total = 0
+    for fmt in tokens.values():
+        flash += len(fmt.encode("utf-8")) + 1
+        text = len(SPEC_RE.sub("", fmt).encode("utf-8"))
+        args = 0
+        for m in SPEC_RE.finditer(fmt):
+            t, a = _typical_arg(m.group(4), m.group(3))
+            text += t
+            args += a
+        text_total += text + 2  # CRLF
+        tok_total += 1 + (2 + args + 2) // 3 * 4 + 2  # "~" + base64 + CRLF
+    n = len(tokens) or 1
+    print(f"tokens:               {len(tokens)}")
+    print(f"format strings:       {flash} B flash (dropped with -DTOKEN_LOG_TEXT=0)")
+    print(f"avg text line:        {text_total / n:.1f} B")
+    print(f"avg token line:       {tok_total / n:.1f} B")
+    print(f"radio/serial savings: {100.0 * (1 - tok_total / max(text_total, 1)):.0f}%")
+
+
+def main(argv: list[str]) -> int:
+    cmd = argv[1] if len(argv) > 1 else "db"
+    if cmd == "db":
+        content = db_json(scan())
+        if "--check" in argv:
+            stale = [p for p in DB_PATHS if not p.exists() or p.read_text(encoding="utf-8") != content]
+            for p in stale:
+                print(f"stale token DB: {p.relative_to(ROOT)}", file=sys.stderr)
+            return 1 if stale else 0
+        for p in DB_PATHS:
+            if not p.exists() or p.read_text(encoding="utf-8") != content:
+                p.write_text(content, encoding="utf-8")
+        return 0
+    if cmd == "decode":
+        tokens = load_db()
+        for line in sys.stdin:
+            print(decode_line(line.rstrip("\r\n"), tokens))
+        return 0
+    if cmd == "report":
+        report(scan())
+        return 0
+    print(__doc__, file=sys.stderr)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Offline replay of touch delta traces through the firmware's gesture recognizer.
+
+  touch_replay.py run <trace.csv> [options]                  replay one trace, print the gestures
+  touch_replay.py suite [manifest]                           regression suite (default tools/touch_replay/suite.json)
+  touch_replay.py synth <out.csv> --fingers D-U,.. [--depth N] [--noise N] [--seed N]
+                                                             trace of touches from D to U ms (+ .fingers.txt)
+
+The harness (tools/touch_replay/replay.cpp) is compiled with g++ against the
+unmodified src/touch_gesture.cpp, so it always tests the current tree.
+Traces are CSV lines `ms,delta[,irq]`, one per loop sample: the filtered
+delta (baseline - count, the telemetry `touch delta`) and 1 where the
+threshold interrupt woke the loop. Options (defaults as shipped):
+  --on N --off N     touch tune thresholds (12 / 8)
+  --hold MS          touch hold (1000)
+  --gap MS           max. pause inside a multi-tap (TOUCH_DOUBLE_MS in inputs.cpp)
+  --max-taps N       highest bound tap count (2: default binding double-tap -> next)
+
+synth models the hardware path: a pad measurement every ~5 ms
+(Settings::TOUCH_SLEEP_CYCLES), the IDF IIR filter (k = 4) every
+Settings::TOUCH_FILTER_MS, a loop sample on that grid and an interrupt
+sample on every measurement beyond the on-threshold. The suite checks the
+gesture sequence and the latency from finger to action: press after finger
+down, taps after the last finger up, hold after down + hold time, hold end
+after finger up. When a higher tap count is bound, the taps latency includes
+the tap gap; it is printed as such and left out of the 80 ms check, which the
+max_taps 1 cases hold for the single-tap path itself.
+"""
+
+from __future__ import annotations
+
+import json
+import math
+import random
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+HARNESS = ROOT / "tools" / "touch_replay"
+HOST = ROOT / "tools" / "audio_replay" / "host"
+BUILD = HARNESS / "build"
+SUITE = HARNESS / "suite.json"
+FIRMWARE_SOURCES = ["touch_gesture.cpp"]
+
+LATENCY_MS = 80     # finger-to-action target
+MEASURE_MS = 5      # pad measurement period with Settings::TOUCH_SLEEP_CYCLES
+IIR_K = 4           # IDF touch filter factor
+RISE_MS = 3.0       # skin contact time constant
+DEFAULTS = {"on": 12, "off": 8, "hold": 1000, "gap": None, "max_taps": 2}
+
+
+def setting(name: str) -> int:
+    text = (ROOT / "include" / "settings.h").read_text(encoding="utf-8")
+    return int(re.search(rf"\b{name}\s*=\s*(\d+)", text).group(1))
+
+
+def tap_gap() -> int:
+    text = (ROOT / "src" / "inputs.cpp").read_text(encoding="utf-8")
+    return int(re.search(r"\bTOUCH_DOUBLE_MS\s*=\s*(\d+)", text).group(1))
+
+
+def build() -> Path:
+    out = BUILD / "replay"
+    inputs = [HARNESS / "replay.cpp", ROOT / "include" / "touch_gesture.h"] + [ROOT / "src" / s for s in FIRMWARE_SOURCES]
+    inputs += list(HOST.rglob("*.h"))
+    if out.exists() and all(p.stat().st_mtime <= out.stat().st_mtime for p in inputs):
+        return out
+    BUILD.mkdir(exist_ok=True)
+    cmd = ["g++", "-std=gnu++17", "-O2", "-Wall", "-Wextra", f"-I{HOST}", f"-I{ROOT / 'include'}"]
+    cmd += [str(HARNESS / "replay.cpp")] + [str(ROOT / "src" / s) for s in FIRMWARE_SOURCES] + ["-o", str(out)]
+    subprocess.run(cmd, check=True)
+    return out
+
+
+def replay(trace: Path, cfg: dict) -> list[tuple]:
+    args = [str(build()), str(trace), "--on", str(cfg["on"]), "--off", str(cfg["off"]), "--hold", str(cfg["hold"]),
+            "--gap", str(cfg["gap"]), "--max-taps", str(cfg["max_taps"])]
+    out = subprocess.run(args, check=True, capture_output=True, text=True).stdout
+    events = []
+    for line in out.splitlines():
+        cols = line.split()
+        events.append((cols[0], int(cols[1])) + tuple(int(c) for c in cols[2:]))
+    return events
+
+
+def synth(out: Path, fingers: list[tuple[int, int]], depth: float, noise: float, seed: int) -> None:
+    """Pad counts under @p fingers (down, up ms) with contact depth @p depth counts and gaussian @p noise."""
+    rng = random.Random(seed)
+    end = (max(u for _, u in fingers) if fingers else 0) + 1500
+    filter_ms = setting("TOUCH_FILTER_MS")
+    on = DEFAULTS["on"]
+
+    def level(t: float) -> float:
+        for d, u in fingers:
+            if d <= t < u:
+                return depth * (1.0 - math.exp(-(t - d) / RISE_MS))
+            if u <= t < u + 10 * RISE_MS:
+                return depth * (1.0 - math.exp(-(u - d) / RISE_MS)) * math.exp(-(t - u) / RISE_MS)
+        return 0.0
+
+    rows = {}
+    raw = 0.0
+    filtered = 0.0
+    for t in range(0, end, 1):
+        if t % MEASURE_MS == 0:
+            raw = level(t) + rng.gauss(0.0, noise)
+            if raw > on:
+                rows[t] = (round(filtered), 1)
+        if t % filter_ms == 0:
+            filtered += (raw - filtered) / IIR_K
+            rows[t] = (round(filtered), rows.get(t, (0, 0))[1])
+    lines = ["ms,delta,irq"] + [f"{t},{d},{i}" for t, (d, i) in sorted(rows.items())]
+    out.write_text("\n".join(lines) + "\n", encoding="utf-8")
+    out.with_suffix(".fingers.txt").write_text("".join(f"{d} {u}\n" for d, u in fingers), encoding="utf-8")
+
+
+def read_fingers(path: Path) -> list[tuple[int, int]]:
+    if not path.exists():
+        return []
+    pairs = []
+    for line in path.read_text(encoding="utf-8").splitlines():
+        cols = line.split()
+        if len(cols) >= 2 and not cols[0].startswith("#"):
+            pairs.append((int(cols[0]), int(cols[1])))
+    return pairs
+
+
+def latencies(events: list[tuple], fingers: list[tuple[int, int]], cfg: dict) -> list[tuple[str, int, int]]:
+    """Finger-to-action time of every event that has a finger reference, and the part of it that is the
+    configured tap gap (a tap count below the highest bound one waits for a further tap)."""
+    res = []
+    for ev in events:
+        kind, t = ev[0], ev[1]
+        downs = [d for d, _ in fingers if d <= t]
+        ups = [u for _, u in fingers if u <= t]
+        if kind == "press" and downs:
+            ref = downs[-1]
+        elif kind == "hold" and downs:
+            ref = downs[-1] + cfg["hold"]
+        elif kind in ("release", "holdend") and ups:
+            ref = ups[-1]
+        elif kind == "taps" and ups:
+            ref = ups[-1]
+        else:
+            continue
+        gap = cfg["gap"] if kind == "taps" and ev[2] < cfg["max_taps"] else 0
+        res.append((kind, t - ref, gap))
+    return res
+
+
+def gestures(events: list[tuple]) -> list[str]:
+    return [f"taps {e[2]}" if e[0] == "taps" else e[0] for e in events if e[0] in ("taps", "hold", "holdend")]
+
+
+def print_result(name: str, events: list[tuple], lat: list[tuple[str, int, int]]) -> None:
+    worst = {}
+    for kind, ms, gap in lat:
+        if kind not in worst or ms > worst[kind][0]:
+            worst[kind] = (ms, gap)
+    lat_text = " ".join(f"{k}={ms}ms" + (f" (tap gap {gap}ms)" if gap else "") for k, (ms, gap) in sorted(worst.items()))
+    lat_text = lat_text or "-"
+    print(f"{name}: {', '.join(gestures(events)) or 'none'} | latency {lat_text}")
+
+
+def config(src: dict) -> dict:
+    cfg = dict(DEFAULTS)
+    cfg.update({k: v for k, v in src.items() if k in DEFAULTS})
+    if cfg["gap"] is None:
+        cfg["gap"] = tap_gap()
+    return cfg
+
+
+def run_suite(manifest: Path) -> int:
+    cases = json.loads(manifest.read_text(encoding="utf-8"))
+    failed = 0
+    for case in cases:
+        cfg = config(case)
+        if "synth" in case:
+            sy = case["synth"]
+            BUILD.mkdir(exist_ok=True)
+            trace = BUILD / f"{case['name']}.csv"
+            synth(trace, [tuple(f) for f in sy.get("fingers", [])], sy.get("depth", 20.0), sy.get("noise", 1.0),
+                  sy.get("seed", 1))
+        else:
+            trace = manifest.parent / case["trace"]
+        events = replay(trace, cfg)
+        lat = latencies(events, read_fingers(trace.with_suffix(".fingers.txt")), cfg)
+        print_result(case["name"], events, lat)
+        if gestures(events) != case.get("expect", []):
+            print(f"REGRESSION {case['name']}: got {gestures(events)}, expected {case.get('expect', [])}")
+            failed += 1
+        # The tap gap is a cost of the binding (a higher tap count is bound), not of the recognizer.
+        slow = [(k, ms) for k, ms, gap in lat if ms - gap >= LATENCY_MS]
+        if slow:
+            print(f"REGRESSION {case['name']}: latency {slow} >= {LATENCY_MS} ms")
+            failed += 1
+    print(f"{len(cases)} cases, {failed} regressions")
+    return 1 if failed else 0
+
+
+def option(argv: list[str], name: str, default: str | None = None) -> str | None:
+    return argv[argv.index(name) + 1] if name in argv[:-1] else default
+
+
+def main(argv: list[str]) -> int:
+    cmd = argv[1] if len(argv) > 1 else ""
+    if cmd == "run" and len(argv) > 2:
+        trace = Path(argv[2])
+        cfg = config({k: int(option(argv, "--" + k.replace("_", "-"))) for k in DEFAULTS
+                      if option(argv, "--" + k.replace("_", "-")) is not None})
+        events = replay(trace, cfg)
+        for ev in events:
+            print(" ".join(str(c) for c in ev))
+        print_result(argv[2], events, latencies(events, read_fingers(trace.with_suffix(".fingers.txt")), cfg))
+        return 0
+    if cmd == "suite":
+        return run_suite(Path(argv[2]) if len(argv) > 2 else SUITE)
+    if cmd == "synth" and len(argv) > 2:
+        fingers = [tuple(int(x) for x in f.split("-")) for f in option(argv, "--fingers", "").split(",") if f]
+        synth(Path(argv[2]), fingers, float(option(argv, "--depth", "20")), float(option(argv, "--noise", "1")),
+              int(option(argv, "--seed", "1")))
+        return 0
+    print(__doc__, file=sys.stderr)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
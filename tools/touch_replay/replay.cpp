@@ -0,0 +1,76 @@
+/**
+ * @file replay.cpp
+ * @brief Feed a touch delta trace through the firmware's gesture recognizer.
+ *
+ * Built on the host by tools/touch_replay.py together with the unmodified
+ * src/touch_gesture.cpp (Arduino stand-in from tools/audio_replay/host).
+ * Input is CSV, one loop sample per line: `ms,delta[,irq]` with the
+ * filtered delta (baseline - count, as in telemetry) and 1 when the
+ * threshold interrupt woke the loop for this sample. A header line and
+ * further columns are ignored.
+ *
+ * Options: --on N --off N --hold MS --gap MS --max-taps N (defaults as
+ * shipped: touch tune 12 8, touch hold 1000, TOUCH_DOUBLE_MS 300, 2 taps).
+ *
+ * Output, one event per line (times in ms of the trace):
+ *   press <t> / release <t> / hold <t> / holdend <t>
+ *   taps <t> <n>        a tap sequence of n taps finished
+ */
+
+#include <Arduino.h>
+
+#include "touch_gesture.h"
+
+int main(int argc, char **argv)
+{
+  TouchGestureConfig cfg = {12, 8, 1000, 300, 2};
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++)
+  {
+    const bool more = i + 1 < argc;
+    if (more && !strcmp(argv[i], "--on"))
+      cfg.onDelta = atoi(argv[++i]);
+    else if (more && !strcmp(argv[i], "--off"))
+      cfg.offDelta = atoi(argv[++i]);
+    else if (more && !strcmp(argv[i], "--hold"))
+      cfg.holdMs = (uint32_t)atol(argv[++i]);
+    else if (more && !strcmp(argv[i], "--gap"))
+      cfg.tapGapMs = (uint32_t)atol(argv[++i]);
+    else if (more && !strcmp(argv[i], "--max-taps"))
+      cfg.maxTaps = (uint8_t)atoi(argv[++i]);
+    else
+      path = argv[i];
+  }
+  FILE *in = path ? fopen(path, "r") : stdin;
+  if (!in)
+  {
+    perror(path);
+    return 2;
+  }
+
+  TouchGesture g;
+  touchGestureReset(g);
+  char line[256];
+  while (fgets(line, sizeof(line), in))
+  {
+    unsigned long ms = 0;
+    int delta = 0, irq = 0;
+    if (sscanf(line, "%lu,%d,%d", &ms, &delta, &irq) < 2)
+      continue; // header or comment
+    const uint32_t t = (uint32_t)ms;
+    const uint8_t ev = touchGestureFeed(g, cfg, delta, irq != 0, t);
+    if (ev & TG_PRESS)
+      printf("press %u\n", t);
+    if (ev & TG_HOLD)
+      printf("hold %u\n", t);
+    if (ev & TG_RELEASE)
+      printf("release %u\n", t);
+    if (ev & TG_HOLD_END)
+      printf("holdend %u\n", t);
+    if (ev & TG_TAPS)
+      printf("taps %u %u\n", t, (unsigned)g.taps);
+  }
+  if (path)
+    fclose(in);
+  return 0;
+}